@@ -0,0 +1,77 @@
+#ifndef DK_BARRIER_BATCH_H
+#define DK_BARRIER_BATCH_H
+
+#include "DkCommon.h"
+
+/*
+*	class DkBarrierBatch:
+*
+*	Collects pipeline barriers so that everything recorded between two
+*	commands goes out as one vkCmdPipelineBarrier. Stage masks are OR-ed,
+*	global barriers fold into one VkMemoryBarrier, and repeated transitions
+*	of the same buffer range or image subresource range fold into one
+*	element. That is sound because no command can sit between barriers in
+*	the same batch: A -> B followed by B -> C carries the same guarantees as
+*	A -> C. Chained layout transitions and queue family transfers are folded
+*	the same way (old layout of the first, new layout of the last), except
+*	that an image queue family transfer never absorbs a layout transition.
+*
+*	When a transition can't be folded into what is queued, e.g. one that
+*	doesn't continue from the queued layout, or partially overlaps a queued
+*	image range, add returns false and leaves the batch alone; the owner
+*	flushes and adds it again. Storage is kept across clear(), so a command
+*	buffer allocates nothing per barrier once warmed up. Makes no Vulkan
+*	calls.
+*
+*/
+class DkBarrierBatch {
+public:
+	bool addGlobal(
+		VkPipelineStageFlags srcStages,
+		VkPipelineStageFlags dstStages,
+		VkAccessFlags srcAccess,
+		VkAccessFlags dstAccess,
+		VkDependencyFlags depFlags = 0
+	);
+	bool addBuffer(
+		VkPipelineStageFlags srcStages,
+		VkPipelineStageFlags dstStages,
+		const VkBufferMemoryBarrier& barrier,
+		VkDependencyFlags depFlags = 0
+	);
+	bool addImage(
+		VkPipelineStageFlags srcStages,
+		VkPipelineStageFlags dstStages,
+		const VkImageMemoryBarrier& barrier,
+		VkDependencyFlags depFlags = 0
+	);
+	void clear();
+
+	// Getters
+	bool isEmpty() const { return m_added == 0; }
+	// Barriers handed to add* since the last clear
+	uint getAddedCount() const { return m_added; }
+	VkPipelineStageFlags getSrcStages() const { return m_srcStages; }
+	VkPipelineStageFlags getDstStages() const { return m_dstStages; }
+	VkDependencyFlags getDependencyFlags() const { return m_depFlags; }
+	const std::vector<VkMemoryBarrier>& getMemoryBarriers() const { return m_memory; }
+	const std::vector<VkBufferMemoryBarrier>& getBufferBarriers() const { return m_buffers; }
+	const std::vector<VkImageMemoryBarrier>& getImageBarriers() const { return m_images; }
+
+	DkBarrierBatch();
+	DkBarrierBatch(const DkBarrierBatch& rhs) = delete;
+	DkBarrierBatch& operator=(const DkBarrierBatch& rhs) = delete;
+private:
+	void _addStages(VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, VkDependencyFlags depFlags);
+
+	// Managed internally
+	VkPipelineStageFlags m_srcStages;
+	VkPipelineStageFlags m_dstStages;
+	VkDependencyFlags m_depFlags;
+	std::vector<VkMemoryBarrier> m_memory;
+	std::vector<VkBufferMemoryBarrier> m_buffers;
+	std::vector<VkImageMemoryBarrier> m_images;
+	uint m_added;
+};
+
+#endif//DK_BARRIER_BATCH_H
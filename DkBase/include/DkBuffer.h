@@ -2,6 +2,7 @@
 #define DK_BUFFER_H
 
 #include "DkCommon.h"
+#include "DkResourceState.h"
 
 class DkDevice;
 class DkDeviceMemory;
@@ -26,23 +27,45 @@ public:
 	DkDeviceMemory* getMemory() { return m_memory; }
 	VkDeviceSize getSize() { return m_queriedSize; }
 	VkDeviceSize getOffset() { return m_queriedOffset; }
+	VkSharingMode getSharingMode() { return m_sharingMode; }
+	// Last use as recorded through DkCommandBuffer::requireState
+	DkResourceState& getState() { return m_state; }
+	// Buffers bound to HOST_VISIBLE memory stay mapped from init to finalize;
+	//	nullptr otherwise
+	void* getMappedData() { return m_mapped; }
 
 	// Access
+
+	// Flushes host writes to [offset, offset + size) of a mapped buffer
+	bool flush(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+	// Writes size bytes of data at offset. Mapped buffers are written
+	//	directly and flushed; no commands are recorded and the queue is only
+	//	used to signal the semaphores. Nothing orders that write after draws
+	//	already submitted: overwriting a range that frames still in flight
+	//	read is a race, so give each in-flight frame its own range (see
+	//	DkMesh::setFrameCount, DkLinearAllocator). Other buffers go through
+	//	a staging copy recorded into bfr, which is submitted and waited on;
+	//	the barrier before it comes from the buffer's tracked state, the one
+	//	after it makes the copy visible to consumingStage and newAccess
 	bool pushData(
 		uint size,
-		void* data,
+		const void* data,
 		DkCommandBuffer* bfr,
-		VkPipelineStageFlags producingStage,
 		VkPipelineStageFlags consumingStage,
-		VkAccessFlags oldAccess,
 		VkAccessFlags newAccess,
 		const std::vector<DkSemaphore*>& signalSemaphores,
-		DkQueue& queue
+		DkQueue& queue,
+		VkDeviceSize offset = 0
 	);
 
 	DkBuffer(DkDevice& device, DkDeviceMemory* memory);
 	~DkBuffer() { finalize(); }
 private:
+	// DkDeviceMemory::defragment recreates the handle of buffers it moves
+	friend class DkDeviceMemory;
+	bool _createBuffer(VkBuffer& buffer);
+
 	// Set on construction
 	DkDevice& m_device;
 	DkDeviceMemory* m_memory;
@@ -60,6 +83,10 @@ private:
 	bool m_initialized;
 	VkDeviceSize m_queriedSize;
 	VkDeviceSize m_queriedOffset;
+	void* m_mapped;
+
+	// Managed internally
+	DkResourceState m_state;
 };
 
 #endif//DK_BUFFER_H
@@ -2,10 +2,13 @@
 #define DK_COMMAND_BUFFER_H
 
 #include "DkCommon.h"
+#include "DkMath.h"
 #include "DkCommandPool.h"
 #include "DkBuffer.h"
 #include "DkImage.h"
 #include "DkSemaphore.h"
+#include "DkCommandStateCache.h"
+#include "DkBarrierBatch.h"
 
 class DkQueue;
 class DkFence;
@@ -13,6 +16,7 @@ class DkRenderPass;
 class DkFramebuffer;
 class DkPipeline;
 class DkMesh;
+class DkGeometryArena;
 class DkDescriptorSet;
 
 struct DkBufferTransition {
@@ -47,6 +51,11 @@ public:
 	VkCommandBuffer& get() { return m_commandBuffer; }
 	VkCommandBufferLevel getLevel() { return m_bufLevel; }
 	bool isRecording() { return m_recording; }
+	// Binds, dynamic state and push constants dropped since beginRecording
+	//	because the same state was already set
+	uint64 getSkippedCommandCount() { return m_stateCache.getSkippedCount(); }
+	// vkCmdPipelineBarrier calls recorded since beginRecording
+	uint64 getPipelineBarrierCount() { return m_pipelineBarrierCount; }
 
 	void setBufferLevel(VkCommandBufferLevel level);
 	
@@ -55,7 +64,22 @@ public:
 
 	// Sending commands
 	bool beginRecording(VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	// Secondary buffers only: records commands that continue subpass of
+	//	renderPass. framebuffer may be nullptr when not known yet. Bound state
+	//	is not inherited from the primary buffer and has to be set again
+	bool beginRecording(
+		DkRenderPass* renderPass,
+		uint subpass,
+		DkFramebuffer* framebuffer,
+		VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+	);
 	bool pushConstants(DkPipeline& pipeline, uint index, const void* data);
+	// Pushes a single matrix, already in shader layout, to the start of the range
+	bool pushConstants(DkPipeline& pipeline, uint index, const math::gpuMat4& mat);
+	// Barriers are queued and merged, then recorded as one
+	//	vkCmdPipelineBarrier ahead of the next copy, draw, render pass
+	//	boundary or executeCommands, or at flushBarriers. Code recording
+	//	vkCmd* directly into get() must flush first
 	bool setMemoryBarrier(
 		VkPipelineStageFlags producingStage,
 		VkPipelineStageFlags consumingStage,
@@ -64,18 +88,86 @@ public:
 		const std::vector<DkImageTransition>& imageBarriers,
 		VkDependencyFlags depFlags = 0
 	);
-	bool deviceMemCopy(DkBuffer& dest, DkBuffer& source);
+	bool flushBarriers();
+	// Automatic barriers: moves the tracked state of the resource (see
+	//	DkBuffer::getState, DkImage::getState) to usage and queues the
+	//	narrowest barrier from its previous use, per subresource for images.
+	//	Barriers recorded with setMemoryBarrier are not seen by the tracker;
+	//	code that records its own must update the state itself. The
+	//	DkUsageInfo overloads take any stages, access and layout
+	bool requireState(DkBuffer& buffer, DkResourceUsage usage);
+	bool requireState(DkBuffer& buffer, const DkUsageInfo& usage);
+	bool requireState(
+		DkImage& image,
+		DkResourceUsage usage,
+		uint baseMip = 0,
+		uint mipCount = VK_REMAINING_MIP_LEVELS,
+		uint baseLayer = 0,
+		uint layerCount = VK_REMAINING_ARRAY_LAYERS
+	);
+	bool requireState(
+		DkImage& image,
+		const DkUsageInfo& usage,
+		uint baseMip = 0,
+		uint mipCount = VK_REMAINING_MIP_LEVELS,
+		uint baseLayer = 0,
+		uint layerCount = VK_REMAINING_ARRAY_LAYERS
+	);
+	// Releasing half of a queue family transfer; the first requireState
+	//	recorded on dstQueueFamily acquires the resource. usage is its first
+	//	use there
+	bool releaseState(DkBuffer& buffer, DkResourceUsage usage, uint dstQueueFamily);
+	bool releaseState(DkBuffer& buffer, const DkUsageInfo& usage, uint dstQueueFamily);
+	bool releaseState(
+		DkImage& image,
+		DkResourceUsage usage,
+		uint dstQueueFamily,
+		uint baseMip = 0,
+		uint mipCount = VK_REMAINING_MIP_LEVELS,
+		uint baseLayer = 0,
+		uint layerCount = VK_REMAINING_ARRAY_LAYERS
+	);
+	bool releaseState(
+		DkImage& image,
+		const DkUsageInfo& usage,
+		uint dstQueueFamily,
+		uint baseMip = 0,
+		uint mipCount = VK_REMAINING_MIP_LEVELS,
+		uint baseLayer = 0,
+		uint layerCount = VK_REMAINING_ARRAY_LAYERS
+	);
+	// Copies the first size bytes of source to dest, starting destOffset
+	//	bytes in
+	bool deviceMemCopy(DkBuffer& dest, DkBuffer& source, VkDeviceSize size, VkDeviceSize destOffset = 0);
+	// With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the pass is filled
+	//	by executeCommands only
 	bool beginRenderPass(
 		DkRenderPass* renderPass,
 		DkFramebuffer* framebuffer,
-		const std::vector<VkClearValue>& clearVals
+		const std::vector<VkClearValue>& clearVals,
+		VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE
 	);
-	bool bindDescriptorSet(DkDescriptorSet* descriptorSet, DkPipeline* pipeline);
+	bool executeCommands(const std::vector<DkCommandBuffer*>& secondaries);
+	// dynamicOffsets supplies one offset per dynamic descriptor in the set,
+	//	in binding order
+	bool bindDescriptorSet(DkDescriptorSet* descriptorSet, DkPipeline* pipeline, const std::vector<uint>& dynamicOffsets = {});
 	bool bindPipeline(DkPipeline* pipeline);
 	bool setViewport(uint firstViewport, const std::vector<VkViewport>& viewports);
 	bool setScissor(uint firstScissor, const std::vector<VkRect2D>& scissors);
+	// Meshes in the same arena bind the same buffers; drawIndexed(mesh)
+	//	supplies their first index and vertex offset
 	bool bindVertexBuffer(DkMesh* vertices);
-	bool draw(DkMesh* mesh, uint nInstances = 1);
+	bool bindVertexBuffer(DkGeometryArena& arena);
+	bool bindVertexBuffer(DkBuffer* buffer, VkDeviceSize offset = 0, uint binding = 0);
+	bool bindIndexBuffer(DkMesh* mesh);
+	bool bindIndexBuffer(DkGeometryArena& arena);
+	bool bindIndexBuffer(DkBuffer* buffer, VkIndexType type, VkDeviceSize offset = 0);
+	// Only for meshes without an index buffer, i.e. those given an external
+	//	vertex buffer
+	bool draw(DkMesh* mesh, uint nInstances = 1, uint firstInstance = 0);
+	bool draw(uint vertexCount, uint instanceCount, uint firstVertex, uint firstInstance = 0);
+	bool drawIndexed(DkMesh* mesh, uint nInstances = 1, uint firstInstance = 0);
+	bool drawIndexed(uint indexCount, uint instanceCount, uint firstIndex, int vertexOffset, uint firstInstance = 0);
 	bool endRenderPass();
 	bool endRecording();
 	bool submit(
@@ -84,12 +176,36 @@ public:
 		const std::vector<DkSemaphore*>& signalSemaphores,
 		DkFence& fence
 	);
+	// Submits without a fence, for work tracked by a later submission
+	bool submit(
+		DkQueue& queue,
+		const std::vector<DkWaitSemaphoreData>& waitSemaphores,
+		const std::vector<DkSemaphore*>& signalSemaphores
+	);
 
 	DkCommandBuffer(DkCommandPool& pool);
 	~DkCommandBuffer() { finalize(); }
 	DkCommandBuffer(const DkCommandBuffer& rhs) = delete;
 	DkCommandBuffer& operator=(const DkCommandBuffer& rhs) = delete;
 private:
+	// DkCommandPool::reset returns its buffers to the initial state
+	friend class DkCommandPool;
+	void _resetState();
+	void _flushBarriers();
+	void _queueBarrier(VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, const VkBufferMemoryBarrier& barrier, VkDependencyFlags depFlags);
+	void _queueBarrier(VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, const VkImageMemoryBarrier& barrier, VkDependencyFlags depFlags);
+	uint _ownerFamily(VkSharingMode sharing);
+	void _queueTransitions(DkBuffer& buffer, const std::vector<DkStateTransition>& transitions);
+	void _queueTransitions(DkImage& image, const std::vector<DkStateTransition>& transitions, const VkImageSubresourceRange& range);
+	bool _resolveRange(DkImage& image, uint baseMip, uint& mipCount, uint baseLayer, uint& layerCount);
+	bool _beginRecording(VkCommandBufferUsageFlags usage, const VkCommandBufferInheritanceInfo* inheritance);
+	bool _submit(
+		DkQueue& queue,
+		const std::vector<DkWaitSemaphoreData>& waitSemaphores,
+		const std::vector<DkSemaphore*>& signalSemaphores,
+		VkFence fence
+	);
+
 	// On construction
 	DkCommandPool& m_pool;
 
@@ -104,6 +220,13 @@ private:
 	bool m_recording;
 	bool m_inRenderPass;
 	bool m_submitted;
+	VkSubpassContents m_subpassContents;
+	// Shadow of the bound state; forgotten at recording and render pass
+	//	boundaries
+	DkCommandStateCache m_stateCache;
+	// Barriers waiting for the next dependent command
+	DkBarrierBatch m_barriers;
+	uint64 m_pipelineBarrierCount;
 };
 
 
@@ -20,10 +20,15 @@ public:
 	// Getters
 	VkCommandPool& get() { return m_commandPool; }
 	DkDevice& getDevice() { return m_device; }
+	DkQueue& getQueue() { return m_queue; }
 
 	// Setters
 	void setParameters(VkCommandPoolCreateFlags params);
 
+	// Returns every buffer of the pool to the initial state at once; none may
+	//	be pending execution
+	bool reset(VkCommandPoolResetFlags flags = 0);
+
 	// Buffer allocation
 	bool allocate(VkCommandBufferLevel level, uint count, std::vector<DkCommandBuffer*>& allocOut); // set of buffers
 	bool allocate(std::vector<DkFrameResources*>& frames); // one for each in a set of frames
@@ -0,0 +1,80 @@
+#ifndef DK_COMMAND_STATE_CACHE_H
+#define DK_COMMAND_STATE_CACHE_H
+
+#include "DkCommon.h"
+
+// vkCmdPushConstants ranges beyond this are never treated as redundant. The
+//	guaranteed minimum of maxPushConstantsSize is 128; common hardware has 256
+const uint DK_MAX_CACHED_PUSH_CONSTANT_BYTES = 256;
+
+/*
+*	class DkCommandStateCache:
+*
+*	Shadow copy of the state bound in a command buffer. Each set* call
+*	compares the new state against the shadow, updates it and returns true
+*	when the command has to be recorded; identical state returns false and
+*	counts as skipped. DkCommandBuffer asks it before every bind, dynamic
+*	state set and push constant.
+*
+*	Everything starts out unknown, so the first of each is always recorded.
+*	Push constant bytes and descriptor sets are only compared when pushed or
+*	bound through the same pipeline layout. Viewports and scissors survive
+*	pipeline binds, which is only right because every DkPipeline declares
+*	them dynamic. Makes no Vulkan calls.
+*
+*/
+class DkCommandStateCache {
+public:
+	// Forgets all state; the skipped count is kept
+	void invalidate();
+	void resetSkippedCount() { m_skipped = 0; }
+
+	bool setPipeline(VkPipeline pipeline);
+	bool setDescriptorSet(VkPipelineLayout layout, uint setIndex, VkDescriptorSet set, const std::vector<uint>& dynamicOffsets);
+	bool setVertexBuffer(uint binding, VkBuffer buffer, VkDeviceSize offset);
+	bool setIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type);
+	bool setViewports(uint first, const std::vector<VkViewport>& viewports);
+	bool setScissors(uint first, const std::vector<VkRect2D>& scissors);
+	bool setPushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint offset, uint size, const void* data);
+
+	// Getters
+	uint64 getSkippedCount() { return m_skipped; }
+
+	DkCommandStateCache();
+	DkCommandStateCache(const DkCommandStateCache& rhs) = delete;
+	DkCommandStateCache& operator=(const DkCommandStateCache& rhs) = delete;
+private:
+	struct boundSet {
+		VkDescriptorSet set;
+		std::vector<uint> dynamicOffsets;
+		bool valid;
+	};
+
+	struct boundBuffer {
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		bool valid;
+	};
+
+	bool _skip();
+
+	// Managed internally
+	VkPipeline m_pipeline;
+	VkPipelineLayout m_setLayout;
+	std::vector<boundSet> m_sets;
+	std::vector<boundBuffer> m_vertexBuffers;
+	boundBuffer m_indexBuffer;
+	VkIndexType m_indexType;
+	std::vector<VkViewport> m_viewports;
+	std::vector<bool> m_viewportValid;
+	std::vector<VkRect2D> m_scissors;
+	std::vector<bool> m_scissorValid;
+	VkPipelineLayout m_pushLayout;
+	uint8_t m_pushData[DK_MAX_CACHED_PUSH_CONSTANT_BYTES];
+	VkShaderStageFlags m_pushStages[DK_MAX_CACHED_PUSH_CONSTANT_BYTES];
+
+	// Statistics
+	uint64 m_skipped;
+};
+
+#endif//DK_COMMAND_STATE_CACHE_H
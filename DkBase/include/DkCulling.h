@@ -0,0 +1,56 @@
+#ifndef DK_CULLING_H
+#define DK_CULLING_H
+
+#include "DkMath.h"
+
+namespace math {
+	enum FrustumPlane {
+		FRUSTUM_LEFT = 0,
+		FRUSTUM_RIGHT,
+		FRUSTUM_BOTTOM,
+		FRUSTUM_TOP,
+		FRUSTUM_NEAR,
+		FRUSTUM_FAR,
+		FRUSTUM_PLANE_COUNT
+	};
+
+	// Six planes (a, b, c, d), normalized so that a * x + b * y + c * z + d is the
+	//	signed distance to the plane, positive on the inside
+	struct frustum {
+		vec<4> planes[FRUSTUM_PLANE_COUNT];
+	};
+
+	// Extracts the planes of the view volume of viewProj, e.g. perspective() *
+	//	lookAt(), in whatever space viewProj transforms from. Expects Vulkan clip
+	//	space, with depth in [0, w].
+	frustum extractFrustum(const mat<4, 4>& viewProj);
+
+	bool isSphereVisible(const frustum& f, const vec<3>& center, float radius);
+	bool isAABBVisible(const frustum& f, const vec<3>& boxMin, const vec<3>& boxMax);
+
+	// Bounding volumes in structure-of-arrays layout, one array per component
+	struct sphereSoA {
+		const float* x;
+		const float* y;
+		const float* z;
+		const float* radius;
+	};
+
+	struct aabbSoA {
+		const float* minX;
+		const float* minY;
+		const float* minZ;
+		const float* maxX;
+		const float* maxY;
+		const float* maxZ;
+	};
+
+	// Test count volumes against f and write the indices of the visible ones, in
+	//	increasing order, to the front of visible. Returns how many were visible.
+	//	visible must have room for count indices. Volumes that straddle a plane
+	//	count as visible.
+	uint cullSpheres(const frustum& f, const sphereSoA& spheres, uint count, uint* visible);
+	uint cullAABBs(const frustum& f, const aabbSoA& boxes, uint count, uint* visible);
+}
+
+#endif//DK_CULLING_H
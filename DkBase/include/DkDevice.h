@@ -3,11 +3,15 @@
 
 #include "DkCommon.h"
 #include "DkPhysicalDevice.h"
+#include "DkMemoryTracker.h"
+#include "DkMemoryTypeSelector.h"
+
+class DkMemoryPool;
 
 class DkDevice {
 public:
 	DkDevice(DkPhysicalDevice& physDevice);
-	~DkDevice() { finalize(); }
+	~DkDevice();
 
 	bool init();
 	void finalize();
@@ -22,6 +26,17 @@ public:
 	// Getters
 	VkDevice get() { return m_device; }
 	DkPhysicalDevice& getPhysDevice() { return m_physDevice; }
+	// Sub-allocator behind DkDeviceMemory; live from init to finalize
+	DkMemoryPool& getMemoryPool() { return *m_memoryPool; }
+	DkMemoryTracker& getMemoryTracker() { return m_memoryTracker; }
+	DkMemoryTypeSelector& getMemoryTypeSelector() { return m_memoryTypeSelector; }
+	bool isExtensionEnabled(const char* ext);
+
+	// Memory statistics. The budget needs VK_EXT_memory_budget (and
+	//	VK_KHR_get_physical_device_properties2 on the instance); without it
+	//	getMemoryBudget returns false and the dump leaves it out
+	bool getMemoryBudget(std::vector<DkHeapBudget>& budgets);
+	void dumpMemoryStats(std::ostream& out);
 
 	bool waitIdle();
 private:
@@ -34,7 +49,14 @@ private:
 	VkPhysicalDeviceFeatures m_desiredFeatures;
 
 	// Set by init
+	// Enabled when available, skipped quietly otherwise. Only lists those
+	//	whose instance-level requirements are enabled
+	std::vector<const char*> m_optionalExts;
 	VkDevice m_device;
+	std::vector<const char*> m_enabledExts;
+	DkMemoryTracker m_memoryTracker;
+	DkMemoryTypeSelector m_memoryTypeSelector;
+	DkMemoryPool* m_memoryPool;
 	bool m_initialized;
 };
 
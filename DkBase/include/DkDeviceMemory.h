@@ -1,12 +1,16 @@
 #ifndef DK_DEVICE_MEMORY_H
 #define DK_DEVICE_MEMORY_H
 
+#include <map>
 #include "DkCommon.h"
+#include "DkMemoryPool.h"
+#include "DkMemoryTypeSelector.h"
 
 class DkDevice;
 class DkImage;
 class DkBuffer;
-struct DkBindLog;
+class DkCommandBuffer;
+class DkQueue;
 
 enum DkResourceType {
 	DK_IMAGE_RESOURCE = 0,
@@ -14,6 +18,19 @@ enum DkResourceType {
 	DK_RESOURCE_TYPE_COUNT = 2
 };
 
+union DkMemoryResource {
+	DkImage* img;
+	DkBuffer* bfr;
+};
+
+struct DkBindLog {
+	VkDeviceSize start;
+	VkDeviceSize size;
+	DkResourceType type;
+	DkMemoryResource resource;
+	uint handle;		// range in the heap of shared memory
+};
+
 class DkDeviceMemory {
 public:
 	// Note: either setOwner or setMemReqs MUST be called prior to init. This
@@ -36,17 +53,61 @@ public:
 	void setOwner(DkImage* owner);
 	void setOwner(DkBuffer* owner);
 
+	// Memory type selection: setPropFlags gives the flags the type must have
+	//	(DEVICE_LOCAL by default); the others steer the choice among the types
+	//	that have them. See DkMemoryTypeSelector
 	void setPropFlags(VkMemoryPropertyFlags flags);
+	void setPreferredFlags(VkMemoryPropertyFlags flags);
+	void setAvoidedFlags(VkMemoryPropertyFlags flags);
+	void setUsage(DkMemoryUsageHint usage);
+
+	// Note: memory with an owner is sub-allocated from the device's
+	//	DkMemoryPool by default, so get() returns a VkDeviceMemory shared with
+	//	other resources; use map/unmap/flush rather than mapping it directly.
+	//	setPooled(false) gives the owner a VkDeviceMemory of its own. Memory
+	//	set up with setMemReqs is always allocated on its own
+	void setPooled(bool pooled);
 
 	// Getters
 	VkDeviceMemory& get() { return m_devMemory; }
-
-	// Binding
-	bool bind(DkImage* img, VkDeviceSize size);
-	bool bind(DkBuffer* bfr, VkDeviceSize size);
+	bool isPooled() { return m_alloc.memory != VK_NULL_HANDLE; }
+	// Flags of the memory type chosen on init; a superset of those requested
+	VkMemoryPropertyFlags getTypeFlags() { return m_typeFlags; }
+
+	// Host access, for memory of a HOST_VISIBLE type. map returns the host
+	//	address of offset 0 of get(), so resources add their own offset. The
+	//	mapping is persistent and shared by everything bound to the memory:
+	//	it lasts until unmap or finalize. Pooled memory is mapped by the pool
+	//	and unmap does nothing for it
+	bool map(void*& ptr);
+	void unmap();
+	// Makes host writes to [offset, offset + size) of get() visible to the
+	//	device. Does nothing for HOST_COHERENT types; otherwise the range is
+	//	widened to nonCoherentAtomSize boundaries
+	bool flush(VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+	// Binding. Memory set up with setMemReqs is a heap shared by the resources
+	//	bound to it: each is placed in a free range that satisfies its
+	//	alignment, with optimal images padded to bufferImageGranularity, and
+	//	the range is returned when the resource is unbound. Buffers and images
+	//	unbind themselves on finalize, so the memory must outlive them
+	bool bind(DkImage* img, const VkMemoryRequirements& reqs);
+	bool bind(DkBuffer* bfr, const VkMemoryRequirements& reqs);
+	void unbind(DkImage* img);
+	void unbind(DkBuffer* bfr);
 
 	// Querying
 	bool getMyOffsetAndSize(const void* resource, DkResourceType type, VkDeviceSize& offset, VkDeviceSize& size);
+	DkAllocatorStats getHeapStats() const { return m_heap.getStats(); }
+
+	// One compaction pass over shared memory: every bound buffer for which a
+	//	free range exists below its current one is moved there with a GPU
+	//	copy. Only unmapped buffers created with both TRANSFER_SRC and
+	//	TRANSFER_DST usage are moved. Moved buffers get a new VkBuffer handle,
+	//	so descriptor sets referring to them must be written again. Waits for
+	//	the device to go idle before, and for the copies to finish after. bfr
+	//	must not be recording; the copies are recorded and submitted here
+	bool defragment(DkCommandBuffer* bfr, DkQueue& queue, uint& movedCount);
 
 	DkDeviceMemory(DkDevice& device);
 	~DkDeviceMemory() { finalize(); }
@@ -63,26 +124,28 @@ private:
 
 	// Set before init
 	VkMemoryPropertyFlags m_memProps;
+	VkMemoryPropertyFlags m_preferredFlags;
+	VkMemoryPropertyFlags m_avoidedFlags;
+	DkMemoryUsageHint m_usage;
+	bool m_pooled;
 
 	// Set on init
 	VkDeviceMemory m_devMemory;
+	DkMemoryAllocation m_alloc;
+	VkMemoryPropertyFlags m_typeFlags;
+	void* m_mapped;
 	bool m_initialized;
 
 	// Resource tracking
-	VkDeviceSize m_offset;
-	std::vector<DkBindLog> m_bindings;
-};
-
-union DkMemoryResource {
-	DkImage* img;
-	DkBuffer* bfr;
-};
+	bool _place(const VkMemoryRequirements& reqs, bool optimal, VkDeviceSize& offset, VkDeviceSize& size, uint& handle);
+	void _unbind(const void* resource);
 
-struct DkBindLog {
-	VkDeviceSize start;
-	VkDeviceSize size;
-	DkResourceType type;
-	DkMemoryResource resource;
+	VkDeviceSize m_offset;
+	bool m_shared;
+	uint m_memoryType;
+	VkDeviceSize m_granularity;
+	DkTlsfAllocator m_heap;
+	std::map<const void*, DkBindLog> m_bindings;
 };
 
 #endif//DK_DEVICE_MEMORY_H
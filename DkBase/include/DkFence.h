@@ -15,6 +15,7 @@ public:
 	// Use
 	bool wait(uint timeout = 3000000000u);
 	bool reset();
+	bool isSignaled();
 
 	DkFence(DkDevice& device);
 	~DkFence() { finalize(); }
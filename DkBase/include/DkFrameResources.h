@@ -6,6 +6,7 @@
 #include "DkFence.h"
 #include "DkFramebuffer.h"
 #include "DkImageView.h"
+#include "DkLinearAllocator.h"
 
 class DkDevice;
 class DkCommandBuffer;
@@ -19,6 +20,8 @@ public:
 	
 	// Setters
 	void setCmdBfr(DkCommandBuffer* bfr) { m_cmdBfr = bfr; }
+	// Size of the frame's transient buffer, set before init; 0 disables it
+	void setTransientBufferSize(VkDeviceSize size);
 
 	// Getters
 	DkCommandBuffer* getCmdBfr() { return m_cmdBfr; }
@@ -27,6 +30,9 @@ public:
 	DkSemaphore& getImgAcqSemaphore() { return m_imgAcqSemaphore; }
 	DkSemaphore& getRdyPrsSemaphore() { return m_rdyPrsSemaphore; }
 	DkFence& getFence() { return m_drawDoneFence; }
+	// Per-frame scratch memory for data rewritten every frame; reset() wipes
+	//	it once the frame's previous submission has completed
+	DkLinearAllocator& getTransientAllocator() { return m_transientAllocator; }
 
 	bool reset();
 	bool resize();
@@ -48,11 +54,15 @@ private:
 	DkSwapchain* m_swapchain;
 	bool m_useDepth;
 
+	// Set before init
+	VkDeviceSize m_transientSize;
+
 	// Set by init
 	DkSemaphore m_imgAcqSemaphore;
 	DkSemaphore m_rdyPrsSemaphore;
 	DkFence m_drawDoneFence;
 	DkImageView m_depthAttachment;
+	DkLinearAllocator m_transientAllocator;
 	bool m_initialized;
 
 	// Set independently
@@ -0,0 +1,98 @@
+#ifndef DK_GEOMETRY_ARENA_H
+#define DK_GEOMETRY_ARENA_H
+
+#include "DkCommon.h"
+#include "DkVertexFormats.h"
+#include "DkMemoryAllocator.h"
+
+class DkDevice;
+class DkBuffer;
+class DkUploadManager;
+
+const uint DEFAULT_ARENA_VERTEX_CAPACITY = 256 * 1024;
+
+// Where one mesh lives in an arena. firstVertex goes to vkCmdDraw as is, or
+//	as the vertexOffset of vkCmdDrawIndexed; firstIndex likewise
+struct DkGeometryRange {
+	uint firstVertex;
+	uint vertexCount;
+	uint firstIndex;
+	uint indexCount;
+	uint vertexHandle;
+	uint indexHandle;
+};
+
+/*
+*	class DkGeometryArena:
+*
+*	Packs the vertices (and optionally indices) of many meshes into one
+*	device local vertex buffer and one index buffer, so a whole scene is
+*	drawn with a single vertex buffer binding and draws differ only in
+*	firstVertex / vertexOffset. Every vertex in an arena shares one format.
+*
+*	Ranges are sub-allocated by a DkTlsfAllocator counting vertices and
+*	indices rather than bytes, so any offset it returns is a whole vertex
+*	whatever the stride. Indices stored in the arena are relative to the
+*	mesh's firstVertex. Data goes in through a DkUploadManager and is usable
+*	once the uploader's submission completes. The buffers are exclusive to
+*	one queue family; uploads into an arena the owner queue already holds
+*	have it released back first, so meshes placed earlier keep their data.
+*
+*/
+class DkGeometryArena {
+public:
+	bool init();
+	void finalize();
+
+	// Setters before init
+	void setVertexFormat(DkVertexFormat format);
+	void setVertexCapacity(uint vertices);
+	// 0 (the default) creates no index buffer
+	void setIndexCapacity(uint indices);
+	void setIndexType(VkIndexType type);
+
+	// Getters
+	DkBuffer* getVertBuffer() { return m_vertBuffer; }
+	DkBuffer* getIndexBuffer() { return m_indexBuffer; }
+	DkVertexFormat getVertexFormat() { return m_vertFormat; }
+	VkIndexType getIndexType() { return m_indexType; }
+	uint getVertexStride() { return ::getVertexStride(m_vertFormat); }
+	uint getIndexStride() { return ::getIndexStride(m_indexType); }
+	DkAllocatorStats getVertexStats() const { return m_vertHeap.getStats(); }
+	DkAllocatorStats getIndexStats() const { return m_indexHeap.getStats(); }
+
+	// Reserves room for vertexCount vertices and indexCount indices. Fails,
+	//	leaving range untouched, when either does not fit
+	bool allocate(uint vertexCount, uint indexCount, DkGeometryRange& range);
+	void free(DkGeometryRange& range);
+
+	// Queue range's data on the uploader; data holds range.vertexCount
+	//	vertices in the arena's format, or range.indexCount indices
+	bool uploadVertices(DkUploadManager& uploader, const DkGeometryRange& range, const void* data);
+	bool uploadIndices(DkUploadManager& uploader, const DkGeometryRange& range, const void* data);
+
+	DkGeometryArena(DkDevice& device);
+	~DkGeometryArena() { finalize(); }
+	DkGeometryArena(const DkGeometryArena& rhs) = delete;
+	DkGeometryArena& operator=(const DkGeometryArena& rhs) = delete;
+private:
+	// Set on construction
+	DkDevice& m_device;
+
+	// Set before init
+	DkVertexFormat m_vertFormat;
+	uint m_vertCapacity;
+	uint m_indexCapacity;
+	VkIndexType m_indexType;
+
+	// Set by init
+	DkBuffer* m_vertBuffer;
+	DkBuffer* m_indexBuffer;
+	bool m_initialized;
+
+	// Managed internally
+	DkTlsfAllocator m_vertHeap;
+	DkTlsfAllocator m_indexHeap;
+};
+
+#endif//DK_GEOMETRY_ARENA_H
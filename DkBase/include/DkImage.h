@@ -3,6 +3,7 @@
 
 #include "DkCommon.h"
 #include "DkDeviceMemory.h"
+#include "DkResourceState.h"
 
 class DkDevice;
 
@@ -26,8 +27,17 @@ public:
 	DkDeviceMemory* getMemory() { return m_memory; }
 	DkDevice& getDevice() { return m_device; }
 	VkFormat getFormat() { return m_format; }
+	VkImageTiling getTiling() { return m_tiling; }
 	VkDeviceSize getSize() { return m_queriedSize; }
 	VkDeviceSize getOffset() { return m_queriedOffset; }
+	VkSharingMode getSharing() { return m_sharing; }
+	uint getMipLevels() { return m_mipLevels; }
+	uint getArrLayers() { return m_arrLayers; }
+	// Depth and/or stencil for depth formats, color otherwise
+	VkImageAspectFlags getAspect();
+	// Last use of one subresource as recorded through
+	//	DkCommandBuffer::requireState; all aspects share it
+	DkResourceState& getState(uint mipLevel, uint arrLayer) { return m_states[arrLayer * m_mipLevels + mipLevel]; }
 
 	// Setters
 	void setCreateFlags(VkImageCreateFlags flags);
@@ -69,6 +79,9 @@ private:
 	bool m_initialized;
 	VkDeviceSize m_queriedSize;
 	VkDeviceSize m_queriedOffset;
+
+	// Managed internally; one per mip level and array layer
+	std::vector<DkResourceState> m_states;
 };
 
 #endif//DK_IMAGE_H
\ No newline at end of file
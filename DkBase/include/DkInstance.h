@@ -21,11 +21,15 @@ public:
 
 	// Getters
 	std::string getAppName() { return m_appName; }
+	bool isExtensionEnabled(const char* ext);
 private:
 
 	// Init information
 	std::string m_appName;
 	std::vector<const char*> m_desiredInstExts;
+	// Enabled when available, skipped quietly otherwise
+	std::vector<const char*> m_optionalInstExts;
+	std::vector<const char*> m_enabledInstExts;
 
 	// Init results
 	VkInstance m_instance;
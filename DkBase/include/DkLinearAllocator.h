@@ -0,0 +1,80 @@
+#ifndef DK_LINEAR_ALLOCATOR_H
+#define DK_LINEAR_ALLOCATOR_H
+
+#include "DkCommon.h"
+
+class DkDevice;
+class DkBuffer;
+
+const VkDeviceSize DEFAULT_TRANSIENT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// A piece of a transient buffer; data points at offset in the mapping
+struct DkTransientAllocation {
+	DkBuffer* buffer;
+	VkDeviceSize offset;
+	void* data;
+};
+
+/*
+*	class DkLinearAllocator:
+*
+*	Hands out short lived pieces of one persistently mapped buffer by bumping
+*	an offset; nothing is freed individually, reset() reclaims everything at
+*	once. Meant for data written every frame (per-draw uniforms, dynamic
+*	vertices): each frame in flight owns one allocator (see
+*	DkFrameResources::getTransientAllocator), which is reset once the frame's
+*	fence shows the device is done with it.
+*
+*	allocateUniform aligns to minUniformBufferOffsetAlignment, so its offsets
+*	can be passed as dynamic offsets of a UNIFORM_BUFFER_DYNAMIC descriptor
+*	that points at getBuffer(). Call flush() before submitting work that reads
+*	the data; it does nothing on host coherent memory.
+*
+*/
+class DkLinearAllocator {
+public:
+	bool init();
+	void finalize();
+
+	// Setters before init
+	void setSize(VkDeviceSize size);
+	void setUsage(VkBufferUsageFlags usage);
+
+	// Getters
+	DkBuffer* getBuffer() { return m_buffer; }
+	VkDeviceSize getSize() { return m_size; }
+	VkDeviceSize getUsedBytes() { return m_head; }
+
+	// Allocation. Fails, leaving alloc untouched, when the buffer is full
+	bool allocate(VkDeviceSize size, VkDeviceSize alignment, DkTransientAllocation& alloc);
+	bool allocateUniform(VkDeviceSize size, DkTransientAllocation& alloc);
+	// Allocates and copies data in
+	bool push(const void* data, VkDeviceSize size, VkDeviceSize alignment, DkTransientAllocation& alloc);
+
+	bool flush();
+	void reset();
+
+	DkLinearAllocator(DkDevice& device);
+	~DkLinearAllocator() { finalize(); }
+	DkLinearAllocator(const DkLinearAllocator& rhs) = delete;
+	DkLinearAllocator& operator=(const DkLinearAllocator& rhs) = delete;
+private:
+	// Set on construction
+	DkDevice& m_device;
+
+	// Set before init
+	VkDeviceSize m_size;
+	VkBufferUsageFlags m_usage;
+
+	// Set by init
+	DkBuffer* m_buffer;
+	char* m_mapped;
+	VkDeviceSize m_uniformAlignment;
+	bool m_initialized;
+
+	// Managed internally
+	VkDeviceSize m_head;
+	VkDeviceSize m_flushed;
+};
+
+#endif//DK_LINEAR_ALLOCATOR_H
@@ -2,145 +2,250 @@
 #define DK_MATH_H
 
 #include <array>
+#include <cmath>
+#include <stdexcept>
 #include "DkCommon.h"
+#include "inline/DkMathSimd.inl"
+
+// Bounds checking policy for vec/mat indexing. Checking is on by default in
+//	debug builds; in release builds it compiles away and
+//	indexing becomes noexcept. Define DK_MATH_CHECKED_INDEXING as 0 or 1 to
+//	override. Every translation unit linked together should agree on it.
+#ifndef DK_MATH_CHECKED_INDEXING
+#ifdef _DEBUG
+#define DK_MATH_CHECKED_INDEXING 1
+#else
+#define DK_MATH_CHECKED_INDEXING 0
+#endif
+#endif
+
+#if DK_MATH_CHECKED_INDEXING
+#define DK_MATH_INDEX_NOEXCEPT
+#define DK_MATH_CHECK_INDEX(cond, msg) if (!(cond)) throw std::runtime_error(msg)
+#else
+#define DK_MATH_INDEX_NOEXCEPT noexcept
+#define DK_MATH_CHECK_INDEX(cond, msg)
+#endif
+
+// SIMD kernels cannot run during constant evaluation. Where the compiler can
+//	tell us we are being constant-evaluated, the 4x4 overloads fall back to the
+//	generic templates and stay constexpr; otherwise they are plain inline.
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define DK_MATH_HAS_CONSTEVAL_CHECK
+#endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+#define DK_MATH_HAS_CONSTEVAL_CHECK
+#endif
+
+#ifdef DK_MATH_HAS_CONSTEVAL_CHECK
+#define DK_MATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#define DK_MATH_SIMD_CONSTEXPR constexpr
+#else
+#define DK_MATH_IS_CONSTANT_EVALUATED() false
+#define DK_MATH_SIMD_CONSTEXPR inline
+#endif
+
+// Set when every vec/mat operation, including the SIMD-backed ones, can be
+//	used in constant expressions
+#if !defined(DK_MATH_SSE) || defined(DK_MATH_HAS_CONSTEVAL_CHECK)
+#define DK_MATH_CONSTEXPR_ALL
+#endif
 
 namespace math {
-	const float PI = 3.1415926536f;
+	constexpr float PI = 3.1415926536f;
+
+	namespace detail {
+		// Element-wise kernels shared by vec and mat. Storage sizes that are a
+		//	multiple of four are handed to the SIMD kernels when available. Each
+		//	is a single pass and out may alias an input, which is what lets the
+		//	compound operators below work in place without a temporary.
+		template<uint count>
+		constexpr void scaleArr(const float* in, float scal, float* out) noexcept {
+#ifdef DK_MATH_SSE
+			if (count % 4 == 0 && !DK_MATH_IS_CONSTANT_EVALUATED()) {
+				simd::scale(in, scal, out, count);
+				return;
+			}
+#endif
+			for (uint iter = 0; iter < count; ++iter) {
+				out[iter] = in[iter] * scal;
+			}
+		}
+
+		template<uint count>
+		constexpr void addArr(const float* a, const float* b, float* out) noexcept {
+#ifdef DK_MATH_SSE
+			if (count % 4 == 0 && !DK_MATH_IS_CONSTANT_EVALUATED()) {
+				simd::add(a, b, out, count);
+				return;
+			}
+#endif
+			for (uint iter = 0; iter < count; ++iter) {
+				out[iter] = a[iter] + b[iter];
+			}
+		}
+
+		template<uint count>
+		constexpr void subArr(const float* a, const float* b, float* out) noexcept {
+#ifdef DK_MATH_SSE
+			if (count % 4 == 0 && !DK_MATH_IS_CONSTANT_EVALUATED()) {
+				simd::sub(a, b, out, count);
+				return;
+			}
+#endif
+			for (uint iter = 0; iter < count; ++iter) {
+				out[iter] = a[iter] - b[iter];
+			}
+		}
+	}
+
 	// VECTOR
 
 	template<uint n>
 	class vec {
 	public:
-		vec(std::array<float, n> init) : _v(init) {}
-		vec(float f) : _v() {
-			std::fill(_v.begin(), _v.end(), f);
-		}
-		vec() : vec(0.f) {}
-		vec(const vec<n>& rhs) : _v(rhs._v) {}
-		vec<n>& operator=(const vec<n>& rhs) {
-			_v = rhs._v;
-			return (*this);
+		constexpr vec(const std::array<float, n>& init) noexcept : _v() {
+			for (uint iter = 0; iter < n; ++iter) {
+				_v[iter] = init[iter];
+			}
 		}
-
-		float& operator[](uint ind) {
-			if (ind < 0 || ind >= n) {
-				throw std::runtime_error("Error: vector index out of bounds");
+		constexpr vec(float f) noexcept : _v() {
+			for (uint iter = 0; iter < n; ++iter) {
+				_v[iter] = f;
 			}
+		}
+		constexpr vec() noexcept : vec(0.f) {}
+		constexpr vec(const vec<n>& rhs) noexcept = default;
+		constexpr vec<n>& operator=(const vec<n>& rhs) noexcept = default;
+
+		constexpr float& operator[](uint ind) DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(ind < n, "Error: vector index out of bounds");
 			return _v[ind];
 		}
 
-		const float& operator[](uint ind) const {
-			if (ind < 0 || ind >= n) {
-				throw std::runtime_error("Error: vector index out of bounds");
-			}
+		constexpr const float& operator[](uint ind) const DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(ind < n, "Error: vector index out of bounds");
 			return _v[ind];
 		}
 
+		// raw storage access
+		constexpr float* data() noexcept { return _v; }
+		constexpr const float* data() const noexcept { return _v; }
+
 		// right scalar multiplication
-		vec<n> operator*(float scal) const {
+		constexpr vec<n> operator*(float scal) const noexcept {
 			vec<n> ret;
-			for (uint iter = 0; iter < n; ++iter) {
-				ret[iter] = _v[iter] * scal;
-			}
+			detail::scaleArr<n>(data(), scal, ret.data());
 			return ret;
 		}
 
-		vec<n> operator*(int scal) const {
-			vec<n> ret;
-			for (uint iter = 0; iter < n; ++iter) {
-				ret[iter] = _v[iter] * (float)scal;
-			}
-			return ret;
+		constexpr vec<n> operator*(int scal) const noexcept {
+			return (*this) * (float)scal;
 		}
 
-		vec<n> operator*(double scal) const {
-			vec<n> ret;
-			for (uint iter = 0; iter < n; ++iter) {
-				ret[iter] = _v[iter] * (float)scal;
-			}
-			return ret;
+		constexpr vec<n> operator*(double scal) const noexcept {
+			return (*this) * (float)scal;
 		}
 
 		// scalar division
 		template<typename T>
-		vec<n> operator/(T scal) const {
+		constexpr vec<n> operator/(T scal) const noexcept {
 			return (*this) * (1.f / (float)scal);
 		}
 
 		// vector addition
-		vec<n> operator+(const vec<n>& other) const {
+		constexpr vec<n> operator+(const vec<n>& other) const noexcept {
 			vec<n> ret;
-			for (uint iter = 0; iter < n; ++iter) {
-				ret[iter] = _v[iter] + other[iter];
-			}
+			detail::addArr<n>(data(), other.data(), ret.data());
 			return ret;
 		}
 
 		// vector subtraction
-		vec<n> operator-(const vec<n>& other) const {
-			return (*this) + (-other);
+		constexpr vec<n> operator-(const vec<n>& other) const noexcept {
+			vec<n> ret;
+			detail::subArr<n>(data(), other.data(), ret.data());
+			return ret;
+		}
+
+		// in-place arithmetic
+		constexpr vec<n>& operator+=(const vec<n>& other) noexcept {
+			detail::addArr<n>(data(), other.data(), data());
+			return (*this);
+		}
+
+		constexpr vec<n>& operator-=(const vec<n>& other) noexcept {
+			detail::subArr<n>(data(), other.data(), data());
+			return (*this);
+		}
+
+		constexpr vec<n>& operator*=(float scal) noexcept {
+			detail::scaleArr<n>(data(), scal, data());
+			return (*this);
 		}
 
-		float norm() const {
+		constexpr vec<n>& operator/=(float scal) noexcept {
+			detail::scaleArr<n>(data(), 1.f / scal, data());
+			return (*this);
+		}
+
+		float norm() const noexcept {
 			return sqrt(dot(*this, *this));
 		}
 
 	private:
-		std::array<float, n> _v;
+		// 4-wide vectors are kept 16-byte aligned for the SIMD kernels
+		alignas(n % 4 == 0 ? 16 : alignof(float)) float _v[n];
 	};
 
 	class vec2 : public vec<2> {
 	public:
-		vec2(float x, float y) : vec<2>({ x , y }) {}
-		vec2(float f) : vec<2>(f) {}
-		vec2() : vec<2>() {}
-		vec2(const vec<2>& rhs) : vec<2>(rhs) {}
-		vec2& operator=(const vec<2>& rhs) {
-			(*this)[0] = rhs[0];
-			(*this)[1] = rhs[1];
+		constexpr vec2(float x, float y) noexcept : vec<2>({ x , y }) {}
+		constexpr vec2(float f) noexcept : vec<2>(f) {}
+		constexpr vec2() noexcept : vec<2>() {}
+		constexpr vec2(const vec<2>& rhs) noexcept : vec<2>(rhs) {}
+		constexpr vec2& operator=(const vec<2>& rhs) noexcept {
+			vec<2>::operator=(rhs);
 			return (*this);
 		}
 	};
 
 	class vec3 : public vec<3> {
 	public:
-		vec3(float x, float y, float z) : vec<3>({ x , y, z }) {}
-		vec3(float f) : vec<3>(f) {}
-		vec3() : vec<3>() {}
-		vec3(const vec<3>& rhs) : vec<3>(rhs) {}
-		vec3& operator=(const vec<3>& rhs) {
-			for (uint i = 0; i < 3; ++i) (*this)[i] = rhs[i];
+		constexpr vec3(float x, float y, float z) noexcept : vec<3>({ x , y, z }) {}
+		constexpr vec3(float f) noexcept : vec<3>(f) {}
+		constexpr vec3() noexcept : vec<3>() {}
+		constexpr vec3(const vec<3>& rhs) noexcept : vec<3>(rhs) {}
+		constexpr vec3& operator=(const vec<3>& rhs) noexcept {
+			vec<3>::operator=(rhs);
 			return (*this);
 		}
-		vec3(const vec<4>& rhs) : vec<3>() {
-			for (uint i = 0; i < 3; ++i) (*this)[i] = rhs[i];
+		constexpr vec3(const vec<4>& rhs) noexcept : vec<3>() {
+			for (uint i = 0; i < 3; ++i) data()[i] = rhs.data()[i];
 		}
-		vec3& operator=(const vec<4>& rhs) {
-			for (uint i = 0; i < 3; ++i) (*this)[i] = rhs[i];
+		constexpr vec3& operator=(const vec<4>& rhs) noexcept {
+			for (uint i = 0; i < 3; ++i) data()[i] = rhs.data()[i];
 			return(*this);
 		}
 	};
 
 	class vec4 : public vec<4> {
 	public:
-		vec4(float x, float y, float z, float w) : vec<4>({ x , y, z, w }) {}
-		vec4(float f) : vec<4>(f) {}
-		vec4() : vec<4>() {}
-		vec4(const vec<4>& rhs) : vec<4>(rhs) {}
-		vec4& operator=(const vec<4>& rhs) {
-			(*this)[0] = rhs[0];
-			(*this)[1] = rhs[1];
-			(*this)[2] = rhs[2];
-			(*this)[3] = rhs[3];
+		constexpr vec4(float x, float y, float z, float w) noexcept : vec<4>({ x , y, z, w }) {}
+		constexpr vec4(float f) noexcept : vec<4>(f) {}
+		constexpr vec4() noexcept : vec<4>() {}
+		constexpr vec4(const vec<4>& rhs) noexcept : vec<4>(rhs) {}
+		constexpr vec4& operator=(const vec<4>& rhs) noexcept {
+			vec<4>::operator=(rhs);
 			return (*this);
 		}
-		vec4(const vec<3>& rhs) : vec<4>() {
-			for (uint i = 0; i < 3; ++i) (*this)[i] = rhs[i];
-			(*this)[3] = 1.f;
+		constexpr vec4(const vec<3>& rhs) noexcept : vec<4>() {
+			for (uint i = 0; i < 3; ++i) data()[i] = rhs.data()[i];
+			data()[3] = 1.f;
 		}
-		vec4& operator=(const vec<3>& rhs) {
-			for (uint i = 0; i < 3; ++i) (*this)[i] = rhs[i];
-			(*this)[3] = 1.f;
+		constexpr vec4& operator=(const vec<3>& rhs) noexcept {
+			for (uint i = 0; i < 3; ++i) data()[i] = rhs.data()[i];
+			data()[3] = 1.f;
 			return (*this);
 		}
 	};
@@ -150,181 +255,212 @@ namespace math {
 	template <uint n, uint m>
 	class mat {
 	public:
-		mat(std::array<float, n * m> init) : _m(init) {}
-		mat(float f) : _m() {
-			std::fill(_m.begin(), _m.end(), f);
-		}
-		mat() : mat(0.f) {}
-		mat(const mat<n, m>& rhs) : _m(rhs._m) {}
-		mat<n, m> operator=(const mat<n, m>& rhs) {
-			_m = rhs._m;
-			return (*this);
+		constexpr mat(const std::array<float, n * m>& init) noexcept : _m() {
+			for (uint iter = 0; iter < n * m; ++iter) {
+				_m[iter] = init[iter];
+			}
+		}
+		constexpr mat(float f) noexcept : _m() {
+			for (uint iter = 0; iter < n * m; ++iter) {
+				_m[iter] = f;
+			}
 		}
+		constexpr mat() noexcept : mat(0.f) {}
+		constexpr mat(const mat<n, m>& rhs) noexcept = default;
+		constexpr mat<n, m>& operator=(const mat<n, m>& rhs) noexcept = default;
 
 		// indexing
-		float& operator()(uint row, uint col) {
-			if (row < 0 || row >= n || col < 0 || col >= m) {
-				throw std::runtime_error("Error: matrix indices out of bounds");
-			}
+		constexpr float& operator()(uint row, uint col) DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(row < n && col < m, "Error: matrix indices out of bounds");
 			return _m[col + m * row];
 		}
 
-		const float& operator()(uint row, uint col) const {
-			if (row < 0 || row >= n || col < 0 || col >= m) {
-				throw std::runtime_error("Error: matrix indices out of bounds");
-			}
+		constexpr const float& operator()(uint row, uint col) const DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(row < n && col < m, "Error: matrix indices out of bounds");
 			return _m[col + m * row];
 		}
 
 		// get copy of row
-		vec<m> row(uint r) const {
-			if (r < 0 || r > n) {
-				throw std::runtime_error("Error: matrix row index out of bounds");
-			}
+		constexpr vec<m> row(uint r) const DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(r < n, "Error: matrix row index out of bounds");
 			vec<m> ret;
 			for (uint iter = 0; iter < m; ++iter) {
-				ret[iter] = _m[iter + m * r];
+				ret.data()[iter] = _m[iter + m * r];
 			}
 			return ret;
 		}
 
 		// get copy of column
-		vec<n> col(uint c) const {
-			if (c < 0 || c > m) {
-				throw std::runtime_error("Error: matrix column index out of bounds");
-			}
+		constexpr vec<n> col(uint c) const DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(c < m, "Error: matrix column index out of bounds");
 			vec<n> ret;
 			for (uint iter = 0; iter < n; ++iter) {
-				ret[iter] = _m[c + m * iter];
+				ret.data()[iter] = _m[c + m * iter];
 			}
 			return ret;
 		}
 
+		// raw row-major storage access
+		constexpr float* data() noexcept { return _m; }
+		constexpr const float* data() const noexcept { return _m; }
+
 		// right scalar multiplication
-		mat<n, m> operator*(float scal) const {
+		constexpr mat<n, m> operator*(float scal) const noexcept {
 			mat<n, m> ret;
-			for (uint i = 0; i < n; ++i) {
-				for (uint j = 0; j < m; ++j) {
-					ret(i, j) = scal * (*this)(i, j);
-				}
-			}
+			detail::scaleArr<n * m>(data(), scal, ret.data());
 			return ret;
 		}
 
-		mat<n, m> operator*(int scal) const {
-			mat<n, m> ret;
-			for (uint i = 0; i < n; ++i) {
-				for (uint j = 0; j < m; ++j) {
-					ret(i, j) = (float)scal * (*this)(i, j);
-				}
-			}
-			return ret;
+		constexpr mat<n, m> operator*(int scal) const noexcept {
+			return (*this) * (float)scal;
 		}
 
-		mat<n, m> operator*(double scal) const {
-			mat<n, m> ret;
-			for (uint i = 0; i < n; ++i) {
-				for (uint j = 0; j < m; ++j) {
-					ret(i, j) = (float)scal * (*this)(i, j);
-				}
-			}
-			return ret;
+		constexpr mat<n, m> operator*(double scal) const noexcept {
+			return (*this) * (float)scal;
 		}
 
 		// scalar division
-		mat<n, m> operator/(float scal) const {
+		constexpr mat<n, m> operator/(float scal) const noexcept {
 			return (*this) * (1.f / scal);
 		}
 
-		mat<n, m> operator/(int scal) const {
+		constexpr mat<n, m> operator/(int scal) const noexcept {
 			return (*this) * (1.f / (float)scal);
 		}
 
-		mat<n, m> operator/(double scal) const {
+		constexpr mat<n, m> operator/(double scal) const noexcept {
 			return (*this) * (1.f / (float)scal);
 		}
 
 		// matrix addition
-		mat<n, m> operator+(const mat<n, m>& other) const {
+		constexpr mat<n, m> operator+(const mat<n, m>& other) const noexcept {
 			mat<n, m> ret;
-			for (uint i = 0; i < n; ++i) {
-				for (uint j = 0; j < m; ++j) {
-					ret(i, j) = (*this)(i, j) + other(i, j);
-				}
-			}
+			detail::addArr<n * m>(data(), other.data(), ret.data());
 			return ret;
 		}
 
 		// matrix subtraction
-		mat<n, m> operator-(const mat<n, m>& other) const {
-			return (*this) + (-other);
+		constexpr mat<n, m> operator-(const mat<n, m>& other) const noexcept {
+			mat<n, m> ret;
+			detail::subArr<n * m>(data(), other.data(), ret.data());
+			return ret;
+		}
+
+		// in-place arithmetic
+		constexpr mat<n, m>& operator+=(const mat<n, m>& other) noexcept {
+			detail::addArr<n * m>(data(), other.data(), data());
+			return (*this);
+		}
+
+		constexpr mat<n, m>& operator-=(const mat<n, m>& other) noexcept {
+			detail::subArr<n * m>(data(), other.data(), data());
+			return (*this);
+		}
+
+		constexpr mat<n, m>& operator*=(float scal) noexcept {
+			detail::scaleArr<n * m>(data(), scal, data());
+			return (*this);
+		}
+
+		constexpr mat<n, m>& operator/=(float scal) noexcept {
+			detail::scaleArr<n * m>(data(), 1.f / scal, data());
+			return (*this);
 		}
 	private:
-		std::array<float, n * m> _m;
+		// storage with a multiple of four floats is kept 16-byte aligned for the SIMD kernels
+		alignas((n * m) % 4 == 0 ? 16 : alignof(float)) float _m[n * m];
 	};
 
 	class mat3 : public mat<3, 3> {
 	public:
-		mat3(
+		constexpr mat3(
 			float xx, float xy, float xz,
 			float yx, float yy, float yz,
 			float zx, float zy, float zz
-		) : mat<3, 3>({
+		) noexcept : mat<3, 3>({
 				xx, xy, xz,
 				yx, yy, yz,
 				zx, zy, zz
 			}) {}
 
-		mat3(float f) : mat<3, 3>(f) {}
-		mat3() : mat<3, 3>() {}
-		mat3(const mat<3, 3>& rhs) : mat<3, 3>(rhs) {}
-		mat3(const mat<4, 4>& rhs) : mat<3, 3>() {
+		constexpr mat3(float f) noexcept : mat<3, 3>(f) {}
+		constexpr mat3() noexcept : mat<3, 3>() {}
+		constexpr mat3(const mat<3, 3>& rhs) noexcept : mat<3, 3>(rhs) {}
+		constexpr mat3(const mat<4, 4>& rhs) noexcept : mat<3, 3>() {
 			for (uint i = 0; i < 3; ++i) {
 				for (uint j = 0; j < 3; ++j) {
-					(*this)(i, j) = rhs(i, j);
+					data()[j + 3 * i] = rhs.data()[j + 4 * i];
 				}
 			}
 		}
-		mat3& operator=(const mat<3, 3>& rhs) {
-			for (uint i = 0; i < 3; ++i) {
-				for (uint j = 0; j < 3; ++j) {
-					(*this)(i, j) = rhs(i, j);
-				}
-			}
+		constexpr mat3& operator=(const mat<3, 3>& rhs) noexcept {
+			mat<3, 3>::operator=(rhs);
 			return (*this);
 		}
 	};
 
 	class mat4 : public mat<4, 4> {
 	public:
-		mat4(
+		constexpr mat4(
 			float xx, float xy, float xz, float xw,
 			float yx, float yy, float yz, float yw,
 			float zx, float zy, float zz, float zw,
 			float wx, float wy, float wz, float ww
-		) : mat<4, 4>({
+		) noexcept : mat<4, 4>({
 				xx, xy, xz, xw,
 				yx, yy, yz, yw,
 				zx, zy, zz, zw,
 				wx, wy, wz, ww 
 			}) {}
-		mat4(float f) :	mat<4, 4>(f) {}
-		mat4() : mat<4, 4>() {}
-		mat4(const mat<3, 3>& rhs) : mat<4, 4>() {
+		constexpr mat4(float f) noexcept : mat<4, 4>(f) {}
+		constexpr mat4() noexcept : mat<4, 4>() {}
+		constexpr mat4(const mat<3, 3>& rhs) noexcept : mat<4, 4>() {
 			for (uint i = 0; i < 3; ++i) {
 				for (uint j = 0; j < 3; ++j) {
-					(*this)(i, j) = rhs(i, j);
+					data()[j + 4 * i] = rhs.data()[j + 3 * i];
 				}
 			}
-			(*this)(3, 3) = 1.f;
+			data()[15] = 1.f;
 		}
-		mat4(const mat<4, 4>& rhs) : mat<4, 4>(rhs) {}
-		mat4& operator=(const mat<4, 4>& rhs) {
-			for (uint i = 0; i < 4; ++i) {
-				for (uint j = 0; j < 4; ++j) {
-					(*this)(i, j) = rhs(i, j);
+		constexpr mat4(const mat<4, 4>& rhs) noexcept : mat<4, 4>(rhs) {}
+		constexpr mat4& operator=(const mat<4, 4>& rhs) noexcept {
+			mat<4, 4>::operator=(rhs);
+			return (*this);
+		}
+	};
+
+	// Affine transform stored as the top three rows [ L | t ] of a 4x4 matrix
+	//	whose last row is implicitly (0, 0, 0, 1)
+	class affine3x4 : public mat<3, 4> {
+	public:
+		constexpr affine3x4(
+			float xx, float xy, float xz, float xw,
+			float yx, float yy, float yz, float yw,
+			float zx, float zy, float zz, float zw
+		) noexcept : mat<3, 4>({
+				xx, xy, xz, xw,
+				yx, yy, yz, yw,
+				zx, zy, zz, zw
+			}) {}
+		constexpr affine3x4(float f) noexcept : mat<3, 4>(f) {}
+		constexpr affine3x4() noexcept : mat<3, 4>() {}
+		constexpr affine3x4(const mat<3, 4>& rhs) noexcept : mat<3, 4>(rhs) {}
+		constexpr affine3x4(const mat<3, 3>& linear, const vec<3>& transl) noexcept : mat<3, 4>() {
+			for (uint i = 0; i < 3; ++i) {
+				for (uint j = 0; j < 3; ++j) {
+					data()[j + 4 * i] = linear.data()[j + 3 * i];
 				}
+				data()[3 + 4 * i] = transl.data()[i];
 			}
+		}
+		// drops the last row, which is assumed to be (0, 0, 0, 1)
+		constexpr affine3x4(const mat<4, 4>& rhs) noexcept : mat<3, 4>() {
+			for (uint iter = 0; iter < 12; ++iter) {
+				data()[iter] = rhs.data()[iter];
+			}
+		}
+		constexpr affine3x4& operator=(const mat<3, 4>& rhs) noexcept {
+			mat<3, 4>::operator=(rhs);
 			return (*this);
 		}
 	};
@@ -333,9 +469,9 @@ namespace math {
 
 	// vector equality
 	template<uint n>
-	bool operator==(const vec<n>& lhs, const vec<n>& rhs) {
+	constexpr bool operator==(const vec<n>& lhs, const vec<n>& rhs) noexcept {
 		for (uint iter = 0; iter < n; ++iter) {
-			if (lhs[iter] != rhs[iter]) {
+			if (lhs.data()[iter] != rhs.data()[iter]) {
 				return false;
 			}
 		}
@@ -344,32 +480,32 @@ namespace math {
 
 	// left scalar multiplication
 	template<uint n>
-	vec<n> operator*(float scal, const vec<n>& v) {
+	constexpr vec<n> operator*(float scal, const vec<n>& v) noexcept {
 		return v * scal;
 	}
 
 	template<uint n>
-	vec<n> operator*(int scal, const vec<n>& v) {
+	constexpr vec<n> operator*(int scal, const vec<n>& v) noexcept {
 		return v * (float)scal;
 	}
 
 	template<uint n>
-	vec<n> operator*(double scal, const vec<n>& v) {
+	constexpr vec<n> operator*(double scal, const vec<n>& v) noexcept {
 		return v * (float)scal;
 	}
 
 	// negation
 	template<uint n>
-	vec<n> operator-(const vec<n>& v) {
+	constexpr vec<n> operator-(const vec<n>& v) noexcept {
 		return v * (-1.f);
 	}
 
 	// scalar product
 	template<uint n>
-	float dot(const vec<n>& v1, const vec<n>& v2) {
+	constexpr float dot(const vec<n>& v1, const vec<n>& v2) noexcept {
 		float ret = 0.f;
 		for (uint iter = 0; iter < n; ++iter) {
-			ret += v1[iter] * v2[iter];
+			ret += v1.data()[iter] * v2.data()[iter];
 		}
 		return ret;
 	}
@@ -377,24 +513,27 @@ namespace math {
 	// normalize
 	template<uint n>
 	vec<n> normalize(const vec<n>& v) {
-		if (v.norm() == 0.f) {
+		float len = v.norm();
+		if (len == 0.f) {
 			throw std::runtime_error("Cannot normalize the zero vector.");
 		}
-		return v / v.norm();
+		return v / len;
 	}
 
 	// R3 cross product
-	vec<3> cross(const vec<3>& v1, const vec<3>& v2);
+	constexpr vec<3> cross(const vec<3>& v1, const vec<3>& v2) noexcept {
+		return vec<3>({ v1[1] * v2[2] - v1[2] * v2[1],
+						v1[2] * v2[0] - v1[0] * v2[2],
+						v1[0] * v2[1] - v1[1] * v2[0] });
+	}
 
 	// MATRIX OPERATIONS ====================================
 
 	template<uint n, uint m>
-	bool operator==(const mat<n, m>& m1, const mat<n, m>& m2) {
-		for (uint i = 0; i < n; ++i) {
-			for (uint j = 0; j < m; ++j) {
-				if (m1(i, j) != m2(i, j)) {
-					return false;
-				}
+	constexpr bool operator==(const mat<n, m>& m1, const mat<n, m>& m2) noexcept {
+		for (uint iter = 0; iter < n * m; ++iter) {
+			if (m1.data()[iter] != m2.data()[iter]) {
+				return false;
 			}
 		}
 		return true;
@@ -402,11 +541,17 @@ namespace math {
 
 	// matrix multiplication
 	template<uint n, uint m, uint p>
-	mat<n, m> operator*(const mat<n, p>& m1, const mat<p, m>& m2) {
+	constexpr mat<n, m> operator*(const mat<n, p>& m1, const mat<p, m>& m2) noexcept {
 		mat<n, m> ret;
+		const float* a = m1.data();
+		const float* b = m2.data();
 		for (uint i = 0; i < n; ++i) {
 			for (uint j = 0; j < m; ++j) {
-				ret(i, j) = dot(m1.row(i), m2.col(j));
+				float sum = 0.f;
+				for (uint k = 0; k < p; ++k) {
+					sum += a[k + p * i] * b[j + m * k];
+				}
+				ret.data()[j + m * i] = sum;
 			}
 		}
 		return ret;
@@ -414,11 +559,11 @@ namespace math {
 
 	// transpose
 	template<uint n, uint m>
-	mat<m, n> transpose(const mat<n, m>& mt) {
+	constexpr mat<m, n> transpose(const mat<n, m>& mt) noexcept {
 		mat<m, n> ret;
 		for (uint i = 0; i < n; ++i) {
 			for (uint j = 0; j < m; ++j) {
-				ret(j, i) = mt(i, j);
+				ret.data()[i + n * j] = mt.data()[j + m * i];
 			}
 		}
 		return ret;
@@ -426,53 +571,418 @@ namespace math {
 
 	// left scalar multiplication
 	template<uint n, uint m>
-	mat<n, m> operator*(float scal, const mat<n, m>& mt) {
+	constexpr mat<n, m> operator*(float scal, const mat<n, m>& mt) noexcept {
 		return mt * scal;
 	}
 
 	template<uint n, uint m>
-	mat<n, m> operator*(int scal, const mat<n, m>& mt) {
+	constexpr mat<n, m> operator*(int scal, const mat<n, m>& mt) noexcept {
 		return mt * (float)scal;
 	}
 
 	template<uint n, uint m>
-	mat<n, m> operator*(double scal, const mat<n, m>& mt) {
+	constexpr mat<n, m> operator*(double scal, const mat<n, m>& mt) noexcept {
 		return mt * (float)scal;
 	}
 
 	// matrix negation
 	template<uint n, uint m>
-	mat<n, m> operator-(const mat<n, m> mt) {
+	constexpr mat<n, m> operator-(const mat<n, m>& mt) noexcept {
 		return mt * (-1.f);
 	}
 
 	// identity matrix
 	template<uint n>
-	mat<n, n> ident() {
+	constexpr mat<n, n> ident() noexcept {
 		mat<n, n> ret;
 		for (uint i = 0; i < n; ++i) {
-			ret(i, i) = 1.f;
+			ret.data()[i + n * i] = 1.f;
 		}
 		return ret;
 	}
 
 	// matrix vector multiplication
 	template<uint m, uint n>
-	vec<m> operator*(mat<m, n> mt, vec<n> v) {
+	constexpr vec<m> operator*(const mat<m, n>& mt, const vec<n>& v) noexcept {
 		vec<m> ret;
+		const float* mData = mt.data();
+		const float* vData = v.data();
 		for (uint i = 0; i < m; ++i) {
-			ret[i] = dot(mt.row(i), v);
+			float sum = 0.f;
+			for (uint j = 0; j < n; ++j) {
+				sum += mData[j + n * i] * vData[j];
+			}
+			ret.data()[i] = sum;
+		}
+		return ret;
+	}
+
+#ifdef DK_MATH_SSE
+	// 4x4 SIMD specializations. As non-template overloads these are preferred
+	//	over the generic templates above whenever both operands are 4-wide.
+	DK_MATH_SIMD_CONSTEXPR mat<4, 4> operator*(const mat<4, 4>& m1, const mat<4, 4>& m2) noexcept {
+		if (DK_MATH_IS_CONSTANT_EVALUATED()) {
+			return operator*<4, 4, 4>(m1, m2);
+		}
+		mat<4, 4> ret;
+		simd::mul4x4(m1.data(), m2.data(), ret.data());
+		return ret;
+	}
+
+	DK_MATH_SIMD_CONSTEXPR vec<4> operator*(const mat<4, 4>& mt, const vec<4>& v) noexcept {
+		if (DK_MATH_IS_CONSTANT_EVALUATED()) {
+			return operator*<4, 4>(mt, v);
 		}
+		vec<4> ret;
+		simd::mul4x4vec(mt.data(), v.data(), ret.data());
 		return ret;
 	}
 
+	DK_MATH_SIMD_CONSTEXPR mat<4, 4> transpose(const mat<4, 4>& mt) noexcept {
+		if (DK_MATH_IS_CONSTANT_EVALUATED()) {
+			return transpose<4, 4>(mt);
+		}
+		mat<4, 4> ret;
+		simd::transpose4x4(mt.data(), ret.data());
+		return ret;
+	}
+#endif
+
+	constexpr mat<4, 4> scale(float sx, float sy, float sz) noexcept {
+		return mat4(
+			 sx, 0.f, 0.f, 0.f,
+			0.f,  sy, 0.f, 0.f,
+			0.f, 0.f,  sz, 0.f,
+			0.f, 0.f, 0.f, 1.f
+		);
+	}
+
+	constexpr mat<4, 4> translate(float tx, float ty, float tz) noexcept {
+		return mat4(
+			1.f, 0.f, 0.f,  tx,
+			0.f, 1.f, 0.f,  ty,
+			0.f, 0.f, 1.f,  tz,
+			0.f, 0.f, 0.f, 1.f
+		);
+	}
+
 	float determinant(const mat<3, 3>& m);
 	mat<3, 3> inverse(const mat<3, 3>& m);
+
+	// Matrices whose last row is exactly (0, 0, 0, 1) take an affine fast path.
+	//	inverse throws if the matrix is singular.
+	float determinant(const mat<4, 4>& m);
+	mat<4, 4> inverse(const mat<4, 4>& m);
 	mat<3, 3> rotation(float angle, const vec<3>& axis);
-	mat<4, 4> scale(float sx, float sy, float sz);
-	mat<4, 4> translate(float tx, float ty, float tz);
 	mat<4, 4> lookAt(const vec<3>& eye, const vec<3>& center, const vec<3>& up);
 	mat<4, 4> perspective(float fovy, float aspect, float zNear, float zFar);
+
+	// AFFINE TRANSFORMS ====================================
+
+	namespace detail {
+		// out = a * b for an affine b; see simd::mulAffine
+		constexpr void mulAffine(const float* a, uint aRows, const float* b, float* out) noexcept {
+			for (uint i = 0; i < aRows; ++i) {
+				for (uint j = 0; j < 4; ++j) {
+					out[j + 4 * i] =
+						a[4 * i] * b[j] + a[4 * i + 1] * b[j + 4] + a[4 * i + 2] * b[j + 8] +
+						(j == 3 ? a[4 * i + 3] : 0.f);
+				}
+			}
+		}
+	}
+
+	constexpr mat<4, 4> toMat4(const affine3x4& a) noexcept {
+		mat<4, 4> ret;
+		for (uint iter = 0; iter < 12; ++iter) {
+			ret.data()[iter] = a.data()[iter];
+		}
+		ret.data()[15] = 1.f;
+		return ret;
+	}
+
+	// composition of affine transforms
+	DK_MATH_SIMD_CONSTEXPR affine3x4 operator*(const affine3x4& a1, const affine3x4& a2) noexcept {
+		affine3x4 ret;
+#ifdef DK_MATH_SSE
+		if (!DK_MATH_IS_CONSTANT_EVALUATED()) {
+			simd::mulAffine(a1.data(), 3, a2.data(), ret.data());
+			return ret;
+		}
+#endif
+		detail::mulAffine(a1.data(), 3, a2.data(), ret.data());
+		return ret;
+	}
+
+	// full matrix times affine transform, e.g. projection * model-view
+	DK_MATH_SIMD_CONSTEXPR mat<4, 4> operator*(const mat<4, 4>& mt, const affine3x4& a) noexcept {
+		mat<4, 4> ret;
+#ifdef DK_MATH_SSE
+		if (!DK_MATH_IS_CONSTANT_EVALUATED()) {
+			simd::mulAffine(mt.data(), 4, a.data(), ret.data());
+			return ret;
+		}
+#endif
+		detail::mulAffine(mt.data(), 4, a.data(), ret.data());
+		return ret;
+	}
+
+	constexpr vec<4> operator*(const affine3x4& a, const vec<4>& v) noexcept {
+		const float* m = a.data();
+		const float* p = v.data();
+		vec<4> ret;
+		for (uint i = 0; i < 3; ++i) {
+			ret.data()[i] = m[4 * i] * p[0] + m[4 * i + 1] * p[1] + m[4 * i + 2] * p[2] + m[4 * i + 3] * p[3];
+		}
+		ret.data()[3] = p[3];
+		return ret;
+	}
+
+	// General inverse; throws if the linear part is singular
+	affine3x4 inverse(const affine3x4& a);
+
+	// Closed-form inverse for rotation, translation and uniform scale only:
+	//	the linear part is inverted as its transpose divided by the squared scale
+	affine3x4 inverseUniformScale(const affine3x4& a);
+
+	// Inverse transpose of the linear part, for transforming normals. A singular
+	//	linear part yields its cofactor matrix, which still maps normals in the
+	//	right direction, rather than dividing by zero.
+	mat<3, 3> normalMatrix(const affine3x4& a);
+
+	// Batched normal matrices. For each transform, writes the three columns of its
+	//	normal matrix, each padded to four floats with a zero, every outStride
+	//	bytes. That is the std140 layout of a GLSL mat3, and with a 64-byte
+	//	stride the first 12 floats of a column-major mat4.
+	void normalMatrices(const affine3x4* in, float* out, uint outStride, uint count);
+
+	// GPU LAYOUT ===========================================
+
+	// 4x4 matrix stored column-major, the layout GLSL expects for a mat4 in
+	//	uniform, storage and push-constant blocks. Arithmetic stays in the
+	//	row-major types; gpuMat4 is only an upload format, produced directly by
+	//	the constructor and mulToGpu below so nothing is transposed on upload.
+	class gpuMat4 {
+	public:
+		constexpr gpuMat4() noexcept : _m() {}
+		explicit constexpr gpuMat4(const mat<4, 4>& mt) noexcept : _m() {
+			for (uint i = 0; i < 4; ++i) {
+				for (uint j = 0; j < 4; ++j) {
+					_m[i + 4 * j] = mt.data()[j + 4 * i];
+				}
+			}
+		}
+		explicit constexpr gpuMat4(const affine3x4& a) noexcept : _m() {
+			for (uint i = 0; i < 3; ++i) {
+				for (uint j = 0; j < 4; ++j) {
+					_m[i + 4 * j] = a.data()[j + 4 * i];
+				}
+			}
+			_m[15] = 1.f;
+		}
+		constexpr gpuMat4(const gpuMat4& rhs) noexcept = default;
+		constexpr gpuMat4& operator=(const gpuMat4& rhs) noexcept = default;
+
+		// element access in the usual (row, col) order
+		constexpr float& operator()(uint row, uint col) DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(row < 4 && col < 4, "Error: matrix index out of bounds");
+			return _m[row + 4 * col];
+		}
+		constexpr const float& operator()(uint row, uint col) const DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(row < 4 && col < 4, "Error: matrix index out of bounds");
+			return _m[row + 4 * col];
+		}
+
+		constexpr float* data() noexcept { return _m; }
+		constexpr const float* data() const noexcept { return _m; }
+
+	private:
+		alignas(16) float _m[16];
+	};
+
+	static_assert(sizeof(gpuMat4) == 16 * sizeof(float), "gpuMat4 must match the size of a GLSL mat4");
+
+	constexpr mat<4, 4> toMat4(const gpuMat4& g) noexcept {
+		mat<4, 4> ret;
+		for (uint i = 0; i < 4; ++i) {
+			for (uint j = 0; j < 4; ++j) {
+				ret.data()[j + 4 * i] = g.data()[i + 4 * j];
+			}
+		}
+		return ret;
+	}
+
+	namespace detail {
+		// out = transpose(a * b); see simd::mulColMajor
+		constexpr void mulColMajor(const float* a, const float* b, uint bRows, float* out) noexcept {
+			for (uint j = 0; j < 4; ++j) {
+				for (uint i = 0; i < 4; ++i) {
+					out[i + 4 * j] =
+						a[4 * i] * b[j] + a[4 * i + 1] * b[j + 4] + a[4 * i + 2] * b[j + 8] +
+						(bRows == 4 ? a[4 * i + 3] * b[j + 12] : (j == 3 ? a[4 * i + 3] : 0.f));
+				}
+			}
+		}
+	}
+
+	// gpuMat4(a * b) without the intermediate row-major product, e.g. the MVP
+	//	from projection * model-view
+	DK_MATH_SIMD_CONSTEXPR gpuMat4 mulToGpu(const mat<4, 4>& a, const mat<4, 4>& b) noexcept {
+		gpuMat4 ret;
+#ifdef DK_MATH_SSE
+		if (!DK_MATH_IS_CONSTANT_EVALUATED()) {
+			simd::mulColMajor(a.data(), b.data(), 4, ret.data());
+			return ret;
+		}
+#endif
+		detail::mulColMajor(a.data(), b.data(), 4, ret.data());
+		return ret;
+	}
+
+	DK_MATH_SIMD_CONSTEXPR gpuMat4 mulToGpu(const mat<4, 4>& a, const affine3x4& b) noexcept {
+		gpuMat4 ret;
+#ifdef DK_MATH_SSE
+		if (!DK_MATH_IS_CONSTANT_EVALUATED()) {
+			simd::mulColMajor(a.data(), b.data(), 3, ret.data());
+			return ret;
+		}
+#endif
+		detail::mulColMajor(a.data(), b.data(), 3, ret.data());
+		return ret;
+	}
+
+	// out[i] = mulToGpu(a[i], b[i]) for count transforms
+	void mulToGpu(const mat<4, 4>* a, const affine3x4* b, gpuMat4* out, uint count);
+
+	// BATCHED TRANSFORMS ===================================
+
+	// out[i] = mt * in[i] for count vectors. in and out may be the same array.
+	void transformPoints(const mat<4, 4>& mt, const vec<4>* in, vec<4>* out, uint count);
+
+	// Strided variant for interleaved streams such as DkVertex arrays: reads four
+	//	floats every inStride bytes and writes four floats every outStride bytes.
+	void transformPoints(const mat<4, 4>& mt, const float* in, uint inStride, float* out, uint outStride, uint count);
+
+	// Structure-of-arrays variant: in and out each hold the x, y, z and w arrays.
+	//	A null in[3] is treated as w = 1 for every point.
+	void transformPointsSoA(const mat<4, 4>& mt, const float* const in[4], float* const out[4], uint count);
+
+	// out[i] = determinant(in[i]) for count matrices
+	void determinants(const mat<4, 4>* in, float* out, uint count);
+
+	// out[i] = inverse(in[i]) for count matrices. Singular matrices do not throw;
+	//	their output is the zero matrix and they are counted in the return value.
+	//	in and out may be the same array.
+	uint invertMatrices(const mat<4, 4>* in, mat<4, 4>* out, uint count);
+
+	// QUATERNION ===========================================
+
+	// Rotation quaternion stored as (x, y, z, w) with w the scalar part. The
+	//	default is the identity rotation. Arrays of quat are tightly packed,
+	//	which the batched functions below rely on.
+	class quat {
+	public:
+		constexpr quat(float x, float y, float z, float w) noexcept : _q() {
+			_q[0] = x;
+			_q[1] = y;
+			_q[2] = z;
+			_q[3] = w;
+		}
+		constexpr quat() noexcept : quat(0.f, 0.f, 0.f, 1.f) {}
+		constexpr quat(const quat& rhs) noexcept = default;
+		constexpr quat& operator=(const quat& rhs) noexcept = default;
+
+		constexpr float& operator[](uint ind) DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(ind < 4, "Error: quaternion index out of bounds");
+			return _q[ind];
+		}
+
+		constexpr const float& operator[](uint ind) const DK_MATH_INDEX_NOEXCEPT {
+			DK_MATH_CHECK_INDEX(ind < 4, "Error: quaternion index out of bounds");
+			return _q[ind];
+		}
+
+		// raw storage access
+		constexpr float* data() noexcept { return _q; }
+		constexpr const float* data() const noexcept { return _q; }
+
+		float norm() const noexcept {
+			return sqrt(_q[0] * _q[0] + _q[1] * _q[1] + _q[2] * _q[2] + _q[3] * _q[3]);
+		}
+
+	private:
+		alignas(16) float _q[4];
+	};
+
+	constexpr bool operator==(const quat& lhs, const quat& rhs) noexcept {
+		return	lhs.data()[0] == rhs.data()[0] && lhs.data()[1] == rhs.data()[1] &&
+				lhs.data()[2] == rhs.data()[2] && lhs.data()[3] == rhs.data()[3];
+	}
+
+	// composition: (a * b) rotates by b, then by a
+	constexpr quat operator*(const quat& a, const quat& b) noexcept {
+		const float* p = a.data();
+		const float* q = b.data();
+		return quat(
+			p[3] * q[0] + p[0] * q[3] + p[1] * q[2] - p[2] * q[1],
+			p[3] * q[1] - p[0] * q[2] + p[1] * q[3] + p[2] * q[0],
+			p[3] * q[2] + p[0] * q[1] - p[1] * q[0] + p[2] * q[3],
+			p[3] * q[3] - p[0] * q[0] - p[1] * q[1] - p[2] * q[2]
+		);
+	}
+
+	constexpr float dot(const quat& a, const quat& b) noexcept {
+		return	a.data()[0] * b.data()[0] + a.data()[1] * b.data()[1] +
+				a.data()[2] * b.data()[2] + a.data()[3] * b.data()[3];
+	}
+
+	// inverse rotation for unit quaternions
+	constexpr quat conjugate(const quat& q) noexcept {
+		return quat(-q.data()[0], -q.data()[1], -q.data()[2], q.data()[3]);
+	}
+
+	// rotate a vector by a unit quaternion
+	constexpr vec<3> operator*(const quat& q, const vec<3>& v) noexcept {
+		vec<3> u({ q.data()[0], q.data()[1], q.data()[2] });
+		vec<3> t = cross(u, v) * 2.f;
+		return v + t * q.data()[3] + cross(u, t);
+	}
+
+	// rotation matrices for unit quaternions
+	constexpr mat<3, 3> toMat3(const quat& q) noexcept {
+		const float* p = q.data();
+		float xx = p[0] * p[0], yy = p[1] * p[1], zz = p[2] * p[2];
+		float xy = p[0] * p[1], xz = p[0] * p[2], yz = p[1] * p[2];
+		float wx = p[3] * p[0], wy = p[3] * p[1], wz = p[3] * p[2];
+		return mat3(
+			1.f - 2.f * (yy + zz),	2.f * (xy - wz),		2.f * (xz + wy),
+			2.f * (xy + wz),		1.f - 2.f * (xx + zz),	2.f * (yz - wx),
+			2.f * (xz - wy),		2.f * (yz + wx),		1.f - 2.f * (xx + yy)
+		);
+	}
+
+	constexpr mat<4, 4> toMat4(const quat& q) noexcept {
+		return mat4(toMat3(q));
+	}
+
+	quat normalize(const quat& q);
+
+	// rotation of angle degrees about axis, matching rotation(angle, axis)
+	quat axisAngle(float angle, const vec<3>& axis);
+
+	// Interpolation along the shorter arc. nlerp is cheaper but does not move at
+	//	constant angular speed; slerp does.
+	quat nlerp(const quat& a, const quat& b, float t);
+	quat slerp(const quat& a, const quat& b, float t);
+
+	// Batched variants over count quaternions. out may alias an input.
+	void multiplyQuats(const quat* a, const quat* b, quat* out, uint count);
+	void nlerpQuats(const quat* a, const quat* b, float t, quat* out, uint count);
+	void slerpQuats(const quat* a, const quat* b, float t, quat* out, uint count);
+
+	// out[i] = toMat4(in[i]), with the translation column taken from the xyz of
+	//	translations[i] when translations is not null
+	void quatsToMat4(const quat* in, const vec<4>* translations, mat<4, 4>* out, uint count);
 }
 #endif // !DK_MATH_H
 
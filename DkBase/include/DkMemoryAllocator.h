@@ -0,0 +1,92 @@
+#ifndef DK_MEMORY_ALLOCATOR_H
+#define DK_MEMORY_ALLOCATOR_H
+
+#include "DkCommon.h"
+
+struct DkAllocatorStats {
+	VkDeviceSize size;
+	VkDeviceSize usedBytes;
+	VkDeviceSize largestFreeRange;
+	uint allocationCount;
+	uint freeRangeCount;
+};
+
+/*
+*	class DkTlsfAllocator:
+*
+*	Two-level segregated fit allocator over the abstract range [0, size). It
+*	only does the offset bookkeeping and never touches the device, so pools of
+*	device memory (see DkMemoryPool) put one in front of each VkDeviceMemory
+*	block and it can be tested without a GPU.
+*
+*	Free ranges are binned first by power of two and then linearly into
+*	SL_COUNT bins per power; two bitmaps find the smallest non-empty bin that
+*	fits a request, so allocate and free are O(1). Neighbouring free ranges
+*	are merged as soon as either is freed.
+*
+*	Allocations are identified by a handle, which stays valid until freed.
+*
+*/
+class DkTlsfAllocator {
+public:
+	static const uint INVALID_HANDLE = ~0u;
+
+	bool init(VkDeviceSize size);
+	void finalize();
+
+	// Returns INVALID_HANDLE if no free range can hold size bytes at the
+	//	alignment, which must be a power of two
+	uint allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+	// As allocate, but only succeeds if the range found starts below limit;
+	//	otherwise the allocator is left as it was. Compaction uses this to
+	//	claim a lower home for a live allocation
+	uint allocateBelow(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize limit, VkDeviceSize& offset);
+	void free(uint handle);
+
+	// Getters
+	VkDeviceSize getSize() const { return m_size; }
+	VkDeviceSize getOffset(uint handle) const;
+	VkDeviceSize getAllocationSize(uint handle) const;
+	bool isEmpty() const { return m_allocationCount == 0; }
+	DkAllocatorStats getStats() const;
+
+	DkTlsfAllocator();
+	~DkTlsfAllocator() { finalize(); }
+private:
+	static const uint SL_LOG2 = 5;
+	static const uint SL_COUNT = 1 << SL_LOG2;
+	static const uint FL_COUNT = 64 - SL_LOG2 + 1;
+
+	struct node {
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		uint prevPhys;		// address-ordered neighbours, INVALID_HANDLE at the ends
+		uint nextPhys;
+		uint prevFree;		// bin list while free; nextFree chains unused nodes
+		uint nextFree;
+		bool free;
+		bool live;			// false while the node sits in the unused chain
+	};
+
+	static void _mapping(VkDeviceSize size, uint& fl, uint& sl);
+	bool _findFree(VkDeviceSize size, uint& fl, uint& sl) const;
+	uint _newNode();
+	void _releaseNode(uint index);
+	void _insertFree(uint index);
+	void _removeFree(uint index);
+	bool _isAllocated(uint handle) const;
+
+	VkDeviceSize m_size;
+	std::vector<node> m_nodes;
+	uint m_unusedNodes;
+	uint64 m_flBitmap;
+	uint m_slBitmap[FL_COUNT];
+	uint m_bins[FL_COUNT][SL_COUNT];
+
+	// Statistics
+	VkDeviceSize m_usedBytes;
+	uint m_allocationCount;
+	uint m_freeRangeCount;
+};
+
+#endif//DK_MEMORY_ALLOCATOR_H
@@ -0,0 +1,109 @@
+#ifndef DK_MEMORY_POOL_H
+#define DK_MEMORY_POOL_H
+
+#include "DkCommon.h"
+#include "DkMemoryAllocator.h"
+
+class DkDevice;
+
+const VkDeviceSize DEFAULT_MEMORY_BLOCK_SIZE = 64 * 1024 * 1024;
+
+// A sub-range of one of the pool's VkDeviceMemory blocks
+struct DkMemoryAllocation {
+	VkDeviceMemory memory;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	void* mapped;			// host pointer to offset; nullptr unless host visible
+	uint memoryType;
+	uint block;
+	uint handle;
+};
+
+struct DkMemoryBlockStats {
+	uint memoryType;
+	bool linear;
+	bool dedicated;
+	bool mapped;
+	DkAllocatorStats allocator;
+};
+
+/*
+*	class DkMemoryPool:
+*
+*	Sub-allocates device memory so resources don't each need their own
+*	vkAllocateMemory. Blocks of DEFAULT_MEMORY_BLOCK_SIZE (or an eighth of
+*	smaller heaps) are allocated per memory type as needed and carved up by a
+*	DkTlsfAllocator. Requests larger than half a block get a dedicated block
+*	of their own, which is released as soon as it is freed; of the regular
+*	blocks one empty block per memory type is kept around for reuse.
+*
+*	Host visible blocks are mapped once on creation and stay mapped, so
+*	allocations in them come with a host pointer. Allocations in non-coherent
+*	memory are padded to nonCoherentAtomSize so that flushing one never
+*	touches its neighbours.
+*
+*	Linear resources (buffers, linear images) and optimal images are kept in
+*	separate blocks whenever bufferImageGranularity requires it.
+*
+*	The device owns one pool (DkDevice::getMemoryPool); DkDeviceMemory objects
+*	with an owner draw from it unless told otherwise. Not thread safe.
+*
+*/
+class DkMemoryPool {
+public:
+	bool init();
+	void finalize();
+
+	// Setters before init
+	void setBlockSize(VkDeviceSize size);
+
+	bool allocate(const VkMemoryRequirements& reqs, uint memoryType, bool linear, DkMemoryAllocation& alloc);
+	void free(DkMemoryAllocation& alloc);
+
+	// Flushes host writes to [offset, offset + size) of the allocation when
+	//	its memory is not host coherent
+	bool flush(const DkMemoryAllocation& alloc, VkDeviceSize offset, VkDeviceSize size);
+
+	// Getters
+	VkDeviceSize getBlockSize() { return m_blockSize; }
+	void getStats(std::vector<DkMemoryBlockStats>& stats);
+	void printStats();
+
+	DkMemoryPool(DkDevice& device);
+	~DkMemoryPool() { finalize(); }
+	DkMemoryPool(const DkMemoryPool& rhs) = delete;
+	DkMemoryPool& operator=(const DkMemoryPool& rhs) = delete;
+private:
+	struct block {
+		VkDeviceMemory memory;
+		void* mapped;
+		uint memoryType;
+		bool linear;
+		bool dedicated;
+		VkDeviceSize size;
+		DkTlsfAllocator allocator;
+	};
+
+	VkDeviceSize _getBlockSize(uint memoryType);
+	bool _isCoherent(uint memoryType);
+	bool _createBlock(uint memoryType, bool linear, VkDeviceSize size, bool dedicated, uint& index);
+	void _destroyBlock(uint index);
+
+	// Set on construction
+	DkDevice& m_device;
+
+	// Set before init
+	VkDeviceSize m_blockSize;
+
+	// Set by init
+	VkPhysicalDeviceMemoryProperties m_memProps;
+	VkDeviceSize m_atomSize;
+	bool m_separateLinear;
+	bool m_initialized;
+
+	// Blocks are addressed by index from allocations; freed slots are nullptr
+	//	until reused
+	std::vector<block*> m_blocks;
+};
+
+#endif//DK_MEMORY_POOL_H
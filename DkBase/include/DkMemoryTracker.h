@@ -0,0 +1,95 @@
+#ifndef DK_MEMORY_TRACKER_H
+#define DK_MEMORY_TRACKER_H
+
+#include <ostream>
+#include "DkCommon.h"
+
+// Allocation sizes are binned by powers of two: bucket 0 holds sizes up to
+//	256 bytes, bucket n sizes up to 256 << n, the last bucket everything above
+const uint DK_MEMORY_HISTOGRAM_BUCKETS = 20;
+
+struct DkMemoryCounter {
+	VkDeviceSize bytes;
+	VkDeviceSize peakBytes;
+	uint count;
+	uint64 totalCount;			// ever made, including freed ones
+};
+
+// blocks are VkDeviceMemory objects (what vkAllocateMemory hands out and
+//	maxMemoryAllocationCount limits); allocations are the ranges resources
+//	are bound to, pooled or not
+struct DkMemoryUsage {
+	DkMemoryCounter blocks;
+	DkMemoryCounter allocations;
+};
+
+struct DkMemoryHistogram {
+	uint live[DK_MEMORY_HISTOGRAM_BUCKETS];
+	uint64 total[DK_MEMORY_HISTOGRAM_BUCKETS];
+};
+
+// Driver reported figures from VK_EXT_memory_budget, per heap
+struct DkHeapBudget {
+	VkDeviceSize budget;
+	VkDeviceSize usage;
+};
+
+/*
+*	class DkMemoryTracker:
+*
+*	Counts device memory per memory type and per heap, for sizing pools,
+*	spotting leaks in long sessions and deciding when to evict before the
+*	heap runs out. DkMemoryPool and DkDeviceMemory report every block they
+*	allocate and every range they hand out; the tracker itself never calls
+*	Vulkan, so it can be used and tested without a device.
+*
+*	The device owns one tracker (DkDevice::getMemoryTracker) and adds the
+*	driver's budget to it in DkDevice::dumpMemoryStats. Not thread safe.
+*
+*/
+class DkMemoryTracker {
+public:
+	void init(const VkPhysicalDeviceMemoryProperties& memProps);
+	// Reports anything still allocated
+	void finalize();
+
+	// Recording
+	void recordBlockAllocation(uint memoryType, VkDeviceSize size);
+	void recordBlockFree(uint memoryType, VkDeviceSize size);
+	void recordAllocation(uint memoryType, VkDeviceSize size);
+	void recordFree(uint memoryType, VkDeviceSize size);
+
+	// Getters
+	uint getTypeCount() { return m_memProps.memoryTypeCount; }
+	uint getHeapCount() { return m_memProps.memoryHeapCount; }
+	const DkMemoryUsage& getTypeUsage(uint memoryType) { return m_types[memoryType]; }
+	const DkMemoryUsage& getHeapUsage(uint heap) { return m_heaps[heap]; }
+	const DkMemoryUsage& getTotalUsage() { return m_total; }
+	const DkMemoryHistogram& getHistogram() { return m_histogram; }
+
+	static uint getHistogramBucket(VkDeviceSize size);
+	// Largest size in the bucket; ~0 for the last one
+	static VkDeviceSize getHistogramBucketLimit(uint bucket);
+
+	// budgets is indexed by heap; leave it empty when the budget is unknown
+	void writeJson(std::ostream& out, const std::vector<DkHeapBudget>& budgets);
+
+	DkMemoryTracker();
+	DkMemoryTracker(const DkMemoryTracker& rhs) = delete;
+	DkMemoryTracker& operator=(const DkMemoryTracker& rhs) = delete;
+private:
+	void _add(DkMemoryCounter& counter, VkDeviceSize size);
+	void _remove(DkMemoryCounter& counter, VkDeviceSize size);
+	bool _validType(uint memoryType);
+
+	// Set by init
+	VkPhysicalDeviceMemoryProperties m_memProps;
+
+	// Managed internally
+	DkMemoryUsage m_types[VK_MAX_MEMORY_TYPES];
+	DkMemoryUsage m_heaps[VK_MAX_MEMORY_HEAPS];
+	DkMemoryUsage m_total;
+	DkMemoryHistogram m_histogram;
+};
+
+#endif//DK_MEMORY_TRACKER_H
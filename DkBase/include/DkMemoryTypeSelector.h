@@ -0,0 +1,74 @@
+#ifndef DK_MEMORY_TYPE_SELECTOR_H
+#define DK_MEMORY_TYPE_SELECTOR_H
+
+#include <map>
+#include <tuple>
+#include "DkCommon.h"
+
+// How the host and device will use a piece of memory. Each hint implies
+//	required, preferred and avoided property flags on top of those asked for
+enum DkMemoryUsageHint {
+	DK_MEMORY_USAGE_UNKNOWN = 0,	// only the explicit flags count
+	DK_MEMORY_USAGE_GPU_ONLY = 1,	// device local, never mapped
+	DK_MEMORY_USAGE_UPLOAD = 2,		// written once by the host, copied from by the device
+	DK_MEMORY_USAGE_READBACK = 3,	// written by the device, read by the host
+	DK_MEMORY_USAGE_DYNAMIC = 4,	// rewritten by the host often, read in place by the device
+	DK_MEMORY_USAGE_COUNT = 5
+};
+
+struct DkMemoryTypeRequest {
+	VkMemoryPropertyFlags required;
+	VkMemoryPropertyFlags preferred;
+	VkMemoryPropertyFlags avoided;
+	DkMemoryUsageHint usage;
+};
+
+/*
+*	class DkMemoryTypeSelector:
+*
+*	Picks the memory type for an allocation. Types outside the resource's
+*	memoryTypeBits or missing a required flag are out; the rest are ranked
+*	by preferred flags present, then avoided flags present, then flags
+*	nobody asked for (so plain DEVICE_LOCAL wins over the small DEVICE_LOCAL
+*	+ HOST_VISIBLE window unless mapping is wanted), then heap size.
+*
+*	The ranking depends only on the type bits and the request, so it is
+*	computed once per combination and cached. select then walks the ranking
+*	and returns the first type whose heap has room for the allocation, given
+*	the bytes already allocated from each heap; when none has, the first type
+*	whose heap is large enough at all. Makes no Vulkan calls.
+*
+*/
+class DkMemoryTypeSelector {
+public:
+	void init(const VkPhysicalDeviceMemoryProperties& memProps);
+	void finalize();
+
+	// Returns the memory type index, or -1 when no type qualifies. heapUsage
+	//	holds bytes in use per heap and may be empty
+	int select(
+		uint typeBits,
+		const DkMemoryTypeRequest& request,
+		VkDeviceSize size = 0,
+		const std::vector<VkDeviceSize>& heapUsage = {}
+	);
+
+	// The request with the usage hint folded into its flags
+	static DkMemoryTypeRequest resolve(const DkMemoryTypeRequest& request);
+
+	DkMemoryTypeSelector();
+	DkMemoryTypeSelector(const DkMemoryTypeSelector& rhs) = delete;
+	DkMemoryTypeSelector& operator=(const DkMemoryTypeSelector& rhs) = delete;
+private:
+	typedef std::tuple<uint, VkMemoryPropertyFlags, VkMemoryPropertyFlags, VkMemoryPropertyFlags> rankingKey;
+
+	const std::vector<uint>& _getRanking(uint typeBits, const DkMemoryTypeRequest& request);
+
+	// Set by init
+	VkPhysicalDeviceMemoryProperties m_memProps;
+
+	// Candidate types, best first, per (typeBits, resolved request)
+	std::map<rankingKey, std::vector<uint>> m_rankings;
+};
+
+#endif//DK_MEMORY_TYPE_SELECTOR_H
@@ -3,6 +3,8 @@
 
 #include "DkCommon.h"
 #include "DkMath.h"
+#include "DkVertexFormats.h"
+#include "DkGeometryArena.h"
 
 class DkBuffer;
 class DkDevice;
@@ -10,18 +12,34 @@ class DkQueue;
 class DkCommandBuffer;
 class DkUniformBuffer;
 class DkSemaphore;
+class DkUploadManager;
+class DkLinearAllocator;
+struct DkTransientAllocation;
 
 const uint MAX_MESH_INSTANCES = 16;
 
-struct DkVertex {
-	math::vec4 vert;
-	math::vec4 color;
-	math::vec4 normal;
-};
-
+/*
+*	class DkMesh:
+*
+*	Vertices are welded as they are added: repeats of a vertex already in
+*	the mesh become indices, and initVertBuffer builds an index buffer next
+*	to the vertex buffer, 16-bit while the mesh has at most 65536 unique
+*	vertices. Draw it with DkCommandBuffer::bindIndexBuffer and drawIndexed.
+*	Meshes built on an external vertex buffer are not indexed; their vertices
+*	are kept as added and drawn with draw.
+*
+*/
 class DkMesh {
 public:
 	bool initVertBuffer(DkDevice& device, DkCommandBuffer* bfr, DkQueue& queue, bool useUniformMVPBuffer = true);
+	// Queues the vertex upload on the uploader instead of submitting it; the
+	//	buffer is usable once the uploader's next submission completes
+	bool initVertBuffer(DkDevice& device, DkUploadManager& uploader, bool useUniformMVPBuffer = true);
+	// Places the vertices and indices in the arena instead of buffers of
+	//	their own; the mesh's format must match the arena's and the arena
+	//	needs an index buffer. Draws then start at getFirstIndex() of the
+	//	arena's index buffer, with getFirstVertex() as the vertex offset
+	bool initVertBuffer(DkDevice& device, DkGeometryArena& arena, DkUploadManager& uploader, bool useUniformMVPBuffer = true);
 	void finalizeBuffer();
 	void finalize();
 
@@ -32,31 +50,84 @@ public:
 		std::vector<VkVertexInputAttributeDescription>& attributeDescriptions
 	);
 	DkBuffer* getVertBuffer() { return m_vertBuffer; }
+	DkBuffer* getIndexBuffer() { return m_indexBuffer; }
+	VkIndexType getIndexType() { return m_indexType; }
+	DkGeometryArena* getArena() { return m_arena; }
+	// 0 unless the mesh lives in an arena
+	uint getFirstVertex() { return m_arenaRange.firstVertex; }
+	uint getFirstIndex() { return m_arenaRange.firstIndex; }
 	DkBuffer* getMVPBuffer();
 	DkBuffer* getMVNormalBuffer();
+	// The MVP buffers hold one range per frame; bind them as
+	//	UNIFORM_BUFFER_DYNAMIC with these ranges, and the offsets of the last
+	//	pushMVP as dynamic offsets
+	VkDeviceSize getMVPRange() { return m_mvpRange; }
+	VkDeviceSize getMVNormalRange() { return m_normalRange; }
+	uint getMVPOffset() { return (uint)(m_mvpRange * m_mvpFrame); }
+	uint getMVNormalOffset() { return (uint)(m_normalRange * m_mvpFrame); }
 	math::mat4 getMVP(uint index = 0) { return m_proj[index] * m_MV[index]; }
+	math::gpuMat4 getGpuMVP(uint index = 0) { return math::mulToGpu(m_proj[index], m_MV[index]); }
+	bool getPackedNormalMatrices() { return m_packedNormals; }
+	DkVertexFormat getVertexFormat() { return m_vertFormat; }
+	// Unique vertices; every vertex added counts once in the indices. Every
+	//	vertex added on an external buffer, which has no indices
 	uint getVertCount() { return (uint)m_verts.size(); }
+	uint getIndexCount() { return (uint)m_indices.size(); }
 
 	// Setters
 	void addVerts(const std::vector<DkVertex>& verts);
-	void setMV(const math::mat4& mv, uint index = 0);
+	void setMV(const math::affine3x4& mv, uint index = 0);
 	void setProj(const math::mat4& proj, uint index = 0);
+	// Upload normal matrices as std140 mat3 (48 bytes each) instead of mat4;
+	//	the vertex shader must declare them as mat3
+	void setPackedNormalMatrices(bool packed);
+	// Frames that may be in flight at once. Each pushMVP writes the range
+	//	after the previous one, so with one push per frame it never touches
+	//	matrices a frame still executing reads. Defaults to 1
+	void setFrameCount(uint count);
+	// Layout of the vertex buffer built by initVertBuffer. Vertices are still
+	//	added as DkVertex and packed on upload; the pipeline must be given the
+	//	matching type, e.g. addVertexInfo<DkVertexPacked>()
+	void setVertexFormat(DkVertexFormat format);
 
 	bool pushMVP(DkCommandBuffer* bfr, DkQueue& queue, const std::vector<DkSemaphore*>& mvpSignalSemaphores = {}, const std::vector<DkSemaphore*>& normalSignalSemaphores = {});
+	// Writes this frame's MVPs into transient memory instead of the mesh's own
+	//	uniform buffer; bind alloc.offset as the dynamic offset of a
+	//	UNIFORM_BUFFER_DYNAMIC descriptor on alloc.buffer
+	bool pushMVP(DkLinearAllocator& allocator, DkTransientAllocation& alloc);
 
 	DkMesh(DkBuffer* buffer, uint maxInstances = MAX_MESH_INSTANCES);
 	~DkMesh() { finalize(); }
 	DkMesh(const DkMesh& rhs) = delete;
 	DkMesh& operator=(const DkMesh& rhs) = delete;
 private:
+	const void* _packVertices(std::vector<DkVertexPacked>& packed, std::vector<DkVertexOct>& packedOct);
+	const void* _packIndices(std::vector<uint16_t>& packed);
+	bool _checkNoBuffer();
+	bool _createBuffers(DkDevice& device, bool useUniformMVPBuffer);
+	bool _createMVPBuffers(DkDevice& device);
+	uint _getNormalMatrixStride() { return (uint)(m_packedNormals ? 12 * sizeof(float) : sizeof(math::mat4)); }
+
 	uint m_maxInstances;
 	DkBuffer* m_vertBuffer;
+	DkBuffer* m_indexBuffer;
+	VkIndexType m_indexType;
 	DkUniformBuffer* m_mvpBuffer;
 	DkUniformBuffer* m_mvpBufferNormal;
-	std::vector<math::mat4> m_MV;
+	std::vector<math::affine3x4> m_MV;
 	std::vector<math::mat4> m_proj;
 	bool m_extBuffer;
+	DkGeometryArena* m_arena;
+	DkGeometryRange m_arenaRange;
+	bool m_packedNormals;
+	uint m_frameCount;
+	uint m_mvpFrame;
+	VkDeviceSize m_mvpRange;
+	VkDeviceSize m_normalRange;
+	DkVertexFormat m_vertFormat;
 	std::vector<DkVertex> m_verts;
+	std::vector<uint> m_indices;
+	DkVertexWelder m_welder;
 };
 
 #endif//DK_MESH_H
@@ -0,0 +1,87 @@
+#ifndef DK_PARALLEL_RECORDER_H
+#define DK_PARALLEL_RECORDER_H
+
+#include "DkCommon.h"
+#include "DkWorkerPool.h"
+
+class DkDevice;
+class DkQueue;
+class DkCommandPool;
+class DkCommandBuffer;
+class DkRenderPass;
+class DkFramebuffer;
+
+const uint DEFAULT_MIN_DRAWS_PER_THREAD = 256;
+
+// Records draws [first, first + count) into bfr, which already continues the
+//	render pass. Called concurrently from several threads, each with its own
+//	buffer; anything else it touches must be safe to share
+typedef std::function<bool(DkCommandBuffer& bfr, uint first, uint count)> DkRecordFunc;
+
+/*
+*	class DkParallelRecorder:
+*
+*	Splits a frame's draws across worker threads. Each thread records its
+*	share into a secondary command buffer that continues the primary's
+*	render pass, and record() stitches them into the primary, in draw order,
+*	with one vkCmdExecuteCommands.
+*
+*	Command pools are not thread safe, so there is one per thread and per
+*	frame in flight: frame i's pools are reset wholesale at the start of
+*	record(i, ...), which is only legal once the frame's previous submission
+*	has completed (the same point DkFrameResources::reset waits for). Draws
+*	are split into contiguous ranges, using fewer threads when there are
+*	fewer than setMinDrawsPerThread draws for each.
+*
+*	The primary buffer must be inside a render pass begun with
+*	VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS. Secondary buffers inherit
+*	no state: the record function binds the pipeline, descriptor sets,
+*	viewport and scissor itself.
+*
+*/
+class DkParallelRecorder {
+public:
+	bool init();
+	void finalize();
+
+	// Setters before init. The thread count includes the thread calling
+	//	record and defaults to the number of hardware threads
+	void setThreadCount(uint count);
+	void setFrameCount(uint count);
+	void setMinDrawsPerThread(uint count);
+
+	// Getters
+	uint getThreadCount() { return m_threadCount; }
+
+	bool record(
+		uint frameIndex,
+		DkCommandBuffer& primary,
+		DkRenderPass* renderPass,
+		uint subpass,
+		DkFramebuffer* framebuffer,
+		uint drawCount,
+		const DkRecordFunc& recordFunc
+	);
+
+	DkParallelRecorder(DkDevice& device, DkQueue& queue);
+	~DkParallelRecorder() { finalize(); }
+	DkParallelRecorder(const DkParallelRecorder& rhs) = delete;
+	DkParallelRecorder& operator=(const DkParallelRecorder& rhs) = delete;
+private:
+	// Set on construction
+	DkDevice& m_device;
+	DkQueue& m_queue;
+
+	// Set before init
+	uint m_threadCount;
+	uint m_frameCount;
+	uint m_minDrawsPerThread;
+
+	// Set by init; indexed by frame * m_threadCount + thread
+	std::vector<DkCommandPool*> m_pools;
+	std::vector<DkCommandBuffer*> m_bfrs;
+	DkWorkerPool m_workers;
+	bool m_initialized;
+};
+
+#endif//DK_PARALLEL_RECORDER_H
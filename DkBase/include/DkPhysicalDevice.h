@@ -16,11 +16,16 @@ public:
 
 	int findQueueFamilyIndex(VkQueueFlags desiredCapabilities);
 	int findQueueFamilyPresentIndex(DkWindow& window);
+	// Finds a family with the desired capabilities and none of the excluded
+	//	ones, e.g. a transfer-only family. Returns -1 quietly if there is none
+	int findDedicatedQueueFamilyIndex(VkQueueFlags desiredCapabilities, VkQueueFlags excludedCapabilities);
 
 	// Getters
 	VkPhysicalDevice get() { return m_physDevice; }
+	DkInstance& getInstance() { return m_instance; }
 	VkPhysicalDeviceFeatures getFeatures() const { return m_features; }
 	VkPhysicalDeviceMemoryProperties getMemProps() const { return m_memProps; }
+	const VkPhysicalDeviceProperties& getProperties() const { return m_properties; }
 
 	DkPhysicalDevice(const DkPhysicalDevice& rhs) = delete;
 	DkPhysicalDevice& operator=(const DkPhysicalDevice& rhs) = delete;
@@ -7,7 +7,8 @@ enum DkQueueType {
 	DK_GRAPHICS_QUEUE = 0,
 	DK_PRESENT_QUEUE = 1,
 	DK_COMPUTE_QUEUE = 2,
-	DK_NUM_QUEUE_TYPES = 3
+	DK_TRANSFER_QUEUE = 3,
+	DK_NUM_QUEUE_TYPES = 4
 };
 
 class DkQueue {
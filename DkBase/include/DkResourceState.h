@@ -0,0 +1,101 @@
+#ifndef DK_RESOURCE_STATE_H
+#define DK_RESOURCE_STATE_H
+
+#include "DkCommon.h"
+
+// What a command is about to do with a buffer or image. Each usage implies
+//	the stages, access and (for images) layout of the access
+enum DkResourceUsage {
+	DK_RESOURCE_USAGE_TRANSFER_SRC = 0,
+	DK_RESOURCE_USAGE_TRANSFER_DST = 1,
+	DK_RESOURCE_USAGE_VERTEX_BUFFER = 2,
+	DK_RESOURCE_USAGE_INDEX_BUFFER = 3,
+	DK_RESOURCE_USAGE_UNIFORM_BUFFER = 4,			// read by vertex and fragment shaders
+	DK_RESOURCE_USAGE_VERTEX_SHADER_READ = 5,		// sampled or storage read
+	DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ = 6,
+	DK_RESOURCE_USAGE_SHADER_WRITE = 7,			// storage write, any graphics or compute stage
+	DK_RESOURCE_USAGE_COLOR_ATTACHMENT = 8,
+	DK_RESOURCE_USAGE_DEPTH_ATTACHMENT = 9,
+	DK_RESOURCE_USAGE_HOST_READ = 10,
+	DK_RESOURCE_USAGE_PRESENT = 11,
+	DK_RESOURCE_USAGE_COUNT = 12
+};
+
+struct DkUsageInfo {
+	VkPipelineStageFlags stages;
+	VkAccessFlags access;
+	VkImageLayout layout;
+};
+
+// Last known use of a buffer or one image subresource. Start from
+//	DkResourceStateTracker::initialState()
+struct DkResourceState {
+	VkImageLayout layout;
+	uint queueFamily;						// VK_QUEUE_FAMILY_IGNORED until first used on an exclusive queue
+	VkPipelineStageFlags writeStages;		// the last write, or layout transition
+	VkAccessFlags writeAccess;
+	VkPipelineStageFlags readStages;		// reads since the last write
+	VkPipelineStageFlags syncedStages;		// stages already ordered after the last write
+	VkAccessFlags visibleAccess;			// access types the last write is visible to
+	uint releasedTo;						// pending queue family transfer, or VK_QUEUE_FAMILY_IGNORED
+	VkImageLayout releasedFromLayout;
+};
+
+// One barrier element worth of transition
+struct DkStateTransition {
+	VkPipelineStageFlags srcStages;
+	VkPipelineStageFlags dstStages;
+	VkAccessFlags srcAccess;
+	VkAccessFlags dstAccess;
+	VkImageLayout oldLayout;
+	VkImageLayout newLayout;
+	uint srcQueueFamily;
+	uint dstQueueFamily;
+};
+
+/*
+*	class DkResourceStateTracker:
+*
+*	Works out the narrowest barrier between the last known use of a resource
+*	and the next one, and updates the state to match. Reads after reads need
+*	nothing; a read after a write waits only on the stages that wrote and
+*	only for stages and access types not already covered since; writes and
+*	layout transitions wait on every stage that touched the resource since
+*	the previous write. Only writes are ever made available.
+*
+*	Queue family ownership is tracked too: a resource is claimed by the
+*	first exclusive queue family that uses it. Moving it to another family
+*	takes release() on the old family followed by require() on the new one,
+*	which emits the acquiring half of the transfer.
+*
+*	State is advanced at record time, so command buffers must execute in the
+*	order they were recorded against a resource. Makes no Vulkan calls; see
+*	DkCommandBuffer::requireState.
+*
+*/
+class DkResourceStateTracker {
+public:
+	static DkResourceState initialState(VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+	static DkUsageInfo getUsageInfo(DkResourceUsage usage);
+	static bool isWrite(VkAccessFlags access);
+
+	// Appends the transitions needed before a use by queueFamily (pass
+	//	VK_QUEUE_FAMILY_IGNORED for concurrently shared resources) to out;
+	//	nothing when the resource is ready. Buffers ignore layouts. Fails
+	//	when another queue family owns the resource. The acquiring half of a
+	//	transfer starts at the usage's stages, so wait on the semaphore from
+	//	the releasing queue at those stages
+	static bool require(DkResourceState& state, DkResourceUsage usage, uint queueFamily, bool image, std::vector<DkStateTransition>& out);
+	static bool require(DkResourceState& state, const DkUsageInfo& usage, uint queueFamily, bool image, std::vector<DkStateTransition>& out);
+	// Appends the releasing half of a transfer to dstQueueFamily; the image
+	//	moves to the layout of usage on the way
+	static bool release(DkResourceState& state, DkResourceUsage usage, uint dstQueueFamily, bool image, std::vector<DkStateTransition>& out);
+	static bool release(DkResourceState& state, const DkUsageInfo& usage, uint dstQueueFamily, bool image, std::vector<DkStateTransition>& out);
+	// Every access so far has completed and been made visible, e.g. by a
+	//	fence wait after a full barrier; layout and ownership are kept
+	static void settle(DkResourceState& state);
+
+	static bool equal(const DkResourceState& a, const DkResourceState& b);
+};
+
+#endif//DK_RESOURCE_STATE_H
@@ -0,0 +1,161 @@
+#ifndef DK_UPLOAD_MANAGER_H
+#define DK_UPLOAD_MANAGER_H
+
+#include <deque>
+#include "DkCommon.h"
+
+class DkDevice;
+class DkBuffer;
+class DkImage;
+class DkCommandBuffer;
+class DkCommandPool;
+class DkQueue;
+class DkFence;
+class DkSemaphore;
+
+const VkDeviceSize DEFAULT_STAGING_RING_SIZE = 32 * 1024 * 1024;
+
+/*
+*	class DkUploadManager:
+*
+*	Batches uploads of host data into device local buffers and images. Data is
+*	copied into a persistently mapped staging ring as soon as it is queued, so
+*	callers may reuse their memory right away. submit() then records every
+*	queued copy into one command buffer, bracketed by a single barrier before
+*	and a single barrier after, and hands it to the queue in one submission.
+*
+*	Each submission is identified by a ticket that increases monotonically;
+*	isComplete polls it and wait blocks on it. Ring space used by a submission
+*	is reclaimed once its ticket completes. When the ring runs out of space,
+*	queued copies are submitted early and the oldest submissions waited on.
+*	Buffer uploads larger than the ring are split; image uploads must fit.
+*
+*	Uploads are best run on DK_TRANSFER_QUEUE with the graphics queue set as
+*	owner: the copies then overlap rendering, and each submission releases the
+*	resources on the transfer queue, signals a semaphore, and acquires them on
+*	the owner queue in a second submission that waits on it. Tickets complete
+*	with the acquire. Without an owner the upload queue must support the
+*	consuming stages itself.
+*
+*	Barriers come from the resources' tracked states, so uploads wait on the
+*	previous use recorded through requireState. Images are assumed to be
+*	uploaded whole: their previous contents are discarded (old layout
+*	UNDEFINED) and they are left in the layout given. Resources already held
+*	by the owner queue are released back by the owner queue before the
+*	copies, which wait on it; buffers keep their contents.
+*
+*/
+class DkUploadManager {
+public:
+	bool init();
+	void finalize();
+
+	// Setters before init
+	void setStagingSize(VkDeviceSize size);
+	// Queue that consumes the uploaded resources. When its family differs
+	//	from the upload queue's, ownership is released after the copies and
+	//	acquired on this queue
+	void setOwnerQueue(DkCommandPool& pool, DkQueue& queue);
+
+	// Getters
+	DkQueue& getQueue() { return m_queue; }
+	DkQueue& getOwnerQueue() { return m_ownerQueue != nullptr ? *m_ownerQueue : m_queue; }
+	uint64 getCompletedTicket() { return m_completedTicket; }
+
+	// Queueing
+	bool uploadBuffer(
+		DkBuffer& dst,
+		const void* data,
+		VkDeviceSize size,
+		VkDeviceSize dstOffset,
+		VkPipelineStageFlags consumingStage,
+		VkAccessFlags newAccess
+	);
+	bool uploadImage(
+		DkImage& dst,
+		const void* data,
+		VkDeviceSize size,
+		const VkImageSubresourceLayers& subresource,
+		VkExtent3D extent,
+		VkImageLayout newLayout,
+		VkPipelineStageFlags consumingStage,
+		VkAccessFlags newAccess
+	);
+
+	// Submission. Submitting with nothing queued still yields a ticket,
+	//	which completes with the submissions before it
+	bool submit(uint64& ticket, const std::vector<DkSemaphore*>& signalSemaphores = {});
+	bool isComplete(uint64 ticket);
+	bool wait(uint64 ticket);
+
+	DkUploadManager(DkDevice& device, DkCommandPool& pool, DkQueue& queue);
+	~DkUploadManager() { finalize(); }
+	DkUploadManager(const DkUploadManager& rhs) = delete;
+	DkUploadManager& operator=(const DkUploadManager& rhs) = delete;
+private:
+	struct bufferCopy {
+		DkBuffer* dst;
+		VkBufferCopy region;
+		VkPipelineStageFlags stage;
+		VkAccessFlags access;
+	};
+
+	struct imageCopy {
+		DkImage* dst;
+		VkBufferImageCopy region;
+		VkImageLayout layout;
+		VkPipelineStageFlags stage;
+		VkAccessFlags access;
+	};
+
+	struct batch {
+		DkCommandBuffer* cmdBfr;
+		DkCommandBuffer* acquireBfr;	// nullptr without ownership transfer
+		DkCommandBuffer* reclaimBfr;	// nullptr without ownership transfer
+		DkSemaphore* handoff;			// upload queue -> owner queue
+		DkSemaphore* reclaim;			// owner queue -> upload queue
+		DkFence* fence;
+		uint64 ticket;
+		uint64 ringEnd;
+	};
+
+	bool _reserve(VkDeviceSize size, VkDeviceSize& offset);
+	bool _retireOldest();
+	void _retireCompleted();
+	batch* _getBatch();
+	bool _abandon(batch* b, bool submitted);
+
+	// Set on construction
+	DkDevice& m_device;
+	DkCommandPool& m_pool;
+	DkQueue& m_queue;
+
+	// Set before init
+	VkDeviceSize m_stagingSize;
+	DkCommandPool* m_ownerPool;
+	DkQueue* m_ownerQueue;
+
+	// Set by init
+	DkBuffer* m_staging;
+	char* m_ring;
+	bool m_transferOwnership;
+	bool m_initialized;
+
+	// Ring positions only ever grow; the offset into the ring is taken modulo
+	//	its size. m_tail is the start of the oldest data still in use
+	uint64 m_head;
+	uint64 m_tail;
+	uint64 m_batchStart;
+
+	// Queued copies for the next submission
+	std::vector<bufferCopy> m_bufferCopies;
+	std::vector<imageCopy> m_imageCopies;
+
+	// Submissions
+	std::deque<batch*> m_inFlight;
+	std::vector<batch*> m_idle;
+	uint64 m_nextTicket;
+	uint64 m_completedTicket;
+};
+
+#endif//DK_UPLOAD_MANAGER_H
@@ -0,0 +1,130 @@
+#ifndef DK_VERTEX_FORMATS_H
+#define DK_VERTEX_FORMATS_H
+
+#include <unordered_map>
+#include "DkCommon.h"
+#include "DkMath.h"
+
+// Full-precision vertex: 48 bytes, every attribute R32G32B32A32_SFLOAT
+struct DkVertex {
+	math::vec4 vert;
+	math::vec4 color;
+	math::vec4 normal;
+};
+
+enum DkVertexFormat {
+	DK_VERTEX_FORMAT_FULL = 0,		// DkVertex
+	DK_VERTEX_FORMAT_PACKED = 1,	// DkVertexPacked
+	DK_VERTEX_FORMAT_OCT = 2,		// DkVertexOct
+	DK_NUM_VERTEX_FORMATS = 3
+};
+
+// Compressed layouts. Both keep DkVertex's attribute locations (0 position,
+//	1 color, 2 normal) and are consumed through DkPipeline::addVertexInfo<T>.
+
+// 16 bytes: half-float position, unorm8 color and snorm10 normal. Every
+//	attribute still reaches the shader as a vec4, so shaders written for
+//	DkVertex work unchanged. A2B10G10R10_SNORM_PACK32 is not a mandatory vertex
+//	format; query VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT for it, or use
+//	DkVertexOct, when targeting hardware outside the desktop vendors.
+struct DkVertexPacked {
+	uint16_t vert[4];
+	uint32_t color;
+	uint32_t normal;
+
+	static void getPipelineCreateInfo(
+		uint bindingIndex,
+		std::vector<VkVertexInputBindingDescription>& bindingDescription,
+		std::vector<VkVertexInputAttributeDescription>& attributeDescriptions
+	);
+};
+
+// 16 bytes: as DkVertexPacked, but the normal is octahedron-encoded into two
+//	snorm16 values, which is more accurate and uses only mandatory formats. The
+//	shader receives a vec2 at location 2 and decodes it as math::octDecode does:
+//		vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+//		float t = max(-n.z, 0.0);
+//		n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+//		n = normalize(n);
+struct DkVertexOct {
+	uint16_t vert[4];
+	uint32_t color;
+	int16_t normal[2];
+
+	static void getPipelineCreateInfo(
+		uint bindingIndex,
+		std::vector<VkVertexInputBindingDescription>& bindingDescription,
+		std::vector<VkVertexInputAttributeDescription>& attributeDescriptions
+	);
+};
+
+uint getVertexStride(DkVertexFormat format);
+
+// Pack count vertices. Colors are clamped to [0, 1] and normals to [-1, 1];
+//	positions round to the nearest half, so keep meshes within a few thousand
+//	units of their origin. Uses F16C for the halves when the compiler targets it
+//	(AVX2 implies it) and SSE for the rest, four vertices at a time.
+void packVertices(const DkVertex* in, DkVertexPacked* out, uint count);
+void packVertices(const DkVertex* in, DkVertexOct* out, uint count);
+
+DkVertex unpackVertex(const DkVertexPacked& v);
+DkVertex unpackVertex(const DkVertexOct& v);
+
+// The narrowest index type that can address vertexCount vertices
+VkIndexType getIndexType(uint vertexCount);
+uint getIndexStride(VkIndexType type);
+// Narrow 32-bit indices to 16 bits; every index must be below 65536
+void packIndices(const uint* in, uint16_t* out, uint count);
+
+/*
+*	class DkVertexWelder:
+*
+*	Turns a triangle list into unique vertices plus indices. Vertices are
+*	merged only when bit-identical (so 0.f and -0.f stay apart), found
+*	through a hash of their bytes; the first occurrence keeps its place, so
+*	indices follow the order of the input. The lookup lives until clear(),
+*	so welding several batches into the same vertices merges across them.
+*
+*/
+class DkVertexWelder {
+public:
+	// Appends the vertices of in not seen before to verts, and one index
+	//	into verts per vertex of in to indices
+	void weld(const DkVertex* in, uint count, std::vector<DkVertex>& verts, std::vector<uint>& indices);
+	void clear();
+
+	DkVertexWelder();
+	DkVertexWelder(const DkVertexWelder& rhs) = delete;
+	DkVertexWelder& operator=(const DkVertexWelder& rhs) = delete;
+private:
+	struct vertexHash {
+		size_t operator()(const DkVertex& v) const;
+	};
+	struct vertexEqual {
+		bool operator()(const DkVertex& a, const DkVertex& b) const;
+	};
+
+	// Index of each vertex welded so far
+	std::unordered_map<DkVertex, uint, vertexHash, vertexEqual> m_lookup;
+};
+
+// Scalar encoders behind the vertex formats, matching the Vulkan conversion
+//	rules: round to nearest even, snorm scaled by 2^(bits - 1) - 1.
+namespace math {
+	uint16_t floatToHalf(float f);
+	float halfToFloat(uint16_t h);
+
+	// (r, g, b, a) into bytes 0..3
+	uint32_t packUnorm8(const vec<4>& v);
+	vec<4> unpackUnorm8(uint32_t p);
+
+	// x, y and z into 10-bit fields from bit 0, w into the top two bits
+	uint32_t packSnorm10(const vec<4>& v);
+	vec<4> unpackSnorm10(uint32_t p);
+
+	// unit vector to and from a point of the [-1, 1]^2 octahedral map
+	vec<2> octEncode(const vec<3>& n);
+	vec<3> octDecode(const vec<2>& e);
+}
+
+#endif//DK_VERTEX_FORMATS_H
@@ -0,0 +1,66 @@
+#ifndef DK_WORKER_POOL_H
+#define DK_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "DkCommon.h"
+
+/*
+*	class DkWorkerPool:
+*
+*	A fixed set of worker threads for fork-join work on the frame's critical
+*	path, e.g. recording secondary command buffers (see DkParallelRecorder).
+*	The threads are started by init and sleep between calls to run, so
+*	nothing is spawned per frame.
+*
+*	run(count, task) calls task(index) once for every index in [0, count),
+*	spread over the workers and the calling thread, and returns once all have
+*	finished. Tasks are handed out one index at a time, so uneven tasks
+*	balance themselves. run must not be called from inside a task or from two
+*	threads at once. Makes no Vulkan calls.
+*
+*/
+class DkWorkerPool {
+public:
+	// threadCount workers are started besides the calling thread; with 0,
+	//	run executes every task inline
+	bool init(uint threadCount);
+	void finalize();
+
+	void run(uint count, const std::function<void(uint)>& task);
+
+	// Getters
+	uint getThreadCount() { return (uint)m_threads.size(); }
+
+	// Splits [0, total) into parts contiguous ranges whose sizes differ by
+	//	at most one, and returns range part
+	static void split(uint total, uint parts, uint part, uint& first, uint& count);
+
+	DkWorkerPool();
+	~DkWorkerPool() { finalize(); }
+	DkWorkerPool(const DkWorkerPool& rhs) = delete;
+	DkWorkerPool& operator=(const DkWorkerPool& rhs) = delete;
+private:
+	void _workerLoop();
+	void _work();
+
+	// Set by init
+	std::vector<std::thread> m_threads;
+
+	// Managed internally; the task is published under m_mutex and only
+	//	changed once no worker is inside _work
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	const std::function<void(uint)>* m_task;
+	uint m_taskCount;
+	std::atomic<uint> m_next;
+	uint m_active;
+	uint64 m_generation;
+	bool m_stop;
+};
+
+#endif//DK_WORKER_POOL_H
@@ -0,0 +1,250 @@
+// SIMD kernels backing the 4-wide specializations in DkMath.h. All kernels work
+//	on raw, row-major float storage and use unaligned loads, so they are safe on
+//	any float array; aligned math types simply avoid split cache lines.
+//
+//	Selection is at compile time: SSE is assumed on x64 (and x86 with /arch:SSE2),
+//	AVX paths are enabled when the compiler targets AVX (/arch:AVX or higher),
+//	and the batched kernels in DkMath.cpp add AVX2 and AVX-512 (FMA) variants.
+//	Define DK_MATH_NO_SIMD to force the generic scalar templates everywhere.
+
+#if !defined(DK_MATH_NO_SIMD)
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DK_MATH_SSE
+#endif
+#if defined(DK_MATH_SSE) && defined(__AVX__)
+#define DK_MATH_AVX
+#endif
+#if defined(DK_MATH_AVX) && defined(__AVX2__)
+#define DK_MATH_AVX2
+#endif
+#if defined(DK_MATH_AVX2) && defined(__AVX512F__)
+#define DK_MATH_AVX512
+#endif
+#endif
+
+#ifdef DK_MATH_SSE
+
+#ifdef DK_MATH_AVX
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace math {
+	namespace simd {
+		// out = a * b for row-major 4x4 matrices. Each output row is accumulated as
+		//	a(i,0) * b.row(0) + ... + a(i,3) * b.row(3), matching the summation
+		//	order of the generic dot-product implementation.
+		inline void mul4x4(const float* a, const float* b, float* out) {
+#ifdef DK_MATH_AVX
+			__m256 b0 = _mm256_broadcast_ps((const __m128*)(b + 0));
+			__m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+			__m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+			__m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+			for (uint r = 0; r < 4; r += 2) {
+				__m256 rows = _mm256_loadu_ps(a + 4 * r);
+				__m256 res = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1));
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xAA), b2));
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xFF), b3));
+				_mm256_storeu_ps(out + 4 * r, res);
+			}
+#else
+			__m128 b0 = _mm_loadu_ps(b + 0);
+			__m128 b1 = _mm_loadu_ps(b + 4);
+			__m128 b2 = _mm_loadu_ps(b + 8);
+			__m128 b3 = _mm_loadu_ps(b + 12);
+			for (uint r = 0; r < 4; ++r) {
+				__m128 row = _mm_loadu_ps(a + 4 * r);
+				__m128 res = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+				_mm_storeu_ps(out + 4 * r, res);
+			}
+#endif
+		}
+
+		// out = m * v for a row-major 4x4 matrix. The matrix is transposed in
+		//	registers so the result is a sum of scaled columns.
+		inline void mul4x4vec(const float* m, const float* v, float* out) {
+			__m128 c0 = _mm_loadu_ps(m + 0);
+			__m128 c1 = _mm_loadu_ps(m + 4);
+			__m128 c2 = _mm_loadu_ps(m + 8);
+			__m128 c3 = _mm_loadu_ps(m + 12);
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			__m128 vec = _mm_loadu_ps(v);
+			__m128 res = _mm_mul_ps(c0, _mm_shuffle_ps(vec, vec, 0x00));
+			res = _mm_add_ps(res, _mm_mul_ps(c1, _mm_shuffle_ps(vec, vec, 0x55)));
+			res = _mm_add_ps(res, _mm_mul_ps(c2, _mm_shuffle_ps(vec, vec, 0xAA)));
+			res = _mm_add_ps(res, _mm_mul_ps(c3, _mm_shuffle_ps(vec, vec, 0xFF)));
+			_mm_storeu_ps(out, res);
+		}
+
+		// out = a * b where b is an affine 3x4 matrix with an implicit (0, 0, 0, 1)
+		//	last row. a has aRows rows of four: 3 for an affine left operand, 4 for
+		//	a full 4x4 matrix such as a projection.
+		inline void mulAffine(const float* a, uint aRows, const float* b, float* out) {
+			__m128 b0 = _mm_loadu_ps(b + 0);
+			__m128 b1 = _mm_loadu_ps(b + 4);
+			__m128 b2 = _mm_loadu_ps(b + 8);
+			__m128 b3 = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+			for (uint r = 0; r < aRows; ++r) {
+				__m128 row = _mm_loadu_ps(a + 4 * r);
+				__m128 res = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+				_mm_storeu_ps(out + 4 * r, res);
+			}
+		}
+
+		inline void transpose4x4(const float* m, float* out) {
+			__m128 r0 = _mm_loadu_ps(m + 0);
+			__m128 r1 = _mm_loadu_ps(m + 4);
+			__m128 r2 = _mm_loadu_ps(m + 8);
+			__m128 r3 = _mm_loadu_ps(m + 12);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(out + 0, r0);
+			_mm_storeu_ps(out + 4, r1);
+			_mm_storeu_ps(out + 8, r2);
+			_mm_storeu_ps(out + 12, r3);
+		}
+
+		// out = transpose(a * b): the product of row-major 4x4 a and b written
+		//	column-major. The rows are accumulated as in mul4x4 and transposed in
+		//	registers before the only store. With bRows = 3, b is affine with an
+		//	implicit (0, 0, 0, 1) last row.
+		inline void mulColMajor(const float* a, const float* b, uint bRows, float* out) {
+			__m128 b0 = _mm_loadu_ps(b + 0);
+			__m128 b1 = _mm_loadu_ps(b + 4);
+			__m128 b2 = _mm_loadu_ps(b + 8);
+			__m128 b3 = bRows == 4 ? _mm_loadu_ps(b + 12) : _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+			__m128 r[4];
+			for (uint i = 0; i < 4; ++i) {
+				__m128 row = _mm_loadu_ps(a + 4 * i);
+				r[i] = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+				r[i] = _mm_add_ps(r[i], _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+				r[i] = _mm_add_ps(r[i], _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+				r[i] = _mm_add_ps(r[i], _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+			}
+			_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+			_mm_storeu_ps(out + 0, r[0]);
+			_mm_storeu_ps(out + 4, r[1]);
+			_mm_storeu_ps(out + 8, r[2]);
+			_mm_storeu_ps(out + 12, r[3]);
+		}
+
+		// Inverse of a row-major 4x4 matrix by 2x2 block cofactors. With the rows
+		//	split into blocks [ A B ; C D ], every 2x2 block packs into one register
+		//	and the adjugate is assembled from block products. Returns the
+		//	determinant; out is only meaningful when it is non-zero.
+		inline float inverse4x4(const float* m, float* out) {
+			__m128 r0 = _mm_loadu_ps(m + 0);
+			__m128 r1 = _mm_loadu_ps(m + 4);
+			__m128 r2 = _mm_loadu_ps(m + 8);
+			__m128 r3 = _mm_loadu_ps(m + 12);
+
+			__m128 a = _mm_movelh_ps(r0, r1);
+			__m128 b = _mm_movehl_ps(r1, r0);
+			__m128 c = _mm_movelh_ps(r2, r3);
+			__m128 d = _mm_movehl_ps(r3, r2);
+
+			// (|A|, |B|, |C|, |D|)
+			__m128 detSub = _mm_sub_ps(
+				_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1))),
+				_mm_mul_ps(_mm_shuffle_ps(r0, r2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0)))
+			);
+			__m128 detA = _mm_shuffle_ps(detSub, detSub, 0x00);
+			__m128 detB = _mm_shuffle_ps(detSub, detSub, 0x55);
+			__m128 detC = _mm_shuffle_ps(detSub, detSub, 0xAA);
+			__m128 detD = _mm_shuffle_ps(detSub, detSub, 0xFF);
+
+			// 2x2 products: mul(x, y) = x * y, adjMul(x, y) = adj(x) * y, mulAdj(x, y) = x * adj(y)
+			auto mul = [](__m128 x, __m128 y) {
+				return _mm_add_ps(_mm_mul_ps(x, _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 0, 3, 0))),
+					_mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(y, y, _MM_SHUFFLE(1, 2, 1, 2))));
+			};
+			auto adjMul = [](__m128 x, __m128 y) {
+				return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 0, 3, 3)), y),
+					_mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(y, y, _MM_SHUFFLE(1, 0, 3, 2))));
+			};
+			auto mulAdj = [](__m128 x, __m128 y) {
+				return _mm_sub_ps(_mm_mul_ps(x, _mm_shuffle_ps(y, y, _MM_SHUFFLE(0, 3, 0, 3))),
+					_mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(y, y, _MM_SHUFFLE(1, 2, 1, 2))));
+			};
+
+			__m128 dc = adjMul(d, c);
+			__m128 ab = adjMul(a, b);
+			__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mul(b, dc));
+			__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mul(c, ab));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mulAdj(d, ab));
+			__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mulAdj(a, dc));
+
+			// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+			__m128 tr = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+			tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+			tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+			__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+			float detOut = _mm_cvtss_f32(det);
+			if (detOut == 0.f) {
+				return 0.f;
+			}
+			__m128 rDet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det);
+			x = _mm_mul_ps(x, rDet);
+			y = _mm_mul_ps(y, rDet);
+			z = _mm_mul_ps(z, rDet);
+			w = _mm_mul_ps(w, rDet);
+
+			// the block adjugates and the transposition back to rows in one shuffle
+			_mm_storeu_ps(out + 0, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+			_mm_storeu_ps(out + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+			_mm_storeu_ps(out + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+			_mm_storeu_ps(out + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+			return detOut;
+		}
+
+		// Element-wise kernels. count must be a multiple of 4, and out may alias
+		//	either input.
+		inline void scale(const float* in, float scal, float* out, uint count) {
+			uint iter = 0;
+#ifdef DK_MATH_AVX
+			__m256 s8 = _mm256_set1_ps(scal);
+			for (; iter + 8 <= count; iter += 8) {
+				_mm256_storeu_ps(out + iter, _mm256_mul_ps(_mm256_loadu_ps(in + iter), s8));
+			}
+#endif
+			__m128 s4 = _mm_set1_ps(scal);
+			for (; iter < count; iter += 4) {
+				_mm_storeu_ps(out + iter, _mm_mul_ps(_mm_loadu_ps(in + iter), s4));
+			}
+		}
+
+		inline void add(const float* a, const float* b, float* out, uint count) {
+			uint iter = 0;
+#ifdef DK_MATH_AVX
+			for (; iter + 8 <= count; iter += 8) {
+				_mm256_storeu_ps(out + iter, _mm256_add_ps(_mm256_loadu_ps(a + iter), _mm256_loadu_ps(b + iter)));
+			}
+#endif
+			for (; iter < count; iter += 4) {
+				_mm_storeu_ps(out + iter, _mm_add_ps(_mm_loadu_ps(a + iter), _mm_loadu_ps(b + iter)));
+			}
+		}
+
+		inline void sub(const float* a, const float* b, float* out, uint count) {
+			uint iter = 0;
+#ifdef DK_MATH_AVX
+			for (; iter + 8 <= count; iter += 8) {
+				_mm256_storeu_ps(out + iter, _mm256_sub_ps(_mm256_loadu_ps(a + iter), _mm256_loadu_ps(b + iter)));
+			}
+#endif
+			for (; iter < count; iter += 4) {
+				_mm_storeu_ps(out + iter, _mm_sub_ps(_mm_loadu_ps(a + iter), _mm_loadu_ps(b + iter)));
+			}
+		}
+	}
+}
+
+#endif // DK_MATH_SSE
@@ -31,6 +31,7 @@ INSTANCE_LEVEL_VULKAN_FUNCTION(vkGetPhysicalDeviceQueueFamilyProperties)
 #define INSTANCE_LEVEL_VULKAN_FUNCTION_FROM_EXTENSION( function, extension )
 #endif // !INSTANCE_LEVEL_VULKAN_FUNCTION_FROM_EXTENSION
 INSTANCE_LEVEL_VULKAN_FUNCTION_FROM_EXTENSION(vkDestroySurfaceKHR, VK_KHR_SURFACE_EXTENSION_NAME)
+INSTANCE_LEVEL_VULKAN_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceMemoryProperties2KHR, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)
 INSTANCE_LEVEL_VULKAN_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceSurfaceCapabilitiesKHR, VK_KHR_SURFACE_EXTENSION_NAME)
 INSTANCE_LEVEL_VULKAN_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceSurfaceFormatsKHR, VK_KHR_SURFACE_EXTENSION_NAME)
 INSTANCE_LEVEL_VULKAN_FUNCTION_FROM_EXTENSION(vkGetPhysicalDeviceSurfacePresentModesKHR, VK_KHR_SURFACE_EXTENSION_NAME)
@@ -122,6 +123,7 @@ DEVICE_LEVEL_VULKAN_FUNCTION(vkFlushMappedMemoryRanges)
 DEVICE_LEVEL_VULKAN_FUNCTION(vkGetBufferMemoryRequirements)
 DEVICE_LEVEL_VULKAN_FUNCTION(vkGetDeviceQueue)
 DEVICE_LEVEL_VULKAN_FUNCTION(vkGetImageMemoryRequirements)
+DEVICE_LEVEL_VULKAN_FUNCTION(vkGetFenceStatus)
 DEVICE_LEVEL_VULKAN_FUNCTION(vkGetPipelineCacheData)
 DEVICE_LEVEL_VULKAN_FUNCTION(vkMapMemory)
 DEVICE_LEVEL_VULKAN_FUNCTION(vkMergePipelineCaches)
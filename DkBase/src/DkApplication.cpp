@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "DkApplication.h"
 
 DkApplication::DkApplication() :
@@ -88,12 +89,20 @@ bool DkApplication::_findQueueIndices(std::vector<uint>& indices) {
 	test = m_physDevice.findQueueFamilyIndex(VK_QUEUE_COMPUTE_BIT);
 	if (test < 0) return false;
 	m_queues[DK_COMPUTE_QUEUE].setFamIndex((uint)test);
-	if (indices[0] != (uint)test) indices.push_back((uint)test);
+	if (std::find(indices.begin(), indices.end(), (uint)test) == indices.end()) indices.push_back((uint)test);
 
 	test = m_physDevice.findQueueFamilyPresentIndex(m_window);
 	if (test < 0) return false;
 	m_queues[DK_PRESENT_QUEUE].setFamIndex((uint)test);
-	if (indices[0] != (uint)test && indices[1] != (uint)test) indices.push_back((uint)test);
+	if (std::find(indices.begin(), indices.end(), (uint)test) == indices.end()) indices.push_back((uint)test);
+
+	// Prefer a transfer-only family (DMA engine) so uploads run alongside
+	//	rendering, then any non-graphics family; graphics can always transfer
+	test = m_physDevice.findDedicatedQueueFamilyIndex(VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+	if (test < 0) test = m_physDevice.findDedicatedQueueFamilyIndex(VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT);
+	if (test < 0) test = (int)m_queues[DK_GRAPHICS_QUEUE].getFamilyIndex();
+	m_queues[DK_TRANSFER_QUEUE].setFamIndex((uint)test);
+	if (std::find(indices.begin(), indices.end(), (uint)test) == indices.end()) indices.push_back((uint)test);
 
 	for (uint iter = 0; iter < (uint)DK_NUM_QUEUE_TYPES; ++iter) {
 		m_queues[iter].setType((DkQueueType)iter);
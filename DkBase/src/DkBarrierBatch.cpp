@@ -0,0 +1,142 @@
+#include "DkBarrierBatch.h"
+
+// Ranges given as VK_WHOLE_SIZE or VK_REMAINING_* run to the end
+static bool _overlap(uint64 firstA, uint64 countA, uint64 firstB, uint64 countB, uint64 remaining) {
+	uint64 endA = countA == remaining ? ~0ull : firstA + countA;
+	uint64 endB = countB == remaining ? ~0ull : firstB + countB;
+	return firstA < endB && firstB < endA;
+}
+
+static bool _overlap(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b) {
+	return (a.aspectMask & b.aspectMask) != 0 &&
+		_overlap(a.baseMipLevel, a.levelCount, b.baseMipLevel, b.levelCount, VK_REMAINING_MIP_LEVELS) &&
+		_overlap(a.baseArrayLayer, a.layerCount, b.baseArrayLayer, b.layerCount, VK_REMAINING_ARRAY_LAYERS);
+}
+
+static bool _equal(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b) {
+	return a.aspectMask == b.aspectMask && a.baseMipLevel == b.baseMipLevel && a.levelCount == b.levelCount &&
+		a.baseArrayLayer == b.baseArrayLayer && a.layerCount == b.layerCount;
+}
+
+// Two queue family transfers fold only when the second picks up where the
+//	first left off; a barrier without a transfer folds into anything
+static bool _chainsQueues(uint queuedSrc, uint queuedDst, uint nextSrc, uint nextDst) {
+	return queuedSrc == queuedDst || nextSrc == nextDst || queuedDst == nextSrc;
+}
+
+static void _foldQueues(uint& queuedSrc, uint& queuedDst, uint nextSrc, uint nextDst) {
+	if (queuedSrc == queuedDst) {
+		queuedSrc = nextSrc;
+		queuedDst = nextDst;
+	}
+	else if (nextSrc != nextDst) {
+		queuedDst = nextDst;
+	}
+}
+
+DkBarrierBatch::DkBarrierBatch() :
+	m_srcStages(0),
+	m_dstStages(0),
+	m_depFlags(0),
+	m_memory(),
+	m_buffers(),
+	m_images(),
+	m_added(0)
+{}
+
+void DkBarrierBatch::clear() {
+	m_srcStages = 0;
+	m_dstStages = 0;
+	m_depFlags = 0;
+	m_memory.clear();
+	m_buffers.clear();
+	m_images.clear();
+	m_added = 0;
+}
+
+void DkBarrierBatch::_addStages(VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, VkDependencyFlags depFlags) {
+	m_srcStages |= srcStages;
+	m_dstStages |= dstStages;
+	// Flags such as BY_REGION weaken the dependency, so only keep those
+	//	every barrier in the batch asked for
+	m_depFlags = m_added == 0 ? depFlags : (m_depFlags & depFlags);
+	++m_added;
+}
+
+bool DkBarrierBatch::addGlobal(
+	VkPipelineStageFlags srcStages,
+	VkPipelineStageFlags dstStages,
+	VkAccessFlags srcAccess,
+	VkAccessFlags dstAccess,
+	VkDependencyFlags depFlags
+) {
+	if (m_memory.empty()) {
+		m_memory.push_back({ VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr, 0, 0 });
+	}
+	m_memory[0].srcAccessMask |= srcAccess;
+	m_memory[0].dstAccessMask |= dstAccess;
+	_addStages(srcStages, dstStages, depFlags);
+	return true;
+}
+
+bool DkBarrierBatch::addBuffer(
+	VkPipelineStageFlags srcStages,
+	VkPipelineStageFlags dstStages,
+	const VkBufferMemoryBarrier& barrier,
+	VkDependencyFlags depFlags
+) {
+	bool transfersQueue = barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex;
+	for (auto& queued : m_buffers) {
+		if (queued.buffer != barrier.buffer) continue;
+		if (queued.offset == barrier.offset && queued.size == barrier.size) {
+			if (!_chainsQueues(queued.srcQueueFamilyIndex, queued.dstQueueFamilyIndex, barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex)) return false;
+			_foldQueues(queued.srcQueueFamilyIndex, queued.dstQueueFamilyIndex, barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex);
+			queued.srcAccessMask |= barrier.srcAccessMask;
+			queued.dstAccessMask |= barrier.dstAccessMask;
+			_addStages(srcStages, dstStages, depFlags);
+			return true;
+		}
+		// Overlapping ranges may sit side by side unless ownership moves
+		bool queuedTransfers = queued.srcQueueFamilyIndex != queued.dstQueueFamilyIndex;
+		if ((transfersQueue || queuedTransfers) && _overlap(queued.offset, queued.size, barrier.offset, barrier.size, VK_WHOLE_SIZE)) return false;
+	}
+	m_buffers.push_back(barrier);
+	_addStages(srcStages, dstStages, depFlags);
+	return true;
+}
+
+bool DkBarrierBatch::addImage(
+	VkPipelineStageFlags srcStages,
+	VkPipelineStageFlags dstStages,
+	const VkImageMemoryBarrier& barrier,
+	VkDependencyFlags depFlags
+) {
+	for (auto& queued : m_images) {
+		if (queued.image != barrier.image || !_overlap(queued.subresourceRange, barrier.subresourceRange)) continue;
+		// Layouts are per subresource; only identical ranges can be folded
+		if (!_equal(queued.subresourceRange, barrier.subresourceRange)) return false;
+		if (barrier.oldLayout != queued.newLayout && barrier.oldLayout != VK_IMAGE_LAYOUT_UNDEFINED) return false;
+		if (!_chainsQueues(queued.srcQueueFamilyIndex, queued.dstQueueFamilyIndex, barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex)) return false;
+		// Both halves of a queue family transfer must name the same layouts,
+		//	so a transfer can't absorb a layout transition
+		bool queuedTransfers = queued.srcQueueFamilyIndex != queued.dstQueueFamilyIndex;
+		bool transfers = barrier.srcQueueFamilyIndex != barrier.dstQueueFamilyIndex;
+		if (queuedTransfers && barrier.oldLayout != barrier.newLayout) return false;
+		if (transfers && queued.oldLayout != queued.newLayout) return false;
+
+		// Transitioning from UNDEFINED discards the contents, so the folded
+		//	transition does too
+		if (barrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+			queued.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		}
+		queued.newLayout = barrier.newLayout;
+		_foldQueues(queued.srcQueueFamilyIndex, queued.dstQueueFamilyIndex, barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex);
+		queued.srcAccessMask |= barrier.srcAccessMask;
+		queued.dstAccessMask |= barrier.dstAccessMask;
+		_addStages(srcStages, dstStages, depFlags);
+		return true;
+	}
+	m_images.push_back(barrier);
+	_addStages(srcStages, dstStages, depFlags);
+	return true;
+}
\ No newline at end of file
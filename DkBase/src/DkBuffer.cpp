@@ -17,7 +17,9 @@ DkBuffer::DkBuffer(DkDevice& device, DkDeviceMemory* memory) :
 	m_buffer(VK_NULL_HANDLE),
 	m_initialized(false),
 	m_queriedSize(0),
-	m_queriedOffset(0)
+	m_queriedOffset(0),
+	m_mapped(nullptr),
+	m_state(DkResourceStateTracker::initialState())
 {
 	if (!m_extMemory) {
 		m_memory = new DkDeviceMemory(m_device);
@@ -74,6 +76,34 @@ bool DkBuffer::init() {
 		return false;
 	}
 
+	if (!_createBuffer(m_buffer)) return false;
+
+	if (!m_extMemory) {
+		m_memory->setOwner(this);
+		if (!m_memory->init()) return false;
+	}
+	else {
+		VkMemoryRequirements reqs;
+		vkGetBufferMemoryRequirements(m_device.get(), m_buffer, &reqs);
+		if (!m_memory->bind(this, reqs)) return false;
+	}
+
+	if (!m_memory->getMyOffsetAndSize(this, DK_BUFFER_RESOURCE, m_queriedOffset, m_queriedSize)) return false;
+
+	// Host visible memory, including device local + host visible heaps, is
+	//	written in place by pushData
+	if (m_memory->getTypeFlags() & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		void* base = nullptr;
+		if (!m_memory->map(base)) return false;
+		m_mapped = (char*)base + m_queriedOffset;
+	}
+
+	m_state = DkResourceStateTracker::initialState();
+	m_initialized = true;
+	return true;
+}
+
+bool DkBuffer::_createBuffer(VkBuffer& buffer) {
 	VkBufferCreateInfo bufferInfo = {
 		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 		nullptr,
@@ -85,24 +115,10 @@ bool DkBuffer::init() {
 		m_qFamIndices.data()
 	};
 
-	if (vkCreateBuffer(m_device.get(), &bufferInfo, nullptr, &m_buffer) != VK_SUCCESS || m_buffer == VK_NULL_HANDLE) {
+	if (vkCreateBuffer(m_device.get(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS || buffer == VK_NULL_HANDLE) {
 		std::cout << "Failed to create buffer." << std::endl;
 		return false;
 	}
-
-	if (!m_extMemory) {
-		m_memory->setOwner(this);
-		if (!m_memory->init()) return false;
-	}
-	else {
-		VkMemoryRequirements reqs;
-		vkGetBufferMemoryRequirements(m_device.get(), m_buffer, &reqs);
-		if (!m_memory->bind(this, reqs.size)) return false;
-	}
-
-	if (!m_memory->getMyOffsetAndSize(this, DK_BUFFER_RESOURCE, m_queriedOffset, m_queriedSize)) return false;
-
-	m_initialized = true;
 	return true;
 }
 
@@ -111,86 +127,96 @@ void DkBuffer::finalize() {
 		delete m_memory;
 		m_memory = nullptr;
 	}
+	else if (m_extMemory && m_buffer != VK_NULL_HANDLE) {
+		m_memory->unbind(this);
+	}
 	if (m_buffer != VK_NULL_HANDLE) {
 		vkDestroyBuffer(m_device.get(), m_buffer, nullptr);
 		m_buffer = VK_NULL_HANDLE;
 	}
+	m_mapped = nullptr;
 	m_initialized = false;
 }
 
-// Currently assumes any buffer in regular use is VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT only;
-//	An obvious optimization will be to check what memory flag the buffer's bound memory has
-//	set, and only go through this staging rigamarole if we can't confirm host visibility
+bool DkBuffer::flush(VkDeviceSize offset, VkDeviceSize size) {
+	if (m_mapped == nullptr) {
+		std::cout << "Cannot flush a buffer that is not mapped." << std::endl;
+		return false;
+	}
+	if (size == VK_WHOLE_SIZE) size = m_queriedSize - offset;
+	return m_memory->flush(m_queriedOffset + offset, size);
+}
+
 bool DkBuffer::pushData(
 	uint size,
-	void* data,
+	const void* data,
 	DkCommandBuffer* bfr,
-	VkPipelineStageFlags producingStage,
 	VkPipelineStageFlags consumingStage,
-	VkAccessFlags oldAccess,
 	VkAccessFlags newAccess,
 	const std::vector<DkSemaphore*>& signalSemaphores,
-	DkQueue& queue
+	DkQueue& queue,
+	VkDeviceSize offset
 ) {
 	if (!m_initialized) {
 		std::cout << "Cannot push data to an uninitialized buffer." << std::endl;
 		return false;
 	}
+	if (offset + size > m_size) {
+		std::cout << "Cannot push more data than the buffer holds." << std::endl;
+		return false;
+	}
+
+	if (m_mapped != nullptr) {
+		std::memcpy((char*)m_mapped + offset, data, size);
+		if (!flush(offset, size)) return false;
+
+		// Queue submission makes the host writes visible to the device, so
+		//	only the semaphores are left to signal
+		if (signalSemaphores.empty()) return true;
+		std::vector<VkSemaphore> sigSems;
+		for (auto& semaphore : signalSemaphores) {
+			sigSems.push_back(semaphore->get());
+		}
+		VkSubmitInfo submitInfo = {
+			VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			nullptr,
+			0,
+			nullptr,
+			nullptr,
+			0,
+			nullptr,
+			(uint)sigSems.size(),
+			sigSems.data()
+		};
+		if (vkQueueSubmit(queue.get(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+			std::cout << "Failed to signal semaphores." << std::endl;
+			return false;
+		}
+		return true;
+	}
 
 	// init staging buffer
 	DkBuffer stagingBuffer(m_device, nullptr);
 	stagingBuffer.getMemory()->setPropFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	stagingBuffer.getMemory()->setUsage(DK_MEMORY_USAGE_UPLOAD);
 	stagingBuffer.setSize(size);
 	stagingBuffer.setUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
 	if (!stagingBuffer.init()) return false;
 
-	// Map and copy data to staging memory
-	void* localPtr = nullptr;
-	if (vkMapMemory(m_device.get(), stagingBuffer.getMemory()->get(), 0, VK_WHOLE_SIZE, 0, &localPtr) != VK_SUCCESS ||
-		localPtr == nullptr) {
-		std::cout << "Failed to map memory range." << std::endl;
-		return false;
-	}
-	std::memcpy(localPtr, data, size);
-
-	// Flush
-	VkMappedMemoryRange range = {
-		VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-		nullptr,
-		stagingBuffer.getMemory()->get(),
-		0,
-		VK_WHOLE_SIZE
-	};
-	if (vkFlushMappedMemoryRanges(m_device.get(), 1, &range) != VK_SUCCESS) {
-		std::cout << "Failed to flush memory." << std::endl;
+	// Copy data to the mapped staging memory
+	if (stagingBuffer.getMappedData() == nullptr) {
+		std::cout << "Failed to map staging memory." << std::endl;
 		return false;
 	}
-
-	// Unmap buffer memory
-	vkUnmapMemory(m_device.get(), stagingBuffer.getMemory()->get());
+	std::memcpy(stagingBuffer.getMappedData(), data, size);
+	if (!stagingBuffer.flush(0, size)) return false;
 	
 	// Send copy command to device
 	bool recordingOn = bfr->isRecording();
 	if (!recordingOn && !bfr->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)) return false;
-	bfr->setMemoryBarrier(producingStage, VK_PIPELINE_STAGE_TRANSFER_BIT, {}, {
-		{
-			this,
-			oldAccess,
-			VK_ACCESS_TRANSFER_WRITE_BIT,
-			VK_QUEUE_FAMILY_IGNORED,
-			VK_QUEUE_FAMILY_IGNORED
-		}
-	}, {});
-	bfr->deviceMemCopy(*this, stagingBuffer);
-	bfr->setMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, consumingStage, {}, {
-		{
-			this,
-			VK_ACCESS_TRANSFER_WRITE_BIT,
-			newAccess,
-			VK_QUEUE_FAMILY_IGNORED,
-			VK_QUEUE_FAMILY_IGNORED
-		}
-	}, {});
+	if (!bfr->requireState(*this, DK_RESOURCE_USAGE_TRANSFER_DST)) return false;
+	bfr->deviceMemCopy(*this, stagingBuffer, size, offset);
+	if (!bfr->requireState(*this, { consumingStage, newAccess, VK_IMAGE_LAYOUT_UNDEFINED })) return false;
 	if (!recordingOn && !bfr->endRecording()) return false;
 	
 	DkFence fence(m_device);
@@ -5,6 +5,7 @@
 #include "DkFramebuffer.h"
 #include "DkPipeline.h"
 #include "DkMesh.h"
+#include "DkGeometryArena.h"
 #include "DkDescriptorSet.h"
 
 DkCommandBuffer::DkCommandBuffer(DkCommandPool& pool) :
@@ -14,7 +15,11 @@ DkCommandBuffer::DkCommandBuffer(DkCommandPool& pool) :
 	m_initialized(false),
 	m_recording(false),
 	m_inRenderPass(false),
-	m_submitted(false)
+	m_submitted(false),
+	m_subpassContents(VK_SUBPASS_CONTENTS_INLINE),
+	m_stateCache(),
+	m_barriers(),
+	m_pipelineBarrierCount(0)
 {}
 
 void DkCommandBuffer::setBufferHandle(VkCommandBuffer bfr) { 
@@ -23,8 +28,8 @@ void DkCommandBuffer::setBufferHandle(VkCommandBuffer bfr) {
 }
 
 void DkCommandBuffer::setBufferLevel(VkCommandBufferLevel level) {
-	if (m_bufLevel == VK_COMMAND_BUFFER_LEVEL_SECONDARY) {
-		std::cout << "Secondary command buffers not currently supported." << std::endl;
+	if (m_recording) {
+		std::cout << "Cannot alter command buffer level while recording." << std::endl;
 		return;
 	}
 	m_bufLevel = level;
@@ -37,7 +42,63 @@ void DkCommandBuffer::finalize() {
 	}
 }
 
+void DkCommandBuffer::_resetState() {
+	m_recording = false;
+	m_inRenderPass = false;
+	m_submitted = false;
+	m_subpassContents = VK_SUBPASS_CONTENTS_INLINE;
+	m_stateCache.invalidate();
+	m_barriers.clear();
+}
+
 bool DkCommandBuffer::beginRecording(VkCommandBufferUsageFlags usage) {
+	// Secondary buffers need inheritance info even outside a render pass
+	VkCommandBufferInheritanceInfo inheritance = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		nullptr,
+		VK_NULL_HANDLE,
+		0,
+		VK_NULL_HANDLE,
+		VK_FALSE,
+		0,
+		0
+	};
+	return _beginRecording(usage, m_bufLevel == VK_COMMAND_BUFFER_LEVEL_SECONDARY ? &inheritance : nullptr);
+}
+
+bool DkCommandBuffer::beginRecording(
+	DkRenderPass* renderPass,
+	uint subpass,
+	DkFramebuffer* framebuffer,
+	VkCommandBufferUsageFlags usage
+) {
+	if (m_bufLevel != VK_COMMAND_BUFFER_LEVEL_SECONDARY) {
+		std::cout << "Cannot continue a render pass from a primary command buffer." << std::endl;
+		return false;
+	}
+
+	if (renderPass == nullptr) {
+		std::cout << "Cannot begin recording. No render pass provided." << std::endl;
+		return false;
+	}
+
+	VkCommandBufferInheritanceInfo inheritance = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		nullptr,
+		renderPass->get(),
+		subpass,
+		framebuffer != nullptr ? framebuffer->get() : VK_NULL_HANDLE,
+		VK_FALSE,				// occlusion query
+		0,
+		0
+	};
+
+	if (!_beginRecording(usage | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &inheritance)) return false;
+	m_inRenderPass = true;
+	return true;
+}
+
+bool DkCommandBuffer::_beginRecording(VkCommandBufferUsageFlags usage, const VkCommandBufferInheritanceInfo* inheritance) {
 	if (!m_initialized) {
 		std::cout << "Cannot begin recording without a valid command buffer handle." << std::endl;
 	}
@@ -51,13 +112,17 @@ bool DkCommandBuffer::beginRecording(VkCommandBufferUsageFlags usage) {
 		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
 		nullptr,
 		usage,
-		nullptr					// Inheritance info. Currently secondary levels are not supported.
+		inheritance
 	};
 
 	if (vkBeginCommandBuffer(m_commandBuffer, &begInfo) != VK_SUCCESS) {
 		std::cout << "Failed to begin command recording operation." << std::endl;
 		return false;
 	}
+	m_stateCache.invalidate();
+	m_stateCache.resetSkippedCount();
+	m_barriers.clear();
+	m_pipelineBarrierCount = 0;
 	m_recording = true;
 	return true;
 }
@@ -74,10 +139,33 @@ bool DkCommandBuffer::pushConstants(DkPipeline& pipeline, uint index, const void
 		return false;
 	}
 
+	if (!m_stateCache.setPushConstants(pipeline.getLayoutHandle(), range.stageFlags, range.offset, range.size, data)) return true;
 	vkCmdPushConstants(m_commandBuffer, pipeline.getLayoutHandle(), range.stageFlags, range.offset, range.size, data);
 	return true;
 }
 
+bool DkCommandBuffer::pushConstants(DkPipeline& pipeline, uint index, const math::gpuMat4& mat) {
+	if (!m_recording) {
+		std::cout << "Cannot push constants: Command buffer recording not yet initiated." << std::endl;
+		return false;
+	}
+
+	VkPushConstantRange range = pipeline.getPushConstantRangeInfo(index);
+	if (range.stageFlags == 0) {
+		std::cout << "An error occurred while getting push constant range info." << std::endl;
+		return false;
+	}
+
+	if (range.size < sizeof(math::gpuMat4)) {
+		std::cout << "Cannot push matrix: push constant range is smaller than a mat4." << std::endl;
+		return false;
+	}
+
+	if (!m_stateCache.setPushConstants(pipeline.getLayoutHandle(), range.stageFlags, range.offset, sizeof(math::gpuMat4), mat.data())) return true;
+	vkCmdPushConstants(m_commandBuffer, pipeline.getLayoutHandle(), range.stageFlags, range.offset, sizeof(math::gpuMat4), mat.data());
+	return true;
+}
+
 bool DkCommandBuffer::setMemoryBarrier(
 	VkPipelineStageFlags producingStage,
 	VkPipelineStageFlags consumingStage,
@@ -91,19 +179,15 @@ bool DkCommandBuffer::setMemoryBarrier(
 		return false;
 	}
 
-	std::vector<VkMemoryBarrier> memBars;
+	// Queued, not recorded; the batch goes out before the next command that
+	//	could depend on it. A transition the batch can't fold in means the
+	//	queued ones have to happen first
 	for (auto& bar : globalBarriers) {
-		memBars.push_back({
-			VK_STRUCTURE_TYPE_MEMORY_BARRIER,
-			nullptr,
-			bar.oldAccess,
-			bar.newAccess
-		});
+		m_barriers.addGlobal(producingStage, consumingStage, bar.oldAccess, bar.newAccess, depFlags);
 	}
 
-	std::vector<VkBufferMemoryBarrier> bufBars;
 	for (auto& bar : bufferBarriers) {
-		bufBars.push_back({
+		VkBufferMemoryBarrier bufBar = {
 			VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
 			nullptr,
 			bar.oldAccess,
@@ -113,12 +197,12 @@ bool DkCommandBuffer::setMemoryBarrier(
 			bar.bfr->get(),
 			0,
 			VK_WHOLE_SIZE
-		});
+		};
+		_queueBarrier(producingStage, consumingStage, bufBar, depFlags);
 	}
 
-	std::vector<VkImageMemoryBarrier> imgBars;
 	for (auto& bar : imageBarriers) {
-		imgBars.push_back({
+		VkImageMemoryBarrier imgBar = {
 			VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 			nullptr,
 			bar.oldAccess,
@@ -135,28 +219,216 @@ bool DkCommandBuffer::setMemoryBarrier(
 				0,
 				VK_REMAINING_ARRAY_LAYERS
 			}
-		});
+		};
+		_queueBarrier(producingStage, consumingStage, imgBar, depFlags);
 	}
 
-	vkCmdPipelineBarrier(m_commandBuffer, producingStage, consumingStage, depFlags,
+	return true;
+}
+
+void DkCommandBuffer::_queueBarrier(VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, const VkBufferMemoryBarrier& barrier, VkDependencyFlags depFlags) {
+	if (!m_barriers.addBuffer(srcStages, dstStages, barrier, depFlags)) {
+		_flushBarriers();
+		m_barriers.addBuffer(srcStages, dstStages, barrier, depFlags);
+	}
+}
+
+void DkCommandBuffer::_queueBarrier(VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages, const VkImageMemoryBarrier& barrier, VkDependencyFlags depFlags) {
+	if (!m_barriers.addImage(srcStages, dstStages, barrier, depFlags)) {
+		_flushBarriers();
+		m_barriers.addImage(srcStages, dstStages, barrier, depFlags);
+	}
+}
+
+uint DkCommandBuffer::_ownerFamily(VkSharingMode sharing) {
+	// Concurrently shared resources have no owner to transfer
+	return sharing == VK_SHARING_MODE_CONCURRENT ? VK_QUEUE_FAMILY_IGNORED : m_pool.getQueue().getFamilyIndex();
+}
+
+void DkCommandBuffer::_queueTransitions(DkBuffer& buffer, const std::vector<DkStateTransition>& transitions) {
+	for (auto& tr : transitions) {
+		_queueBarrier(tr.srcStages, tr.dstStages, {
+			VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+			nullptr,
+			tr.srcAccess,
+			tr.dstAccess,
+			tr.srcQueueFamily,
+			tr.dstQueueFamily,
+			buffer.get(),
+			0,
+			VK_WHOLE_SIZE
+		}, 0);
+	}
+}
+
+void DkCommandBuffer::_queueTransitions(DkImage& image, const std::vector<DkStateTransition>& transitions, const VkImageSubresourceRange& range) {
+	for (auto& tr : transitions) {
+		_queueBarrier(tr.srcStages, tr.dstStages, {
+			VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			nullptr,
+			tr.srcAccess,
+			tr.dstAccess,
+			tr.oldLayout,
+			tr.newLayout,
+			tr.srcQueueFamily,
+			tr.dstQueueFamily,
+			image.get(),
+			range
+		}, 0);
+	}
+}
+
+bool DkCommandBuffer::_resolveRange(DkImage& image, uint baseMip, uint& mipCount, uint baseLayer, uint& layerCount) {
+	if (mipCount == VK_REMAINING_MIP_LEVELS && baseMip < image.getMipLevels()) {
+		mipCount = image.getMipLevels() - baseMip;
+	}
+	if (layerCount == VK_REMAINING_ARRAY_LAYERS && baseLayer < image.getArrLayers()) {
+		layerCount = image.getArrLayers() - baseLayer;
+	}
+	if (mipCount == 0 || layerCount == 0 || baseMip + mipCount > image.getMipLevels() || baseLayer + layerCount > image.getArrLayers()) {
+		std::cout << "Subresource range exceeds the image." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool DkCommandBuffer::requireState(DkBuffer& buffer, DkResourceUsage usage) {
+	return requireState(buffer, DkResourceStateTracker::getUsageInfo(usage));
+}
+
+bool DkCommandBuffer::requireState(DkImage& image, DkResourceUsage usage, uint baseMip, uint mipCount, uint baseLayer, uint layerCount) {
+	return requireState(image, DkResourceStateTracker::getUsageInfo(usage), baseMip, mipCount, baseLayer, layerCount);
+}
+
+bool DkCommandBuffer::releaseState(DkBuffer& buffer, DkResourceUsage usage, uint dstQueueFamily) {
+	return releaseState(buffer, DkResourceStateTracker::getUsageInfo(usage), dstQueueFamily);
+}
+
+bool DkCommandBuffer::releaseState(DkImage& image, DkResourceUsage usage, uint dstQueueFamily, uint baseMip, uint mipCount, uint baseLayer, uint layerCount) {
+	return releaseState(image, DkResourceStateTracker::getUsageInfo(usage), dstQueueFamily, baseMip, mipCount, baseLayer, layerCount);
+}
+
+bool DkCommandBuffer::requireState(DkBuffer& buffer, const DkUsageInfo& usage) {
+	if (!m_recording) {
+		std::cout << "Cannot require resource state: Command buffer recording not yet initiated." << std::endl;
+		return false;
+	}
+
+	std::vector<DkStateTransition> transitions;
+	if (!DkResourceStateTracker::require(buffer.getState(), usage, _ownerFamily(buffer.getSharingMode()), false, transitions)) return false;
+	_queueTransitions(buffer, transitions);
+	return true;
+}
+
+bool DkCommandBuffer::requireState(DkImage& image, const DkUsageInfo& usage, uint baseMip, uint mipCount, uint baseLayer, uint layerCount) {
+	if (!m_recording) {
+		std::cout << "Cannot require resource state: Command buffer recording not yet initiated." << std::endl;
+		return false;
+	}
+	if (!_resolveRange(image, baseMip, mipCount, baseLayer, layerCount)) return false;
+
+	uint family = _ownerFamily(image.getSharing());
+	std::vector<DkStateTransition> transitions;
+
+	// Usually every subresource in the range is in the same state; then one
+	//	barrier covers the whole range
+	DkResourceState& first = image.getState(baseMip, baseLayer);
+	bool uniform = true;
+	for (uint layer = baseLayer; uniform && layer < baseLayer + layerCount; ++layer) {
+		for (uint mip = baseMip; uniform && mip < baseMip + mipCount; ++mip) {
+			uniform = DkResourceStateTracker::equal(first, image.getState(mip, layer));
+		}
+	}
+
+	if (uniform) {
+		if (!DkResourceStateTracker::require(first, usage, family, true, transitions)) return false;
+		for (uint layer = baseLayer; layer < baseLayer + layerCount; ++layer) {
+			for (uint mip = baseMip; mip < baseMip + mipCount; ++mip) {
+				image.getState(mip, layer) = first;
+			}
+		}
+		_queueTransitions(image, transitions, { image.getAspect(), baseMip, mipCount, baseLayer, layerCount });
+		return true;
+	}
+
+	for (uint layer = baseLayer; layer < baseLayer + layerCount; ++layer) {
+		for (uint mip = baseMip; mip < baseMip + mipCount; ++mip) {
+			transitions.clear();
+			if (!DkResourceStateTracker::require(image.getState(mip, layer), usage, family, true, transitions)) return false;
+			_queueTransitions(image, transitions, { image.getAspect(), mip, 1, layer, 1 });
+		}
+	}
+	return true;
+}
+
+bool DkCommandBuffer::releaseState(DkBuffer& buffer, const DkUsageInfo& usage, uint dstQueueFamily) {
+	if (!m_recording) {
+		std::cout << "Cannot release resource: Command buffer recording not yet initiated." << std::endl;
+		return false;
+	}
+	if (buffer.getSharingMode() == VK_SHARING_MODE_CONCURRENT) return true;
+
+	std::vector<DkStateTransition> transitions;
+	if (!DkResourceStateTracker::release(buffer.getState(), usage, dstQueueFamily, false, transitions)) return false;
+	_queueTransitions(buffer, transitions);
+	return true;
+}
+
+bool DkCommandBuffer::releaseState(DkImage& image, const DkUsageInfo& usage, uint dstQueueFamily, uint baseMip, uint mipCount, uint baseLayer, uint layerCount) {
+	if (!m_recording) {
+		std::cout << "Cannot release resource: Command buffer recording not yet initiated." << std::endl;
+		return false;
+	}
+	if (image.getSharing() == VK_SHARING_MODE_CONCURRENT) return true;
+	if (!_resolveRange(image, baseMip, mipCount, baseLayer, layerCount)) return false;
+
+	std::vector<DkStateTransition> transitions;
+	for (uint layer = baseLayer; layer < baseLayer + layerCount; ++layer) {
+		for (uint mip = baseMip; mip < baseMip + mipCount; ++mip) {
+			transitions.clear();
+			if (!DkResourceStateTracker::release(image.getState(mip, layer), usage, dstQueueFamily, true, transitions)) return false;
+			_queueTransitions(image, transitions, { image.getAspect(), mip, 1, layer, 1 });
+		}
+	}
+	return true;
+}
+
+bool DkCommandBuffer::flushBarriers() {
+	if (!m_recording) {
+		std::cout << "Cannot flush barriers: Command buffer recording not yet initiated." << std::endl;
+		return false;
+	}
+	_flushBarriers();
+	return true;
+}
+
+void DkCommandBuffer::_flushBarriers() {
+	if (m_barriers.isEmpty()) return;
+
+	const std::vector<VkMemoryBarrier>& memBars = m_barriers.getMemoryBarriers();
+	const std::vector<VkBufferMemoryBarrier>& bufBars = m_barriers.getBufferBarriers();
+	const std::vector<VkImageMemoryBarrier>& imgBars = m_barriers.getImageBarriers();
+	vkCmdPipelineBarrier(m_commandBuffer, m_barriers.getSrcStages(), m_barriers.getDstStages(), m_barriers.getDependencyFlags(),
 		(uint)memBars.size(), memBars.data(),
 		(uint)bufBars.size(), bufBars.data(),
 		(uint)imgBars.size(), imgBars.data());
 
-	return true;
+	++m_pipelineBarrierCount;
+	m_barriers.clear();
 }
 
-// Copies whole size of source to offset 0 of buffer. Will add other options
-//	as the need arises.
-bool DkCommandBuffer::deviceMemCopy(DkBuffer& dest, DkBuffer& source) {
+// Copies size bytes from the start of source to destOffset in dest. Will add
+//	other options as the need arises.
+bool DkCommandBuffer::deviceMemCopy(DkBuffer& dest, DkBuffer& source, VkDeviceSize size, VkDeviceSize destOffset) {
 	if (!m_recording) {
 		std::cout << "Cannot record device mem copy command: Command buffer recording not yet initiated." << std::endl;
 		return false;
 	}
+	_flushBarriers();
 	VkBufferCopy copy = {
 		0,					// src offset
-		0,					// dest offset
-		source.getSize()	// size
+		destOffset,			// dest offset
+		size				// size
 	};
 	vkCmdCopyBuffer(m_commandBuffer, source.get(), dest.get(), 1, &copy);
 	return true;
@@ -165,13 +437,19 @@ bool DkCommandBuffer::deviceMemCopy(DkBuffer& dest, DkBuffer& source) {
 bool DkCommandBuffer::beginRenderPass(
 	DkRenderPass* renderPass,
 	DkFramebuffer* framebuffer,
-	const std::vector<VkClearValue>& clearVals
+	const std::vector<VkClearValue>& clearVals,
+	VkSubpassContents contents
 ) {
 	if (!m_recording) {
 		std::cout << "Cannot begin render pass: Command buffer recording not yet initiated." << std::endl;
 		return false;
 	}
 
+	if (m_bufLevel != VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
+		std::cout << "Cannot begin render pass from a secondary command buffer." << std::endl;
+		return false;
+	}
+
 	if (m_inRenderPass) {
 		std::cout << "Already in render pass. Cannot begin a new one." << std::endl;
 		return false;
@@ -187,19 +465,58 @@ bool DkCommandBuffer::beginRenderPass(
 		clearVals.data()
 	};
 
-	vkCmdBeginRenderPass(m_commandBuffer, &info, VK_SUBPASS_CONTENTS_INLINE);
+	_flushBarriers();
+	vkCmdBeginRenderPass(m_commandBuffer, &info, contents);
+	m_stateCache.invalidate();
 
 	m_inRenderPass = true;
+	m_subpassContents = contents;
 	return true;
 }
 
-bool DkCommandBuffer::bindDescriptorSet(DkDescriptorSet* descriptorSet, DkPipeline* pipeline) {
+bool DkCommandBuffer::executeCommands(const std::vector<DkCommandBuffer*>& secondaries) {
+	if (!m_recording) {
+		std::cout << "Cannot execute commands: Command buffer recording not yet initiated." << std::endl;
+		return false;
+	}
+
+	if (m_bufLevel != VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
+		std::cout << "Cannot execute commands from a secondary command buffer." << std::endl;
+		return false;
+	}
+
+	if (m_inRenderPass && m_subpassContents != VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+		std::cout << "Cannot execute commands. Render pass was begun with inline contents." << std::endl;
+		return false;
+	}
+
+	std::vector<VkCommandBuffer> bfrs;
+	for (auto& bfr : secondaries) {
+		if (bfr->getLevel() != VK_COMMAND_BUFFER_LEVEL_SECONDARY || bfr->isRecording()) {
+			std::cout << "Cannot execute commands. Buffers must be secondary and done recording." << std::endl;
+			return false;
+		}
+		bfrs.push_back(bfr->get());
+	}
+
+	if (!bfrs.empty()) {
+		_flushBarriers();
+		vkCmdExecuteCommands(m_commandBuffer, (uint)bfrs.size(), bfrs.data());
+		// state bound in the primary is undefined after secondaries ran
+		m_stateCache.invalidate();
+	}
+	return true;
+}
+
+bool DkCommandBuffer::bindDescriptorSet(DkDescriptorSet* descriptorSet, DkPipeline* pipeline, const std::vector<uint>& dynamicOffsets) {
 	if (!m_recording) {
 		std::cout << "Cannot bind descriptor set. Not yet recording." << std::endl;
 		return false;
 	}
 	VkDescriptorSet set = descriptorSet->get();
-	vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getLayoutHandle(), 0, 1, &set, 0, nullptr);
+	if (!m_stateCache.setDescriptorSet(pipeline->getLayoutHandle(), 0, set, dynamicOffsets)) return true;
+	vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getLayoutHandle(), 0, 1, &set,
+		(uint)dynamicOffsets.size(), dynamicOffsets.data());
 	return true;
 }
 
@@ -209,6 +526,7 @@ bool DkCommandBuffer::bindPipeline(DkPipeline* pipeline) {
 		return false;
 	}
 
+	if (!m_stateCache.setPipeline(pipeline->get())) return true;
 	vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->get());
 	return true;
 }
@@ -219,6 +537,7 @@ bool DkCommandBuffer::setViewport(uint firstViewport, const std::vector<VkViewpo
 		return false;
 	}
 
+	if (!m_stateCache.setViewports(firstViewport, viewports)) return true;
 	vkCmdSetViewport(m_commandBuffer, firstViewport, (uint)viewports.size(), viewports.data());
 	return true;
 }
@@ -229,6 +548,7 @@ bool DkCommandBuffer::setScissor(uint firstScissor, const std::vector<VkRect2D>&
 		return false;
 	}
 
+	if (!m_stateCache.setScissors(firstScissor, scissors)) return true;
 	vkCmdSetScissor(m_commandBuffer, firstScissor, (uint)scissors.size(), scissors.data());
 	return true;
 }
@@ -244,20 +564,90 @@ bool DkCommandBuffer::bindVertexBuffer(DkMesh* vertices) {
 		return false;
 	}
 
-	std::vector<VkBuffer> bfrs = { vertices->getVertBuffer()->get() };
-	std::vector<VkDeviceSize> offsets = { 0 }; // Pending implementation: non-zero vertex buffer offsets
+	return bindVertexBuffer(vertices->getVertBuffer());
+}
+
+bool DkCommandBuffer::bindVertexBuffer(DkGeometryArena& arena) {
+	return bindVertexBuffer(arena.getVertBuffer());
+}
+
+bool DkCommandBuffer::bindVertexBuffer(DkBuffer* buffer, VkDeviceSize offset, uint binding) {
+	if (!m_inRenderPass) {
+		std::cout << "Cannot bind vertex buffer. Render pass not yet started or already ended." << std::endl;
+		return false;
+	}
+
+	if (buffer == nullptr) {
+		std::cout << "Cannot bind vertex buffer. No buffer provided." << std::endl;
+		return false;
+	}
+
+	VkBuffer bfr = buffer->get();
+	if (!m_stateCache.setVertexBuffer(binding, bfr, offset)) return true;
+	vkCmdBindVertexBuffers(m_commandBuffer, binding, 1, &bfr, &offset);
+	return true;
+}
+
+bool DkCommandBuffer::bindIndexBuffer(DkMesh* mesh) {
+	if (mesh == nullptr) {
+		std::cout << "Cannot bind index buffer. No mesh provided." << std::endl;
+		return false;
+	}
+
+	return bindIndexBuffer(mesh->getIndexBuffer(), mesh->getIndexType());
+}
+
+bool DkCommandBuffer::bindIndexBuffer(DkGeometryArena& arena) {
+	return bindIndexBuffer(arena.getIndexBuffer(), arena.getIndexType());
+}
+
+bool DkCommandBuffer::bindIndexBuffer(DkBuffer* buffer, VkIndexType type, VkDeviceSize offset) {
+	if (!m_inRenderPass) {
+		std::cout << "Cannot bind index buffer. Render pass not yet started or already ended." << std::endl;
+		return false;
+	}
+
+	if (buffer == nullptr) {
+		std::cout << "Cannot bind index buffer. No buffer provided." << std::endl;
+		return false;
+	}
+
+	if (!m_stateCache.setIndexBuffer(buffer->get(), offset, type)) return true;
+	vkCmdBindIndexBuffer(m_commandBuffer, buffer->get(), offset, type);
+	return true;
+}
+
+bool DkCommandBuffer::draw(DkMesh* mesh, uint nInstances, uint firstInstance) {
+	if (mesh->getIndexBuffer() != nullptr) {
+		std::cout << "Cannot draw indexed mesh without its indices. Use drawIndexed." << std::endl;
+		return false;
+	}
+	return draw(mesh->getVertCount(), nInstances, mesh->getFirstVertex(), firstInstance);
+}
+
+bool DkCommandBuffer::draw(uint vertexCount, uint instanceCount, uint firstVertex, uint firstInstance) {
+	if (!m_inRenderPass) {
+		std::cout << "Cannot execute draw command. Render pass not yet started or already ended." << std::endl;
+		return false;
+	}
 
-	vkCmdBindVertexBuffers(m_commandBuffer, 0, (uint)bfrs.size(), bfrs.data(), offsets.data());
+	_flushBarriers();
+	vkCmdDraw(m_commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 	return true;
 }
 
-bool DkCommandBuffer::draw(DkMesh* mesh, uint nInstances) {
+bool DkCommandBuffer::drawIndexed(DkMesh* mesh, uint nInstances, uint firstInstance) {
+	return drawIndexed(mesh->getIndexCount(), nInstances, mesh->getFirstIndex(), (int)mesh->getFirstVertex(), firstInstance);
+}
+
+bool DkCommandBuffer::drawIndexed(uint indexCount, uint instanceCount, uint firstIndex, int vertexOffset, uint firstInstance) {
 	if (!m_inRenderPass) {
 		std::cout << "Cannot execute draw command. Render pass not yet started or already ended." << std::endl;
 		return false;
 	}
 
-	vkCmdDraw(m_commandBuffer, mesh->getVertCount(), nInstances, 0, 0); // Pending implementation: varied starting vertices and instances
+	_flushBarriers();
+	vkCmdDrawIndexed(m_commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 	return true;
 }
 
@@ -266,7 +656,9 @@ bool DkCommandBuffer::endRenderPass() {
 		std::cout << "Cannot end render pass. Render pass not yet started or already ended." << std::endl;
 		return false;
 	}
+	_flushBarriers();
 	vkCmdEndRenderPass(m_commandBuffer);
+	m_stateCache.invalidate();
 	m_inRenderPass = false;
 	return true;
 }
@@ -276,11 +668,16 @@ bool DkCommandBuffer::endRecording() {
 		std::cout << "Cannot end recording. No recording operation has started." << std::endl;
 		return false;
 	}
+	_flushBarriers();
 	if (vkEndCommandBuffer(m_commandBuffer) != VK_SUCCESS) {
 		std::cout << "Failed to end command buffer recording operation." << std::endl;
 		return false;
 	}
 	m_recording = false;
+	// a secondary buffer's render pass ends with its recording
+	if (m_bufLevel == VK_COMMAND_BUFFER_LEVEL_SECONDARY) {
+		m_inRenderPass = false;
+	}
 	return true;
 }
 
@@ -289,6 +686,23 @@ bool DkCommandBuffer::submit(
 	const std::vector<DkWaitSemaphoreData>& waitSemaphores,
 	const std::vector<DkSemaphore*>& signalSemaphores,
 	DkFence& fence
+) {
+	return _submit(queue, waitSemaphores, signalSemaphores, fence.get());
+}
+
+bool DkCommandBuffer::submit(
+	DkQueue& queue,
+	const std::vector<DkWaitSemaphoreData>& waitSemaphores,
+	const std::vector<DkSemaphore*>& signalSemaphores
+) {
+	return _submit(queue, waitSemaphores, signalSemaphores, VK_NULL_HANDLE);
+}
+
+bool DkCommandBuffer::_submit(
+	DkQueue& queue,
+	const std::vector<DkWaitSemaphoreData>& waitSemaphores,
+	const std::vector<DkSemaphore*>& signalSemaphores,
+	VkFence fence
 ) {
 	if (!m_initialized) {
 		std::cout << "Cannot submit: command buffer not yet initialized." << std::endl;
@@ -324,7 +738,7 @@ bool DkCommandBuffer::submit(
 		sigSems.data()
 	};
 
-	if (vkQueueSubmit(queue.get(), 1, &submitInfo, fence.get()) != VK_SUCCESS) {
+	if (vkQueueSubmit(queue.get(), 1, &submitInfo, fence) != VK_SUCCESS) {
 		std::cout << "Failed to submit command buffer to queue." << std::endl;
 		return false;
 	}
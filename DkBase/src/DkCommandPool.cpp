@@ -44,6 +44,22 @@ bool DkCommandPool::init() {
 	return true;
 }
 
+bool DkCommandPool::reset(VkCommandPoolResetFlags flags) {
+	if (!m_initialized) {
+		std::cout << "Cannot reset an uninitialized command pool." << std::endl;
+		return false;
+	}
+
+	if (vkResetCommandPool(m_device.get(), m_commandPool, flags) != VK_SUCCESS) {
+		std::cout << "Failed to reset command pool." << std::endl;
+		return false;
+	}
+	for (auto& bfr : m_allocatedBuffers) {
+		bfr->_resetState();
+	}
+	return true;
+}
+
 bool DkCommandPool::allocate(VkCommandBufferLevel level, uint count, std::vector<DkCommandBuffer*>& allocOut) {
 	if (count == 0) {
 		std::cout << "Cannot allocate command buffers: no resources requested." << std::endl;
@@ -0,0 +1,136 @@
+#include <cstring>
+
+#include "DkCommandStateCache.h"
+
+static bool _equal(const VkViewport& a, const VkViewport& b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height &&
+		a.minDepth == b.minDepth && a.maxDepth == b.maxDepth;
+}
+
+static bool _equal(const VkRect2D& a, const VkRect2D& b) {
+	return a.offset.x == b.offset.x && a.offset.y == b.offset.y &&
+		a.extent.width == b.extent.width && a.extent.height == b.extent.height;
+}
+
+// Shared by viewports and scissors: true when every element in
+//	[first, first + values.size()) is known and equal; the shadow is updated
+//	either way
+template<typename T>
+static bool _sameRange(std::vector<T>& shadow, std::vector<bool>& valid, uint first, const std::vector<T>& values) {
+	if (shadow.size() < first + values.size()) {
+		shadow.resize(first + values.size());
+		valid.resize(first + values.size(), false);
+	}
+	bool same = true;
+	for (uint iter = 0; iter < values.size(); ++iter) {
+		same = same && valid[first + iter] && _equal(shadow[first + iter], values[iter]);
+		shadow[first + iter] = values[iter];
+		valid[first + iter] = true;
+	}
+	return same;
+}
+
+DkCommandStateCache::DkCommandStateCache() :
+	m_pipeline(VK_NULL_HANDLE),
+	m_setLayout(VK_NULL_HANDLE),
+	m_sets(),
+	m_vertexBuffers(),
+	m_indexBuffer({ VK_NULL_HANDLE, 0, false }),
+	m_indexType(VK_INDEX_TYPE_UINT16),
+	m_viewports(),
+	m_viewportValid(),
+	m_scissors(),
+	m_scissorValid(),
+	m_pushLayout(VK_NULL_HANDLE),
+	m_pushData(),
+	m_pushStages(),
+	m_skipped(0)
+{}
+
+void DkCommandStateCache::invalidate() {
+	m_pipeline = VK_NULL_HANDLE;
+	m_setLayout = VK_NULL_HANDLE;
+	m_sets.clear();
+	m_vertexBuffers.clear();
+	m_indexBuffer = { VK_NULL_HANDLE, 0, false };
+	m_viewports.clear();
+	m_viewportValid.clear();
+	m_scissors.clear();
+	m_scissorValid.clear();
+	m_pushLayout = VK_NULL_HANDLE;
+	// A stage mask of 0 marks a byte as unknown
+	std::memset(m_pushStages, 0, sizeof(m_pushStages));
+}
+
+bool DkCommandStateCache::_skip() {
+	++m_skipped;
+	return false;
+}
+
+bool DkCommandStateCache::setPipeline(VkPipeline pipeline) {
+	if (pipeline != VK_NULL_HANDLE && pipeline == m_pipeline) return _skip();
+	m_pipeline = pipeline;
+	return true;
+}
+
+bool DkCommandStateCache::setDescriptorSet(VkPipelineLayout layout, uint setIndex, VkDescriptorSet set, const std::vector<uint>& dynamicOffsets) {
+	if (layout != m_setLayout) {
+		m_sets.clear();
+		m_setLayout = layout;
+	}
+	if (m_sets.size() <= setIndex) {
+		m_sets.resize(setIndex + 1, { VK_NULL_HANDLE, {}, false });
+	}
+	boundSet& bound = m_sets[setIndex];
+	if (bound.valid && bound.set == set && bound.dynamicOffsets == dynamicOffsets) return _skip();
+	bound = { set, dynamicOffsets, true };
+	return true;
+}
+
+bool DkCommandStateCache::setVertexBuffer(uint binding, VkBuffer buffer, VkDeviceSize offset) {
+	if (m_vertexBuffers.size() <= binding) {
+		m_vertexBuffers.resize(binding + 1, { VK_NULL_HANDLE, 0, false });
+	}
+	boundBuffer& bound = m_vertexBuffers[binding];
+	if (bound.valid && bound.buffer == buffer && bound.offset == offset) return _skip();
+	bound = { buffer, offset, true };
+	return true;
+}
+
+bool DkCommandStateCache::setIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type) {
+	if (m_indexBuffer.valid && m_indexBuffer.buffer == buffer && m_indexBuffer.offset == offset && m_indexType == type) return _skip();
+	m_indexBuffer = { buffer, offset, true };
+	m_indexType = type;
+	return true;
+}
+
+bool DkCommandStateCache::setViewports(uint first, const std::vector<VkViewport>& viewports) {
+	if (_sameRange(m_viewports, m_viewportValid, first, viewports)) return _skip();
+	return true;
+}
+
+bool DkCommandStateCache::setScissors(uint first, const std::vector<VkRect2D>& scissors) {
+	if (_sameRange(m_scissors, m_scissorValid, first, scissors)) return _skip();
+	return true;
+}
+
+bool DkCommandStateCache::setPushConstants(VkPipelineLayout layout, VkShaderStageFlags stages, uint offset, uint size, const void* data) {
+	if (layout != m_pushLayout) {
+		std::memset(m_pushStages, 0, sizeof(m_pushStages));
+		m_pushLayout = layout;
+	}
+	if (offset + size > DK_MAX_CACHED_PUSH_CONSTANT_BYTES) return true;
+
+	const uint8_t* bytes = (const uint8_t*)data;
+	bool same = std::memcmp(m_pushData + offset, bytes, size) == 0;
+	for (uint iter = offset; same && iter < offset + size; ++iter) {
+		same = m_pushStages[iter] == stages;
+	}
+	if (same) return _skip();
+
+	std::memcpy(m_pushData + offset, bytes, size);
+	for (uint iter = offset; iter < offset + size; ++iter) {
+		m_pushStages[iter] = stages;
+	}
+	return true;
+}
\ No newline at end of file
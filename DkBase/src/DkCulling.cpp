@@ -0,0 +1,185 @@
+#include "DkCulling.h"
+
+namespace math {
+	frustum extractFrustum(const mat<4, 4>& viewProj) {
+		// A point p is inside when -w <= x, y <= w and 0 <= z <= w for
+		//	(x, y, z, w) = viewProj * p, so every plane is a sum or difference of rows
+		vec4 r0 = viewProj.row(0);
+		vec4 r1 = viewProj.row(1);
+		vec4 r2 = viewProj.row(2);
+		vec4 r3 = viewProj.row(3);
+
+		frustum f;
+		f.planes[FRUSTUM_LEFT] = r3 + r0;
+		f.planes[FRUSTUM_RIGHT] = r3 - r0;
+		f.planes[FRUSTUM_BOTTOM] = r3 + r1;
+		f.planes[FRUSTUM_TOP] = r3 - r1;
+		f.planes[FRUSTUM_NEAR] = r2;
+		f.planes[FRUSTUM_FAR] = r3 - r2;
+
+		for (uint iter = 0; iter < FRUSTUM_PLANE_COUNT; ++iter) {
+			vec<4>& p = f.planes[iter];
+			float len = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+			if (len > 0.f) {
+				p /= len;
+			}
+		}
+		return f;
+	}
+
+	bool isSphereVisible(const frustum& f, const vec<3>& center, float radius) {
+		for (uint iter = 0; iter < FRUSTUM_PLANE_COUNT; ++iter) {
+			const vec<4>& p = f.planes[iter];
+			if (p[0] * center[0] + p[1] * center[1] + p[2] * center[2] + p[3] < -radius) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool isAABBVisible(const frustum& f, const vec<3>& boxMin, const vec<3>& boxMax) {
+		for (uint iter = 0; iter < FRUSTUM_PLANE_COUNT; ++iter) {
+			// the corner furthest along the plane normal
+			const vec<4>& p = f.planes[iter];
+			float x = p[0] >= 0.f ? boxMax[0] : boxMin[0];
+			float y = p[1] >= 0.f ? boxMax[1] : boxMin[1];
+			float z = p[2] >= 0.f ? boxMax[2] : boxMin[2];
+			if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0.f) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Appends base + k for every set bit k of mask. Every candidate index is
+	//	written and the count only advances for visible ones, which keeps the
+	//	loop branch-free; writes never pass base + width - 1.
+	static inline uint appendVisible(int mask, uint base, uint width, uint* visible, uint visibleCount) {
+		for (uint k = 0; k < width; ++k) {
+			visible[visibleCount] = base + k;
+			visibleCount += (mask >> k) & 1;
+		}
+		return visibleCount;
+	}
+
+	uint cullSpheres(const frustum& f, const sphereSoA& spheres, uint count, uint* visible) {
+		uint visibleCount = 0;
+		uint iter = 0;
+#ifdef DK_MATH_AVX
+		__m256 planes8[FRUSTUM_PLANE_COUNT][4];
+		for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+			for (uint c = 0; c < 4; ++c) {
+				planes8[p][c] = _mm256_set1_ps(f.planes[p][c]);
+			}
+		}
+		for (; iter + 8 <= count; iter += 8) {
+			__m256 x = _mm256_loadu_ps(spheres.x + iter);
+			__m256 y = _mm256_loadu_ps(spheres.y + iter);
+			__m256 z = _mm256_loadu_ps(spheres.z + iter);
+			__m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + iter));
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+				__m256 dist = _mm256_add_ps(_mm256_mul_ps(planes8[p][0], x), _mm256_mul_ps(planes8[p][1], y));
+				dist = _mm256_add_ps(dist, _mm256_add_ps(_mm256_mul_ps(planes8[p][2], z), planes8[p][3]));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, negRadius, _CMP_GE_OQ));
+			}
+			visibleCount = appendVisible(_mm256_movemask_ps(inside), iter, 8, visible, visibleCount);
+		}
+#endif
+#ifdef DK_MATH_SSE
+		__m128 planes4[FRUSTUM_PLANE_COUNT][4];
+		for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+			for (uint c = 0; c < 4; ++c) {
+				planes4[p][c] = _mm_set1_ps(f.planes[p][c]);
+			}
+		}
+		for (; iter + 4 <= count; iter += 4) {
+			__m128 x = _mm_loadu_ps(spheres.x + iter);
+			__m128 y = _mm_loadu_ps(spheres.y + iter);
+			__m128 z = _mm_loadu_ps(spheres.z + iter);
+			__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.radius + iter));
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+				__m128 dist = _mm_add_ps(_mm_mul_ps(planes4[p][0], x), _mm_mul_ps(planes4[p][1], y));
+				dist = _mm_add_ps(dist, _mm_add_ps(_mm_mul_ps(planes4[p][2], z), planes4[p][3]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negRadius));
+			}
+			visibleCount = appendVisible(_mm_movemask_ps(inside), iter, 4, visible, visibleCount);
+		}
+#endif
+		for (; iter < count; ++iter) {
+			vec3 center(spheres.x[iter], spheres.y[iter], spheres.z[iter]);
+			if (isSphereVisible(f, center, spheres.radius[iter])) {
+				visible[visibleCount++] = iter;
+			}
+		}
+		return visibleCount;
+	}
+
+	uint cullAABBs(const frustum& f, const aabbSoA& boxes, uint count, uint* visible) {
+		// The corner furthest along each plane normal depends only on the signs
+		//	of the plane, so the min or max array is picked once per plane
+		const float* cornerX[FRUSTUM_PLANE_COUNT];
+		const float* cornerY[FRUSTUM_PLANE_COUNT];
+		const float* cornerZ[FRUSTUM_PLANE_COUNT];
+		for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+			cornerX[p] = f.planes[p][0] >= 0.f ? boxes.maxX : boxes.minX;
+			cornerY[p] = f.planes[p][1] >= 0.f ? boxes.maxY : boxes.minY;
+			cornerZ[p] = f.planes[p][2] >= 0.f ? boxes.maxZ : boxes.minZ;
+		}
+
+		uint visibleCount = 0;
+		uint iter = 0;
+#ifdef DK_MATH_AVX
+		__m256 planes8[FRUSTUM_PLANE_COUNT][4];
+		for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+			for (uint c = 0; c < 4; ++c) {
+				planes8[p][c] = _mm256_set1_ps(f.planes[p][c]);
+			}
+		}
+		for (; iter + 8 <= count; iter += 8) {
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+				__m256 dist = _mm256_add_ps(
+					_mm256_mul_ps(planes8[p][0], _mm256_loadu_ps(cornerX[p] + iter)),
+					_mm256_mul_ps(planes8[p][1], _mm256_loadu_ps(cornerY[p] + iter)));
+				dist = _mm256_add_ps(dist, _mm256_add_ps(
+					_mm256_mul_ps(planes8[p][2], _mm256_loadu_ps(cornerZ[p] + iter)), planes8[p][3]));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+			visibleCount = appendVisible(_mm256_movemask_ps(inside), iter, 8, visible, visibleCount);
+		}
+#endif
+#ifdef DK_MATH_SSE
+		__m128 planes4[FRUSTUM_PLANE_COUNT][4];
+		for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+			for (uint c = 0; c < 4; ++c) {
+				planes4[p][c] = _mm_set1_ps(f.planes[p][c]);
+			}
+		}
+		for (; iter + 4 <= count; iter += 4) {
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+				__m128 dist = _mm_add_ps(
+					_mm_mul_ps(planes4[p][0], _mm_loadu_ps(cornerX[p] + iter)),
+					_mm_mul_ps(planes4[p][1], _mm_loadu_ps(cornerY[p] + iter)));
+				dist = _mm_add_ps(dist, _mm_add_ps(
+					_mm_mul_ps(planes4[p][2], _mm_loadu_ps(cornerZ[p] + iter)), planes4[p][3]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, _mm_setzero_ps()));
+			}
+			visibleCount = appendVisible(_mm_movemask_ps(inside), iter, 4, visible, visibleCount);
+		}
+#endif
+		for (; iter < count; ++iter) {
+			uint inside = 1;
+			for (uint p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+				const vec<4>& plane = f.planes[p];
+				float dist = plane[0] * cornerX[p][iter] + plane[1] * cornerY[p][iter] + plane[2] * cornerZ[p][iter] + plane[3];
+				inside &= dist >= 0.f ? 1 : 0;
+			}
+			visible[visibleCount] = iter;
+			visibleCount += inside;
+		}
+		return visibleCount;
+	}
+}
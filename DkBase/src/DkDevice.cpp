@@ -1,16 +1,43 @@
 #include "DkDevice.h"
+#include <cstring>
 #include "DkUtils.h"
 #include "DkApplication.h"
+#include "DkMemoryPool.h"
+#include "DkInstance.h"
+
+// Not yet in the bundled vulkan.h
+#ifndef VK_EXT_memory_budget
+#define VK_EXT_MEMORY_BUDGET_EXTENSION_NAME "VK_EXT_memory_budget"
+static const VkStructureType VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT = (VkStructureType)1000237000;
+typedef struct VkPhysicalDeviceMemoryBudgetPropertiesEXT {
+	VkStructureType sType;
+	void* pNext;
+	VkDeviceSize heapBudget[VK_MAX_MEMORY_HEAPS];
+	VkDeviceSize heapUsage[VK_MAX_MEMORY_HEAPS];
+} VkPhysicalDeviceMemoryBudgetPropertiesEXT;
+#endif
 
 DkDevice::DkDevice(DkPhysicalDevice& physDevice) :
 	m_physDevice(physDevice),
 	m_queueIndices(),
 	m_desiredExts({ VK_KHR_SWAPCHAIN_EXTENSION_NAME }),
 	m_desiredFeatures({}),
+	m_optionalExts(),
 	m_device(VK_NULL_HANDLE),
+	m_enabledExts(),
+	m_memoryTracker(),
+	m_memoryTypeSelector(),
+	m_memoryPool(nullptr),
 	m_initialized(false)
 {
 	m_desiredFeatures.geometryShader = VK_TRUE;
+	m_memoryPool = new DkMemoryPool(*this);
+}
+
+DkDevice::~DkDevice() {
+	finalize();
+	delete m_memoryPool;
+	m_memoryPool = nullptr;
 }
 
 void DkDevice::setDesiredExts(const std::vector<const char*>& desiredExts) {
@@ -46,6 +73,21 @@ bool DkDevice::init() {
 	for (auto& ext : m_desiredExts) {
 		if (!IsExtensionSupported(available, ext)) return false;
 	}
+	m_enabledExts = m_desiredExts;
+	// The budget is queried through VK_KHR_get_physical_device_properties2,
+	//	which VK_EXT_memory_budget requires on the instance
+	m_optionalExts.clear();
+	if (m_physDevice.getInstance().isExtensionEnabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+		m_optionalExts.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
+	for (auto& ext : m_optionalExts) {
+		for (auto& avail : available) {
+			if (strcmp(avail.extensionName, ext) == 0) {
+				m_enabledExts.push_back(ext);
+				break;
+			}
+		}
+	}
 
 	// Check for feature support -- for now, we only check for shaders if desired
 	if (m_desiredFeatures.geometryShader == VK_TRUE && m_physDevice.getFeatures().geometryShader != VK_TRUE) {
@@ -78,8 +120,8 @@ bool DkDevice::init() {
 		queueInfos.data(),
 		0,							// layer count
 		nullptr,					// layer names
-		(uint)m_desiredExts.size(),
-		m_desiredExts.data(),
+		(uint)m_enabledExts.size(),
+		m_enabledExts.data(),
 		&m_desiredFeatures
 	};
 
@@ -88,7 +130,11 @@ bool DkDevice::init() {
 		return false;
 	}
 
-	if (!loadDeviceFns(m_device, m_desiredExts)) return false;
+	if (!loadDeviceFns(m_device, m_enabledExts)) return false;
+
+	m_memoryTracker.init(m_physDevice.getMemProps());
+	m_memoryTypeSelector.init(m_physDevice.getMemProps());
+	if (!m_memoryPool->init()) return false;
 
 	m_initialized = true;
 	return true;
@@ -96,12 +142,46 @@ bool DkDevice::init() {
 
 void DkDevice::finalize() {
 	if (m_device != VK_NULL_HANDLE) {
+		m_memoryPool->finalize();
+		m_memoryTracker.finalize();
+		m_memoryTypeSelector.finalize();
 		vkDestroyDevice(m_device, nullptr);
 		m_device = VK_NULL_HANDLE;
 	}
 	m_initialized = false;
 }
 
+bool DkDevice::isExtensionEnabled(const char* ext) {
+	for (auto& enabled : m_enabledExts) {
+		if (strcmp(enabled, ext) == 0) return true;
+	}
+	return false;
+}
+
+bool DkDevice::getMemoryBudget(std::vector<DkHeapBudget>& budgets) {
+	budgets.clear();
+	if (!isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) return false;
+
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {};
+	budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2KHR memProps = {
+		VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR,
+		&budgetProps,
+		{}
+	};
+	vkGetPhysicalDeviceMemoryProperties2KHR(m_physDevice.get(), &memProps);
+	for (uint iter = 0; iter < memProps.memoryProperties.memoryHeapCount; ++iter) {
+		budgets.push_back({ budgetProps.heapBudget[iter], budgetProps.heapUsage[iter] });
+	}
+	return true;
+}
+
+void DkDevice::dumpMemoryStats(std::ostream& out) {
+	std::vector<DkHeapBudget> budgets;
+	getMemoryBudget(budgets);
+	m_memoryTracker.writeJson(out, budgets);
+}
+
 bool DkDevice::waitIdle() {
 	if (vkDeviceWaitIdle(m_device) != VK_SUCCESS) {
 		std::cout << "Device wait failed." << std::endl;
@@ -4,6 +4,8 @@
 #include "DkDevice.h"
 #include "DkImage.h"
 #include "DkBuffer.h"
+#include "DkCommandBuffer.h"
+#include "DkFence.h"
 
 DkDeviceMemory::DkDeviceMemory(DkDevice& device) :
 	m_device(device),
@@ -11,9 +13,20 @@ DkDeviceMemory::DkDeviceMemory(DkDevice& device) :
 	m_bfr(nullptr),
 	m_reqs({}),
 	m_memProps(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+	m_preferredFlags(0),
+	m_avoidedFlags(0),
+	m_usage(DK_MEMORY_USAGE_UNKNOWN),
+	m_pooled(true),
 	m_devMemory(VK_NULL_HANDLE),
+	m_alloc({}),
+	m_typeFlags(0),
+	m_mapped(nullptr),
 	m_initialized(false),
 	m_offset(0),
+	m_shared(false),
+	m_memoryType(0),
+	m_granularity(1),
+	m_heap(),
 	m_bindings()
 {}
 
@@ -51,6 +64,38 @@ void DkDeviceMemory::setPropFlags(VkMemoryPropertyFlags flags) {
 	m_memProps = flags;
 }
 
+void DkDeviceMemory::setPreferredFlags(VkMemoryPropertyFlags flags) {
+	if (m_initialized) {
+		std::cout << "Cannot alter preferred flags after initialization." << std::endl;
+		return;
+	}
+	m_preferredFlags = flags;
+}
+
+void DkDeviceMemory::setAvoidedFlags(VkMemoryPropertyFlags flags) {
+	if (m_initialized) {
+		std::cout << "Cannot alter avoided flags after initialization." << std::endl;
+		return;
+	}
+	m_avoidedFlags = flags;
+}
+
+void DkDeviceMemory::setUsage(DkMemoryUsageHint usage) {
+	if (m_initialized) {
+		std::cout << "Cannot alter memory usage after initialization." << std::endl;
+		return;
+	}
+	m_usage = usage;
+}
+
+void DkDeviceMemory::setPooled(bool pooled) {
+	if (m_initialized) {
+		std::cout << "Cannot alter pooling after initialization." << std::endl;
+		return;
+	}
+	m_pooled = pooled;
+}
+
 bool DkDeviceMemory::init() {
 	bool bindHere = true;
 	if (m_img != nullptr) {
@@ -67,106 +112,352 @@ bool DkDeviceMemory::init() {
 		bindHere = false;
 	}
 
+	// A heap without room left is skipped in favour of the next best type
 	VkPhysicalDeviceMemoryProperties devMemProps = m_device.getPhysDevice().getMemProps();
-	uint i;
-	for (i = 0; i < devMemProps.memoryTypeCount; ++i) {
-		if ((m_reqs.memoryTypeBits & (1 << i)) && 
-			(devMemProps.memoryTypes[i].propertyFlags & m_memProps) == m_memProps) {
-			break;
-		}
+	DkMemoryTracker& tracker = m_device.getMemoryTracker();
+	std::vector<VkDeviceSize> heapUsage(tracker.getHeapCount());
+	for (uint heap = 0; heap < tracker.getHeapCount(); ++heap) {
+		heapUsage[heap] = tracker.getHeapUsage(heap).blocks.bytes;
 	}
-	if (i == devMemProps.memoryTypeCount) {
+	int selected = m_device.getMemoryTypeSelector().select(m_reqs.memoryTypeBits,
+		{ m_memProps, m_preferredFlags, m_avoidedFlags, m_usage }, m_reqs.size, heapUsage);
+	if (selected < 0) {
 		std::cout << "Failed to identify a memory type with the requested properties." << std::endl;
 		return false;
 	}
+	uint i = (uint)selected;
 
-	VkMemoryAllocateInfo memInfo = {
-		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		nullptr,
-		m_reqs.size,
-		i
-	};
+	m_typeFlags = devMemProps.memoryTypes[i].propertyFlags;
+	m_memoryType = i;
 
-	if (vkAllocateMemory(m_device.get(), &memInfo, nullptr, &m_devMemory) != VK_SUCCESS) {
-		std::cout << "Failed to allocate memory." << std::endl;
-		return false;
+	if (bindHere && m_pooled) {
+		bool linear = m_img == nullptr || m_img->getTiling() == VK_IMAGE_TILING_LINEAR;
+		if (!m_device.getMemoryPool().allocate(m_reqs, i, linear, m_alloc)) return false;
+		m_devMemory = m_alloc.memory;
+		m_offset = m_alloc.offset;
+	}
+	else {
+		VkMemoryAllocateInfo memInfo = {
+			VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			nullptr,
+			m_reqs.size,
+			i
+		};
+
+		if (vkAllocateMemory(m_device.get(), &memInfo, nullptr, &m_devMemory) != VK_SUCCESS) {
+			std::cout << "Failed to allocate memory." << std::endl;
+			return false;
+		}
+		m_device.getMemoryTracker().recordBlockAllocation(i, m_reqs.size);
+		m_device.getMemoryTracker().recordAllocation(i, m_reqs.size);
 	}
 
 	if (bindHere) {
 		bool res = true;
 		if (m_img != nullptr) {
-			res = bind(m_img, m_reqs.size);
+			res = bind(m_img, m_reqs);
 		}
 		else {
-			res = bind(m_bfr, m_reqs.size);
+			res = bind(m_bfr, m_reqs);
 		}
 		if (!res) return false;
 	}
+	else {
+		if (!m_heap.init(m_reqs.size)) return false;
+		m_shared = true;
+		m_granularity = std::max(m_device.getPhysDevice().getProperties().limits.bufferImageGranularity, (VkDeviceSize)1);
+	}
 
 	m_initialized = true;
 	return true;
 }
 
-bool DkDeviceMemory::bind(DkImage* img, VkDeviceSize size) {
-	if (vkBindImageMemory(m_device.get(), img->get(), m_devMemory, m_offset) != VK_SUCCESS) {
+bool DkDeviceMemory::_place(const VkMemoryRequirements& reqs, bool optimal, VkDeviceSize& offset, VkDeviceSize& size, uint& handle) {
+	if (m_devMemory == VK_NULL_HANDLE) {
+		std::cout << "Cannot bind to memory before initialization." << std::endl;
+		return false;
+	}
+	if (!m_shared) {
+		offset = m_offset;
+		size = reqs.size;
+		handle = DkTlsfAllocator::INVALID_HANDLE;
+		return true;
+	}
+	if ((reqs.memoryTypeBits & (1u << m_memoryType)) == 0) {
+		std::cout << "Resource cannot be bound to this memory type." << std::endl;
+		return false;
+	}
+
+	// Optimal images own whole granularity pages, so linear resources never
+	//	share a page with them
+	VkDeviceSize alignment = std::max(reqs.alignment, (VkDeviceSize)1);
+	size = reqs.size;
+	if (optimal && m_granularity > 1) {
+		alignment = std::max(alignment, m_granularity);
+		size = (size + m_granularity - 1) & ~(m_granularity - 1);
+	}
+	handle = m_heap.allocate(size, alignment, offset);
+	if (handle == DkTlsfAllocator::INVALID_HANDLE) {
+		std::cout << "Not enough free space in memory to bind resource." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool DkDeviceMemory::bind(DkImage* img, const VkMemoryRequirements& reqs) {
+	VkDeviceSize start, size;
+	uint handle;
+	if (!_place(reqs, img->getTiling() != VK_IMAGE_TILING_LINEAR, start, size, handle)) return false;
+	if (vkBindImageMemory(m_device.get(), img->get(), m_devMemory, start) != VK_SUCCESS) {
 		std::cout << "Failed to bind image memory." << std::endl;
+		if (handle != DkTlsfAllocator::INVALID_HANDLE) m_heap.free(handle);
 		return false;
 	}
-	VkDeviceSize start = m_offset;
-	m_offset += size;
-	m_bindings.emplace_back();
 	DkMemoryResource r;
 	r.img = img;
-	m_bindings.back() = {
+	m_bindings[img] = {
 		start,
 		size,
 		DK_IMAGE_RESOURCE,
-		r
+		r,
+		handle
 	};
 	return true;
 }
 
-bool DkDeviceMemory::bind(DkBuffer* bfr, VkDeviceSize size) {
-	if (vkBindBufferMemory(m_device.get(), bfr->get(), m_devMemory, m_offset) != VK_SUCCESS) {
+bool DkDeviceMemory::bind(DkBuffer* bfr, const VkMemoryRequirements& reqs) {
+	VkDeviceSize start, size;
+	uint handle;
+	if (!_place(reqs, false, start, size, handle)) return false;
+	if (vkBindBufferMemory(m_device.get(), bfr->get(), m_devMemory, start) != VK_SUCCESS) {
 		std::cout << "Failed to bind buffer memory." << std::endl;
+		if (handle != DkTlsfAllocator::INVALID_HANDLE) m_heap.free(handle);
 		return false;
 	}
-	VkDeviceSize start = m_offset;
-	m_offset += size;
-	m_bindings.emplace_back();
 	DkMemoryResource r;
 	r.bfr = bfr;
-	m_bindings.back() = {
+	m_bindings[bfr] = {
 		start,
 		size,
 		DK_BUFFER_RESOURCE,
-		r
+		r,
+		handle
 	};
 	return true;
 }
 
+void DkDeviceMemory::unbind(DkImage* img) {
+	_unbind(img);
+}
+
+void DkDeviceMemory::unbind(DkBuffer* bfr) {
+	_unbind(bfr);
+}
+
+void DkDeviceMemory::_unbind(const void* resource) {
+	auto me = m_bindings.find(resource);
+	if (me == m_bindings.end()) return;
+	if (me->second.handle != DkTlsfAllocator::INVALID_HANDLE) {
+		m_heap.free(me->second.handle);
+	}
+	m_bindings.erase(me);
+}
+
 void DkDeviceMemory::finalize() {
 	m_bindings.clear();
 	m_offset = 0;
+	m_heap.finalize();
+	m_shared = false;
 	m_bfr = nullptr;
 	m_img = nullptr;
-	m_reqs = {};
-	if (m_devMemory != VK_NULL_HANDLE) {
+	if (m_alloc.memory != VK_NULL_HANDLE) {
+		m_device.getMemoryPool().free(m_alloc);
+		m_devMemory = VK_NULL_HANDLE;
+	}
+	else if (m_devMemory != VK_NULL_HANDLE) {
+		unmap();
 		vkFreeMemory(m_device.get(), m_devMemory, nullptr);
+		m_device.getMemoryTracker().recordFree(m_memoryType, m_reqs.size);
+		m_device.getMemoryTracker().recordBlockFree(m_memoryType, m_reqs.size);
 		m_devMemory = VK_NULL_HANDLE;
 	}
+	m_reqs = {};
+	m_typeFlags = 0;
+	m_initialized = false;
+}
+
+bool DkDeviceMemory::map(void*& ptr) {
+	if (m_devMemory == VK_NULL_HANDLE) {
+		std::cout << "Cannot map memory before initialization." << std::endl;
+		return false;
+	}
+	if (isPooled()) {
+		ptr = m_alloc.mapped != nullptr ? (char*)m_alloc.mapped - m_alloc.offset : nullptr;
+	}
+	else {
+		if (m_mapped == nullptr && vkMapMemory(m_device.get(), m_devMemory, 0, VK_WHOLE_SIZE, 0, &m_mapped) != VK_SUCCESS) {
+			m_mapped = nullptr;
+		}
+		ptr = m_mapped;
+	}
+	if (ptr == nullptr) {
+		std::cout << "Failed to map memory range." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void DkDeviceMemory::unmap() {
+	if (!isPooled() && m_mapped != nullptr) {
+		vkUnmapMemory(m_device.get(), m_devMemory);
+		m_mapped = nullptr;
+	}
+}
+
+bool DkDeviceMemory::flush(VkDeviceSize offset, VkDeviceSize size) {
+	if (m_typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) return true;
+	if (isPooled()) {
+		if (size == VK_WHOLE_SIZE) size = m_alloc.offset + m_alloc.size - offset;
+		return m_device.getMemoryPool().flush(m_alloc, offset - m_alloc.offset, size);
+	}
+
+	VkDeviceSize atom = std::max(m_device.getPhysDevice().getProperties().limits.nonCoherentAtomSize, (VkDeviceSize)1);
+	VkDeviceSize start = offset & ~(atom - 1);
+	VkDeviceSize rangeSize = VK_WHOLE_SIZE;
+	if (size != VK_WHOLE_SIZE) {
+		VkDeviceSize end = (offset + size + atom - 1) & ~(atom - 1);
+		if (end < m_reqs.size) rangeSize = end - start;
+	}
+	VkMappedMemoryRange range = {
+		VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+		nullptr,
+		m_devMemory,
+		start,
+		rangeSize
+	};
+	if (vkFlushMappedMemoryRanges(m_device.get(), 1, &range) != VK_SUCCESS) {
+		std::cout << "Failed to flush memory." << std::endl;
+		return false;
+	}
+	return true;
 }
 
 bool DkDeviceMemory::getMyOffsetAndSize(const void* resource, DkResourceType type, VkDeviceSize& offset, VkDeviceSize& size) {
-	auto& me = std::find_if(m_bindings.begin(), m_bindings.end(), [resource, type](const DkBindLog& item) {
-		if (item.type != type) return false;
-		return (type == DK_BUFFER_RESOURCE ? (resource == item.resource.bfr) : (resource == item.resource.img));
-	});
-	if (me != m_bindings.end()) {
-		offset = me->start;
-		size = me->size;
+	auto me = m_bindings.find(resource);
+	if (me != m_bindings.end() && me->second.type == type) {
+		offset = me->second.start;
+		size = me->second.size;
 		return true;
 	}
 	std::cout << "Couldn't find resource in memory bindings." << std::endl;
 	return false;
+}
+
+bool DkDeviceMemory::defragment(DkCommandBuffer* bfr, DkQueue& queue, uint& movedCount) {
+	movedCount = 0;
+	if (!m_shared) {
+		std::cout << "Only shared memory can be defragmented." << std::endl;
+		return false;
+	}
+	// The copies are submitted and waited on here, and a failed pass destroys
+	//	the buffers it created; neither works with commands the caller still
+	//	has to end and submit
+	if (bfr->isRecording()) {
+		std::cout << "Cannot defragment into a command buffer that is already recording." << std::endl;
+		return false;
+	}
+
+	// Movable buffers, lowest first so they claim the lowest holes. Mapped
+	//	buffers stay put; their pointers are held by callers such as
+	//	DkLinearAllocator
+	const VkBufferUsageFlags transfer = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	std::vector<DkBindLog*> candidates;
+	for (auto& item : m_bindings) {
+		if (item.second.type == DK_BUFFER_RESOURCE && (item.second.resource.bfr->m_usage & transfer) == transfer &&
+			item.second.resource.bfr->m_mapped == nullptr) {
+			candidates.push_back(&item.second);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const DkBindLog* a, const DkBindLog* b) {
+		return a->start < b->start;
+	});
+
+	if (!m_device.waitIdle()) return false;
+
+	struct move {
+		DkBindLog* log;
+		VkBuffer buffer;
+		VkDeviceSize start;
+		VkDeviceSize size;
+		uint handle;
+	};
+	std::vector<move> moves;
+	auto release = [this](move& m) {
+		vkDestroyBuffer(m_device.get(), m.buffer, nullptr);
+		if (m.handle != DkTlsfAllocator::INVALID_HANDLE) m_heap.free(m.handle);
+	};
+	for (auto log : candidates) {
+		move m = { log, VK_NULL_HANDLE, 0, 0, DkTlsfAllocator::INVALID_HANDLE };
+		if (!log->resource.bfr->_createBuffer(m.buffer)) break;
+		VkMemoryRequirements reqs;
+		vkGetBufferMemoryRequirements(m_device.get(), m.buffer, &reqs);
+		m.size = reqs.size;
+		m.handle = m_heap.allocateBelow(m.size, std::max(reqs.alignment, (VkDeviceSize)1), log->start, m.start);
+		if (m.handle == DkTlsfAllocator::INVALID_HANDLE ||
+			vkBindBufferMemory(m_device.get(), m.buffer, m_devMemory, m.start) != VK_SUCCESS) {
+			release(m);
+			continue;
+		}
+		moves.push_back(m);
+	}
+	if (moves.empty()) return true;
+
+	bool res = bfr->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	res = res && bfr->setMemoryBarrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, {
+		{ VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT }
+	}, {}, {});
+	res = res && bfr->flushBarriers();
+	if (res) {
+		for (auto& m : moves) {
+			VkBufferCopy copy = {
+				0,
+				0,
+				m.log->resource.bfr->m_size
+			};
+			vkCmdCopyBuffer(bfr->get(), m.log->resource.bfr->get(), m.buffer, 1, &copy);
+		}
+	}
+	res = res && bfr->setMemoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, {
+		{ VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT }
+	}, {}, {});
+	// Close the recording even if it failed part way, so the command buffer
+	//	is not left recording commands on the buffers released below
+	if (bfr->isRecording()) res = bfr->endRecording() && res;
+
+	DkFence fence(m_device);
+	res = res && fence.init(false) && bfr->submit(queue, {}, {}, fence) && fence.wait();
+	if (!res) {
+		for (auto& m : moves) {
+			release(m);
+		}
+		return false;
+	}
+
+	// Swap the buffers over to their new handles and ranges. The fence wait
+	//	after the full barriers completed every earlier use, so their tracked
+	//	states start over
+	for (auto& m : moves) {
+		DkBuffer* moved = m.log->resource.bfr;
+		DkResourceStateTracker::settle(moved->getState());
+		vkDestroyBuffer(m_device.get(), moved->m_buffer, nullptr);
+		m_heap.free(m.log->handle);
+		moved->m_buffer = m.buffer;
+		moved->m_queriedOffset = m.start;
+		moved->m_queriedSize = m.size;
+		m.log->start = m.start;
+		m.log->size = m.size;
+		m.log->handle = m.handle;
+	}
+	movedCount = (uint)moves.size();
+	return true;
 }
\ No newline at end of file
@@ -41,6 +41,10 @@ bool DkFence::wait(uint timeout) {
 	}
 }
 
+bool DkFence::isSignaled() {
+	return vkGetFenceStatus(m_device.get(), m_fence) == VK_SUCCESS;
+}
+
 bool DkFence::reset() {
 	if (vkResetFences(m_device.get(), 1, &m_fence) != VK_SUCCESS) {
 		std::cout << "Failed to reset fence." << std::endl;
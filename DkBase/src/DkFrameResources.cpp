@@ -13,15 +13,25 @@ DkFrameResources::DkFrameResources(
 	m_device(device),
 	m_swapchain(swapchain),
 	m_useDepth(useDepth),
+	m_transientSize(DEFAULT_TRANSIENT_BUFFER_SIZE),
 	m_imgAcqSemaphore(device),
 	m_rdyPrsSemaphore(device),
 	m_drawDoneFence(device),
 	m_depthAttachment(m_device, nullptr),
+	m_transientAllocator(device),
 	m_cmdBfr(nullptr),
 	m_framebfr(device, swapchain, renderPass, &m_imgAcqSemaphore, useDepth ? &m_depthAttachment : nullptr),
 	m_initialized(false)
 {}
 
+void DkFrameResources::setTransientBufferSize(VkDeviceSize size) {
+	if (m_initialized) {
+		std::cout << "Cannot alter transient buffer size after initialization." << std::endl;
+		return;
+	}
+	m_transientSize = size;
+}
+
 bool DkFrameResources::init() {
 	if (m_useDepth) {
 		if (!_initDepthAttachment()) return false;
@@ -29,6 +39,10 @@ bool DkFrameResources::init() {
 	if (!m_imgAcqSemaphore.init()) return false;
 	if (!m_rdyPrsSemaphore.init()) return false;
 	if (!m_drawDoneFence.init(true)) return false; // expected usage is to wait for signal at start of loop, so start signaled for beginning
+	if (m_transientSize > 0) {
+		m_transientAllocator.setSize(m_transientSize);
+		if (!m_transientAllocator.init()) return false;
+	}
 
 	m_initialized = true;
 	return true;
@@ -47,6 +61,7 @@ void DkFrameResources::finalize() {
 	m_imgAcqSemaphore.finalize();
 	m_rdyPrsSemaphore.finalize();
 	m_drawDoneFence.finalize();
+	m_transientAllocator.finalize();
 	m_framebfr.finalize();
 	m_depthAttachment.finalize();
 	m_initialized = false;
@@ -59,6 +74,7 @@ bool DkFrameResources::_waitDrawDone() {
 bool DkFrameResources::reset() {
 	if (!_waitDrawDone()) return false;
 	if (!m_drawDoneFence.reset()) return false;
+	m_transientAllocator.reset();
 	if (!m_framebfr.reset()) return false;
 	return true;
 }
@@ -0,0 +1,162 @@
+#include "DkGeometryArena.h"
+#include "DkDevice.h"
+#include "DkDeviceMemory.h"
+#include "DkBuffer.h"
+#include "DkUploadManager.h"
+
+DkGeometryArena::DkGeometryArena(DkDevice& device) :
+	m_device(device),
+	m_vertFormat(DK_VERTEX_FORMAT_FULL),
+	m_vertCapacity(DEFAULT_ARENA_VERTEX_CAPACITY),
+	m_indexCapacity(0),
+	m_indexType(VK_INDEX_TYPE_UINT32),
+	m_vertBuffer(nullptr),
+	m_indexBuffer(nullptr),
+	m_initialized(false),
+	m_vertHeap(),
+	m_indexHeap()
+{}
+
+void DkGeometryArena::setVertexFormat(DkVertexFormat format) {
+	if (m_initialized) {
+		std::cout << "Cannot alter arena vertex format after initialization." << std::endl;
+		return;
+	}
+	m_vertFormat = format;
+}
+
+void DkGeometryArena::setVertexCapacity(uint vertices) {
+	if (m_initialized) {
+		std::cout << "Cannot alter arena vertex capacity after initialization." << std::endl;
+		return;
+	}
+	m_vertCapacity = vertices;
+}
+
+void DkGeometryArena::setIndexCapacity(uint indices) {
+	if (m_initialized) {
+		std::cout << "Cannot alter arena index capacity after initialization." << std::endl;
+		return;
+	}
+	m_indexCapacity = indices;
+}
+
+void DkGeometryArena::setIndexType(VkIndexType type) {
+	if (m_initialized) {
+		std::cout << "Cannot alter arena index type after initialization." << std::endl;
+		return;
+	}
+	m_indexType = type;
+}
+
+bool DkGeometryArena::init() {
+	if (m_initialized) {
+		finalize();
+	}
+
+	if (m_vertCapacity == 0) {
+		std::cout << "Cannot create a geometry arena without vertex capacity." << std::endl;
+		return false;
+	}
+
+	m_vertBuffer = new DkBuffer(m_device, nullptr);
+	m_vertBuffer->getMemory()->setUsage(DK_MEMORY_USAGE_GPU_ONLY);
+	m_vertBuffer->setSize((VkDeviceSize)getVertexStride() * m_vertCapacity);
+	m_vertBuffer->setUsage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	if (!m_vertBuffer->init()) return false;
+	if (!m_vertHeap.init(m_vertCapacity)) return false;
+
+	if (m_indexCapacity > 0) {
+		m_indexBuffer = new DkBuffer(m_device, nullptr);
+		m_indexBuffer->getMemory()->setUsage(DK_MEMORY_USAGE_GPU_ONLY);
+		m_indexBuffer->setSize((VkDeviceSize)getIndexStride() * m_indexCapacity);
+		m_indexBuffer->setUsage(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		if (!m_indexBuffer->init()) return false;
+		if (!m_indexHeap.init(m_indexCapacity)) return false;
+	}
+
+	m_initialized = true;
+	return true;
+}
+
+void DkGeometryArena::finalize() {
+	if (!m_vertHeap.isEmpty() || !m_indexHeap.isEmpty()) {
+		std::cout << "Geometry arena finalized with " << m_vertHeap.getStats().allocationCount << " meshes still allocated." << std::endl;
+	}
+	m_vertHeap.finalize();
+	m_indexHeap.finalize();
+	if (m_indexBuffer != nullptr) {
+		delete m_indexBuffer;
+		m_indexBuffer = nullptr;
+	}
+	if (m_vertBuffer != nullptr) {
+		delete m_vertBuffer;
+		m_vertBuffer = nullptr;
+	}
+	m_initialized = false;
+}
+
+bool DkGeometryArena::allocate(uint vertexCount, uint indexCount, DkGeometryRange& range) {
+	if (!m_initialized) {
+		std::cout << "Cannot allocate from an uninitialized geometry arena." << std::endl;
+		return false;
+	}
+	if (vertexCount == 0) {
+		std::cout << "Cannot allocate an empty arena range." << std::endl;
+		return false;
+	}
+	if (indexCount > 0 && m_indexBuffer == nullptr) {
+		std::cout << "Cannot allocate indices. Geometry arena has no index buffer." << std::endl;
+		return false;
+	}
+
+	VkDeviceSize firstVertex = 0, firstIndex = 0;
+	uint vertexHandle = m_vertHeap.allocate(vertexCount, 1, firstVertex);
+	if (vertexHandle == DkTlsfAllocator::INVALID_HANDLE) {
+		std::cout << "Geometry arena out of vertex space." << std::endl;
+		return false;
+	}
+
+	uint indexHandle = DkTlsfAllocator::INVALID_HANDLE;
+	if (indexCount > 0) {
+		indexHandle = m_indexHeap.allocate(indexCount, 1, firstIndex);
+		if (indexHandle == DkTlsfAllocator::INVALID_HANDLE) {
+			std::cout << "Geometry arena out of index space." << std::endl;
+			m_vertHeap.free(vertexHandle);
+			return false;
+		}
+	}
+
+	range = { (uint)firstVertex, vertexCount, (uint)firstIndex, indexCount, vertexHandle, indexHandle };
+	return true;
+}
+
+void DkGeometryArena::free(DkGeometryRange& range) {
+	if (range.vertexHandle != DkTlsfAllocator::INVALID_HANDLE) {
+		m_vertHeap.free(range.vertexHandle);
+	}
+	if (range.indexHandle != DkTlsfAllocator::INVALID_HANDLE) {
+		m_indexHeap.free(range.indexHandle);
+	}
+	range = { 0, 0, 0, 0, DkTlsfAllocator::INVALID_HANDLE, DkTlsfAllocator::INVALID_HANDLE };
+}
+
+bool DkGeometryArena::uploadVertices(DkUploadManager& uploader, const DkGeometryRange& range, const void* data) {
+	if (range.vertexHandle == DkTlsfAllocator::INVALID_HANDLE) {
+		std::cout << "Cannot upload vertices to an unallocated arena range." << std::endl;
+		return false;
+	}
+	VkDeviceSize stride = getVertexStride();
+	return uploader.uploadBuffer(*m_vertBuffer, data, stride * range.vertexCount, stride * range.firstVertex,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+}
+
+bool DkGeometryArena::uploadIndices(DkUploadManager& uploader, const DkGeometryRange& range, const void* data) {
+	if (range.indexHandle == DkTlsfAllocator::INVALID_HANDLE) {
+		std::cout << "Cannot upload indices to an unallocated arena range." << std::endl;
+		return false;
+	}
+	VkDeviceSize stride = getIndexStride();
+	return uploader.uploadBuffer(*m_indexBuffer, data, stride * range.indexCount, stride * range.firstIndex,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
+}
\ No newline at end of file
@@ -18,7 +18,10 @@ DkImage::DkImage(DkDevice& device, VkExtent3D extent, DkDeviceMemory* memory) :
 	m_sharing(VK_SHARING_MODE_EXCLUSIVE),
 	m_qFamIndices(),
 	m_image(VK_NULL_HANDLE),
-	m_initialized(false)
+	m_initialized(false),
+	m_queriedSize(0),
+	m_queriedOffset(0),
+	m_states()
 {
 	if (!m_extMemory) {
 		m_memory = new DkDeviceMemory(m_device);
@@ -135,11 +138,13 @@ bool DkImage::init() {
 	else {
 		VkMemoryRequirements reqs;
 		vkGetImageMemoryRequirements(m_device.get(), m_image, &reqs);
-		if (!m_memory->bind(this, reqs.size)) return false;
+		if (!m_memory->bind(this, reqs)) return false;
 	}
 
 	if (!m_memory->getMyOffsetAndSize(this, DK_IMAGE_RESOURCE, m_queriedOffset, m_queriedSize)) return false;
 
+	// Images are created in the UNDEFINED layout
+	m_states.assign(m_mipLevels * m_arrLayers, DkResourceStateTracker::initialState());
 	m_initialized = true;
 	return true;
 }
@@ -152,11 +157,32 @@ void DkImage::finalize() {
 			m_memory = nullptr;
 		}
 	}
+	else if (m_image != VK_NULL_HANDLE) {
+		m_memory->unbind(this);
+	}
 
 	if (m_image != VK_NULL_HANDLE) {
 		vkDestroyImage(m_device.get(), m_image, nullptr);
 		m_image = VK_NULL_HANDLE;
 	}
 
+	m_states.clear();
 	m_initialized = false;
+}
+
+VkImageAspectFlags DkImage::getAspect() {
+	switch (m_format) {
+	case VK_FORMAT_D16_UNORM:
+	case VK_FORMAT_X8_D24_UNORM_PACK32:
+	case VK_FORMAT_D32_SFLOAT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT;
+	case VK_FORMAT_D16_UNORM_S8_UINT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	case VK_FORMAT_S8_UINT:
+		return VK_IMAGE_ASPECT_STENCIL_BIT;
+	default:
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "DkInstance.h"
+#include <cstring>
 #include "DkUtils.h"
 
 DkInstance::DkInstance() :
 	m_appName("MyVulkanApplication"),
 	m_desiredInstExts({ VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_EXTENSION_NAME }),
+	m_optionalInstExts({ VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME }),
+	m_enabledInstExts(),
 	m_initialized(false),
 	m_instance(VK_NULL_HANDLE)
 {}
@@ -38,6 +41,15 @@ bool DkInstance::init() {
 	for (auto& ext : m_desiredInstExts) {
 		if (!IsExtensionSupported(available, ext)) return false;
 	}
+	m_enabledInstExts = m_desiredInstExts;
+	for (auto& ext : m_optionalInstExts) {
+		for (auto& avail : available) {
+			if (strcmp(avail.extensionName, ext) == 0) {
+				m_enabledInstExts.push_back(ext);
+				break;
+			}
+		}
+	}
 
 	// Create instance
 	VkApplicationInfo appInfo = {
@@ -57,8 +69,8 @@ bool DkInstance::init() {
 		&appInfo,
 		0,
 		nullptr,
-		(uint)m_desiredInstExts.size(),
-		m_desiredInstExts.data()
+		(uint)m_enabledInstExts.size(),
+		m_enabledInstExts.data()
 	};
 
 	VkResult result = vkCreateInstance(&instInfo, nullptr, &m_instance);
@@ -68,7 +80,7 @@ bool DkInstance::init() {
 	}
 
 	// Load instance level functions
-	if (!loadInstanceFns(m_instance, m_desiredInstExts)) return false;
+	if (!loadInstanceFns(m_instance, m_enabledInstExts)) return false;
 
 	m_initialized = true;
 	return true;
@@ -80,4 +92,11 @@ void DkInstance::finalize() {
 		m_instance = VK_NULL_HANDLE;
 	}
 	m_initialized = false;
+}
+
+bool DkInstance::isExtensionEnabled(const char* ext) {
+	for (auto& enabled : m_enabledInstExts) {
+		if (strcmp(enabled, ext) == 0) return true;
+	}
+	return false;
 }
\ No newline at end of file
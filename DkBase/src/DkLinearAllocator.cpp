@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cstring>
+
+#include "DkLinearAllocator.h"
+#include "DkDevice.h"
+#include "DkDeviceMemory.h"
+#include "DkBuffer.h"
+
+DkLinearAllocator::DkLinearAllocator(DkDevice& device) :
+	m_device(device),
+	m_size(DEFAULT_TRANSIENT_BUFFER_SIZE),
+	m_usage(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+	m_buffer(nullptr),
+	m_mapped(nullptr),
+	m_uniformAlignment(1),
+	m_initialized(false),
+	m_head(0),
+	m_flushed(0)
+{}
+
+void DkLinearAllocator::setSize(VkDeviceSize size) {
+	if (m_initialized) {
+		std::cout << "Cannot alter transient buffer size after initialization." << std::endl;
+		return;
+	}
+	m_size = size;
+}
+
+void DkLinearAllocator::setUsage(VkBufferUsageFlags usage) {
+	if (m_initialized) {
+		std::cout << "Cannot alter transient buffer usage after initialization." << std::endl;
+		return;
+	}
+	m_usage = usage;
+}
+
+bool DkLinearAllocator::init() {
+	if (m_initialized) {
+		finalize();
+	}
+
+	m_buffer = new DkBuffer(m_device, nullptr);
+	m_buffer->getMemory()->setPropFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	m_buffer->getMemory()->setUsage(DK_MEMORY_USAGE_DYNAMIC);
+	m_buffer->setSize(m_size);
+	m_buffer->setUsage(m_usage);
+	if (!m_buffer->init()) return false;
+	m_mapped = (char*)m_buffer->getMappedData();
+	if (m_mapped == nullptr) {
+		std::cout << "Failed to map transient buffer." << std::endl;
+		return false;
+	}
+
+	// At least 16 so matrices can be written with aligned SIMD stores
+	m_uniformAlignment = std::max(m_device.getPhysDevice().getProperties().limits.minUniformBufferOffsetAlignment, (VkDeviceSize)16);
+	m_head = 0;
+	m_flushed = 0;
+	m_initialized = true;
+	return true;
+}
+
+void DkLinearAllocator::finalize() {
+	if (m_buffer != nullptr) {
+		delete m_buffer;
+		m_buffer = nullptr;
+	}
+	m_mapped = nullptr;
+	m_head = 0;
+	m_flushed = 0;
+	m_initialized = false;
+}
+
+bool DkLinearAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, DkTransientAllocation& alloc) {
+	if (!m_initialized) {
+		std::cout << "Cannot allocate from an uninitialized transient buffer." << std::endl;
+		return false;
+	}
+	alignment = std::max(alignment, (VkDeviceSize)1);
+	if ((alignment & (alignment - 1)) != 0) {
+		std::cout << "Transient allocation alignment must be a power of two." << std::endl;
+		return false;
+	}
+
+	VkDeviceSize offset = (m_head + alignment - 1) & ~(alignment - 1);
+	if (offset + size > m_size) {
+		std::cout << "Transient buffer exhausted." << std::endl;
+		return false;
+	}
+	m_head = offset + size;
+	alloc = { m_buffer, offset, m_mapped + offset };
+	return true;
+}
+
+bool DkLinearAllocator::allocateUniform(VkDeviceSize size, DkTransientAllocation& alloc) {
+	return allocate(size, m_uniformAlignment, alloc);
+}
+
+bool DkLinearAllocator::push(const void* data, VkDeviceSize size, VkDeviceSize alignment, DkTransientAllocation& alloc) {
+	if (!allocate(size, alignment, alloc)) return false;
+	std::memcpy(alloc.data, data, size);
+	return true;
+}
+
+bool DkLinearAllocator::flush() {
+	// Only what was written since the last flush
+	if (m_head > m_flushed) {
+		if (!m_buffer->flush(m_flushed, m_head - m_flushed)) return false;
+		m_flushed = m_head;
+	}
+	return true;
+}
+
+void DkLinearAllocator::reset() {
+	m_head = 0;
+	m_flushed = 0;
+}
\ No newline at end of file
@@ -1,12 +1,8 @@
+#include <cstring>
+
 #include "DkMath.h"
 
 namespace math {
-	vec<3> cross(const vec<3>& v1, const vec<3>& v2) {
-		return vec<3>({ v1[1] * v2[2] - v1[2] * v2[1],
-						v1[2] * v2[0] - v1[0] * v2[2],
-						v1[0] * v2[1] - v1[1] * v2[0] });
-	}
-
 	float determinant(const mat<3, 3>& m) {
 		return	m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) -
 				m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0)) +
@@ -28,65 +24,152 @@ namespace math {
 		return ret / det;
 	}
 
-	mat<3, 3> rotation(float angle, const vec<3>& axis) {
-		vec3 normAx = normalize(axis);
-		float x = normAx[0];
-		float y = normAx[1];
-		float z = normAx[2];
-		mat3 id = ident<3>();
+	static bool isAffine(const mat<4, 4>& m) {
+		return m(3, 0) == 0.f && m(3, 1) == 0.f && m(3, 2) == 0.f && m(3, 3) == 1.f;
+	}
 
-		mat3 aTa = {
-			x * x,  x * y,  x * z,
-			y * x,  y * y,  y * z,
-			z * x,  z * y,  z * z
-		};
+	// Writes the inverse of m to out and returns the determinant. out is left
+	//	untouched when the determinant is zero.
+	static float invert4x4(const mat<4, 4>& m, mat<4, 4>& out) {
+		if (isAffine(m)) {
+			mat3 lin(
+				m(0, 0), m(0, 1), m(0, 2),
+				m(1, 0), m(1, 1), m(1, 2),
+				m(2, 0), m(2, 1), m(2, 2)
+			);
+			float det = determinant(lin);
+			if (det != 0.f) {
+				out = toMat4(inverse(affine3x4(m)));
+			}
+			return det;
+		}
+#ifdef DK_MATH_SSE
+		return simd::inverse4x4(m.data(), out.data());
+#else
+		// 2x2 minors of the top two rows (s) and the bottom two rows (c)
+		const float* a = m.data();
+		float s0 = a[0] * a[5] - a[4] * a[1];
+		float s1 = a[0] * a[6] - a[4] * a[2];
+		float s2 = a[0] * a[7] - a[4] * a[3];
+		float s3 = a[1] * a[6] - a[5] * a[2];
+		float s4 = a[1] * a[7] - a[5] * a[3];
+		float s5 = a[2] * a[7] - a[6] * a[3];
+		float c5 = a[10] * a[15] - a[14] * a[11];
+		float c4 = a[9] * a[15] - a[13] * a[11];
+		float c3 = a[9] * a[14] - a[13] * a[10];
+		float c2 = a[8] * a[15] - a[12] * a[11];
+		float c1 = a[8] * a[14] - a[12] * a[10];
+		float c0 = a[8] * a[13] - a[12] * a[9];
+		float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if (det == 0.f) {
+			return det;
+		}
+		float inv = 1.f / det;
+		out = mat4(
+			( a[5] * c5 - a[6] * c4 + a[7] * c3) * inv,
+			(-a[1] * c5 + a[2] * c4 - a[3] * c3) * inv,
+			( a[13] * s5 - a[14] * s4 + a[15] * s3) * inv,
+			(-a[9] * s5 + a[10] * s4 - a[11] * s3) * inv,
 
-		mat3 aDual = {
-			 0, -z,  y,
-			 z,  0, -x,
-			-y,  x,  0
-		};
+			(-a[4] * c5 + a[6] * c2 - a[7] * c1) * inv,
+			( a[0] * c5 - a[2] * c2 + a[3] * c1) * inv,
+			(-a[12] * s5 + a[14] * s2 - a[15] * s1) * inv,
+			( a[8] * s5 - a[10] * s2 + a[11] * s1) * inv,
 
-		aDual = aDual;
+			( a[4] * c4 - a[5] * c2 + a[7] * c0) * inv,
+			(-a[0] * c4 + a[1] * c2 - a[3] * c0) * inv,
+			( a[12] * s4 - a[13] * s2 + a[15] * s0) * inv,
+			(-a[8] * s4 + a[9] * s2 - a[11] * s0) * inv,
 
-		float radAngle = angle * PI / 180.f;
-
-		mat3 rotation = id * cos(radAngle) + aTa * (1 - cos(radAngle)) + aDual * sin(radAngle);
+			(-a[4] * c3 + a[5] * c1 - a[6] * c0) * inv,
+			( a[0] * c3 - a[1] * c1 + a[2] * c0) * inv,
+			(-a[12] * s3 + a[13] * s1 - a[14] * s0) * inv,
+			( a[8] * s3 - a[9] * s1 + a[10] * s0) * inv
+		);
+		return det;
+#endif
+	}
 
-		return rotation;
+	float determinant(const mat<4, 4>& m) {
+		if (isAffine(m)) {
+			return determinant(mat3(m));
+		}
+		const float* a = m.data();
+		float s0 = a[0] * a[5] - a[4] * a[1];
+		float s1 = a[0] * a[6] - a[4] * a[2];
+		float s2 = a[0] * a[7] - a[4] * a[3];
+		float s3 = a[1] * a[6] - a[5] * a[2];
+		float s4 = a[1] * a[7] - a[5] * a[3];
+		float s5 = a[2] * a[7] - a[6] * a[3];
+		float c5 = a[10] * a[15] - a[14] * a[11];
+		float c4 = a[9] * a[15] - a[13] * a[11];
+		float c3 = a[9] * a[14] - a[13] * a[10];
+		float c2 = a[8] * a[15] - a[12] * a[11];
+		float c1 = a[8] * a[14] - a[12] * a[10];
+		float c0 = a[8] * a[13] - a[12] * a[9];
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 	}
 
-	mat<4, 4> scale(float sx, float sy, float sz) {
-		return mat4(
-			 sx, 0.f, 0.f, 0.f,
-			0.f,  sy, 0.f, 0.f,
-			0.f, 0.f,  sz, 0.f,
-			0.f, 0.f, 0.f, 1.f
-		);
+	mat<4, 4> inverse(const mat<4, 4>& m) {
+		mat<4, 4> ret;
+		if (invert4x4(m, ret) == 0.f) {
+			throw std::runtime_error("Cannot invert singular matrix");
+		}
+		return ret;
 	}
 
-	mat<4, 4> translate(float tx, float ty, float tz) {
-		return mat4(
-			1.f, 0.f, 0.f,  tx,
-			0.f, 1.f, 0.f,  ty,
-			0.f, 0.f, 1.f,  tz,
-			0.f, 0.f, 0.f, 1.f
+	mat<3, 3> rotation(float angle, const vec<3>& axis) {
+		vec3 normAx = normalize(axis);
+		float x = normAx[0];
+		float y = normAx[1];
+		float z = normAx[2];
+
+		float radAngle = angle * PI / 180.f;
+		float c = cos(radAngle);
+		float s = sin(radAngle);
+		float t = 1.f - c;
+
+		// Rodrigues' formula, id * c + aTa * t + aDual * s, expanded so the
+		//	matrix is written in one pass instead of through three temporaries
+		return mat3(
+			t * x * x + c,		t * x * y - s * z,	t * x * z + s * y,
+			t * x * y + s * z,	t * y * y + c,		t * y * z - s * x,
+			t * x * z - s * y,	t * y * z + s * x,	t * z * z + c
 		);
 	}
 
 	mat<4, 4> lookAt(const vec<3>& eye, const vec<3>& center, const vec<3>& up) {
-		vec3 w = normalize(eye - center);	// normal z
-		vec3 u = normalize(cross(up, w));	// normal x
-		vec3 v = cross(w, u);				// normal y
-
-		mat4 look(
-			u[0], u[1], u[2], -dot(u, eye),
-			v[0], v[1], v[2], -dot(v, eye),
-			w[0], w[1], w[2], -dot(w, eye),
-			 0.f,  0.f,  0.f,          1.f
-		);
+		// normal z
+		float wx = eye[0] - center[0];
+		float wy = eye[1] - center[1];
+		float wz = eye[2] - center[2];
+		float wLen = sqrt(wx * wx + wy * wy + wz * wz);
+		if (wLen == 0.f) {
+			throw std::runtime_error("Cannot normalize the zero vector.");
+		}
+		wx /= wLen; wy /= wLen; wz /= wLen;
+
+		// normal x = up x w
+		float ux = up[1] * wz - up[2] * wy;
+		float uy = up[2] * wx - up[0] * wz;
+		float uz = up[0] * wy - up[1] * wx;
+		float uLen = sqrt(ux * ux + uy * uy + uz * uz);
+		if (uLen == 0.f) {
+			throw std::runtime_error("Cannot normalize the zero vector.");
+		}
+		ux /= uLen; uy /= uLen; uz /= uLen;
+
+		// normal y = w x u
+		float vx = wy * uz - wz * uy;
+		float vy = wz * ux - wx * uz;
+		float vz = wx * uy - wy * ux;
 
-		return look;
+		return mat4(
+			 ux,  uy,  uz, -(ux * eye[0] + uy * eye[1] + uz * eye[2]),
+			 vx,  vy,  vz, -(vx * eye[0] + vy * eye[1] + vz * eye[2]),
+			 wx,  wy,  wz, -(wx * eye[0] + wy * eye[1] + wz * eye[2]),
+			0.f, 0.f, 0.f, 1.f
+		);
 	}
 
 	mat<4, 4> perspective(float fovy, float aspect, float zNear, float zFar) {
@@ -101,4 +184,496 @@ namespace math {
 			       0.f, 0.f, -1.f, 0.f
 		);
 	}
+
+	// AFFINE TRANSFORMS ====================================
+
+	affine3x4 inverse(const affine3x4& a) {
+		mat3 lin(
+			a(0, 0), a(0, 1), a(0, 2),
+			a(1, 0), a(1, 1), a(1, 2),
+			a(2, 0), a(2, 1), a(2, 2)
+		);
+		mat3 linInv = inverse(lin);
+		vec3 transl(a(0, 3), a(1, 3), a(2, 3));
+		return affine3x4(linInv, -(linInv * transl));
+	}
+
+	affine3x4 inverseUniformScale(const affine3x4& a) {
+		// every row of s * R has squared length s * s
+		float scaleSq = a(0, 0) * a(0, 0) + a(0, 1) * a(0, 1) + a(0, 2) * a(0, 2);
+		if (scaleSq == 0.f) {
+			throw std::runtime_error("Cannot invert singular matrix");
+		}
+		float inv = 1.f / scaleSq;
+		mat3 linInv(
+			a(0, 0) * inv, a(1, 0) * inv, a(2, 0) * inv,
+			a(0, 1) * inv, a(1, 1) * inv, a(2, 1) * inv,
+			a(0, 2) * inv, a(1, 2) * inv, a(2, 2) * inv
+		);
+		vec3 transl(a(0, 3), a(1, 3), a(2, 3));
+		return affine3x4(linInv, -(linInv * transl));
+	}
+
+	mat<3, 3> normalMatrix(const affine3x4& a) {
+		// The inverse transpose is the cofactor matrix over the determinant, and
+		//	the cofactor rows are cross products of the rows of the linear part
+		vec3 r0(a(0, 0), a(0, 1), a(0, 2));
+		vec3 r1(a(1, 0), a(1, 1), a(1, 2));
+		vec3 r2(a(2, 0), a(2, 1), a(2, 2));
+		vec3 c0 = cross(r1, r2);
+		vec3 c1 = cross(r2, r0);
+		vec3 c2 = cross(r0, r1);
+		float det = dot(r0, c0);
+		float inv = det != 0.f ? 1.f / det : 1.f;
+		return mat3(
+			c0[0] * inv, c0[1] * inv, c0[2] * inv,
+			c1[0] * inv, c1[1] * inv, c1[2] * inv,
+			c2[0] * inv, c2[1] * inv, c2[2] * inv
+		);
+	}
+
+	void normalMatrices(const affine3x4* in, float* out, uint outStride, uint count) {
+		char* dst = reinterpret_cast<char*>(out);
+		uint iter = 0;
+#ifdef DK_MATH_SSE
+		__m128 zero = _mm_setzero_ps();
+		__m128 one = _mm_set1_ps(1.f);
+		for (; iter + 4 <= count; iter += 4) {
+			// l[r][c] holds element (r, c) of four transforms, one per lane
+			__m128 l[3][4];
+			for (uint r = 0; r < 3; ++r) {
+				l[r][0] = _mm_loadu_ps(in[iter].data() + 4 * r);
+				l[r][1] = _mm_loadu_ps(in[iter + 1].data() + 4 * r);
+				l[r][2] = _mm_loadu_ps(in[iter + 2].data() + 4 * r);
+				l[r][3] = _mm_loadu_ps(in[iter + 3].data() + 4 * r);
+				_MM_TRANSPOSE4_PS(l[r][0], l[r][1], l[r][2], l[r][3]);
+			}
+			// cofactor rows: c[i] = l[i + 1] x l[i + 2]
+			__m128 c[3][3];
+			for (uint i = 0; i < 3; ++i) {
+				const __m128* a = l[(i + 1) % 3];
+				const __m128* b = l[(i + 2) % 3];
+				c[i][0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+				c[i][1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+				c[i][2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+			}
+			__m128 det = _mm_mul_ps(l[0][0], c[0][0]);
+			det = _mm_add_ps(det, _mm_mul_ps(l[0][1], c[0][1]));
+			det = _mm_add_ps(det, _mm_mul_ps(l[0][2], c[0][2]));
+			__m128 nonSingular = _mm_cmpneq_ps(det, zero);
+			__m128 inv = _mm_or_ps(_mm_and_ps(nonSingular, _mm_div_ps(one, det)), _mm_andnot_ps(nonSingular, one));
+			for (uint j = 0; j < 3; ++j) {
+				__m128 col0 = _mm_mul_ps(c[0][j], inv);
+				__m128 col1 = _mm_mul_ps(c[1][j], inv);
+				__m128 col2 = _mm_mul_ps(c[2][j], inv);
+				__m128 col3 = zero;
+				_MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+				_mm_storeu_ps(reinterpret_cast<float*>(dst + (size_t)iter * outStride) + 4 * j, col0);
+				_mm_storeu_ps(reinterpret_cast<float*>(dst + (size_t)(iter + 1) * outStride) + 4 * j, col1);
+				_mm_storeu_ps(reinterpret_cast<float*>(dst + (size_t)(iter + 2) * outStride) + 4 * j, col2);
+				_mm_storeu_ps(reinterpret_cast<float*>(dst + (size_t)(iter + 3) * outStride) + 4 * j, col3);
+			}
+		}
+#endif
+		for (; iter < count; ++iter) {
+			mat3 n = normalMatrix(in[iter]);
+			float* col = reinterpret_cast<float*>(dst + (size_t)iter * outStride);
+			for (uint j = 0; j < 3; ++j) {
+				col[4 * j] = n(0, j);
+				col[4 * j + 1] = n(1, j);
+				col[4 * j + 2] = n(2, j);
+				col[4 * j + 3] = 0.f;
+			}
+		}
+	}
+
+	// GPU LAYOUT ===========================================
+
+	void mulToGpu(const mat<4, 4>* a, const affine3x4* b, gpuMat4* out, uint count) {
+		for (uint iter = 0; iter < count; ++iter) {
+			out[iter] = mulToGpu(a[iter], b[iter]);
+		}
+	}
+
+	// BATCHED TRANSFORMS ===================================
+
+	void transformPoints(const mat<4, 4>& mt, const vec<4>* in, vec<4>* out, uint count) {
+		uint iter = 0;
+#ifdef DK_MATH_AVX
+		// two points per iteration, one per 128-bit lane
+		__m128 c0 = _mm_loadu_ps(mt.data() + 0);
+		__m128 c1 = _mm_loadu_ps(mt.data() + 4);
+		__m128 c2 = _mm_loadu_ps(mt.data() + 8);
+		__m128 c3 = _mm_loadu_ps(mt.data() + 12);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		__m256 col0 = _mm256_set_m128(c0, c0);
+		__m256 col1 = _mm256_set_m128(c1, c1);
+		__m256 col2 = _mm256_set_m128(c2, c2);
+		__m256 col3 = _mm256_set_m128(c3, c3);
+		for (; iter + 2 <= count; iter += 2) {
+			__m256 v = _mm256_loadu_ps(in[iter].data());
+			__m256 res = _mm256_mul_ps(col0, _mm256_shuffle_ps(v, v, 0x00));
+			res = _mm256_add_ps(res, _mm256_mul_ps(col1, _mm256_shuffle_ps(v, v, 0x55)));
+			res = _mm256_add_ps(res, _mm256_mul_ps(col2, _mm256_shuffle_ps(v, v, 0xAA)));
+			res = _mm256_add_ps(res, _mm256_mul_ps(col3, _mm256_shuffle_ps(v, v, 0xFF)));
+			_mm256_storeu_ps(out[iter].data(), res);
+		}
+#endif
+		transformPoints(mt, reinterpret_cast<const float*>(in + iter), (uint)sizeof(vec<4>),
+			reinterpret_cast<float*>(out + iter), (uint)sizeof(vec<4>), count - iter);
+	}
+
+	void transformPoints(const mat<4, 4>& mt, const float* in, uint inStride, float* out, uint outStride, uint count) {
+		const char* src = reinterpret_cast<const char*>(in);
+		char* dst = reinterpret_cast<char*>(out);
+#ifdef DK_MATH_SSE
+		__m128 c0 = _mm_loadu_ps(mt.data() + 0);
+		__m128 c1 = _mm_loadu_ps(mt.data() + 4);
+		__m128 c2 = _mm_loadu_ps(mt.data() + 8);
+		__m128 c3 = _mm_loadu_ps(mt.data() + 12);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		for (uint iter = 0; iter < count; ++iter) {
+			__m128 v = _mm_loadu_ps(reinterpret_cast<const float*>(src + (size_t)iter * inStride));
+			__m128 res = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, 0x00));
+			res = _mm_add_ps(res, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, 0x55)));
+			res = _mm_add_ps(res, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, 0xAA)));
+			res = _mm_add_ps(res, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, 0xFF)));
+			_mm_storeu_ps(reinterpret_cast<float*>(dst + (size_t)iter * outStride), res);
+		}
+#else
+		const float* m = mt.data();
+		for (uint iter = 0; iter < count; ++iter) {
+			const float* v = reinterpret_cast<const float*>(src + (size_t)iter * inStride);
+			float res[4];
+			for (uint i = 0; i < 4; ++i) {
+				res[i] = m[4 * i] * v[0] + m[4 * i + 1] * v[1] + m[4 * i + 2] * v[2] + m[4 * i + 3] * v[3];
+			}
+			std::memcpy(dst + (size_t)iter * outStride, res, sizeof(res));
+		}
+#endif
+	}
+
+	void transformPointsSoA(const mat<4, 4>& mt, const float* const in[4], float* const out[4], uint count) {
+		const float* m = mt.data();
+		uint iter = 0;
+#if defined(DK_MATH_AVX512)
+		for (; iter + 16 <= count; iter += 16) {
+			__m512 x = _mm512_loadu_ps(in[0] + iter);
+			__m512 y = _mm512_loadu_ps(in[1] + iter);
+			__m512 z = _mm512_loadu_ps(in[2] + iter);
+			__m512 w = in[3] != nullptr ? _mm512_loadu_ps(in[3] + iter) : _mm512_set1_ps(1.f);
+			for (uint r = 0; r < 4; ++r) {
+				__m512 res = _mm512_mul_ps(_mm512_set1_ps(m[4 * r]), x);
+				res = _mm512_fmadd_ps(_mm512_set1_ps(m[4 * r + 1]), y, res);
+				res = _mm512_fmadd_ps(_mm512_set1_ps(m[4 * r + 2]), z, res);
+				res = _mm512_fmadd_ps(_mm512_set1_ps(m[4 * r + 3]), w, res);
+				_mm512_storeu_ps(out[r] + iter, res);
+			}
+		}
+#endif
+#if defined(DK_MATH_AVX2)
+		// AVX2 does not imply FMA, so multiply and add separately
+		for (; iter + 8 <= count; iter += 8) {
+			__m256 x = _mm256_loadu_ps(in[0] + iter);
+			__m256 y = _mm256_loadu_ps(in[1] + iter);
+			__m256 z = _mm256_loadu_ps(in[2] + iter);
+			__m256 w = in[3] != nullptr ? _mm256_loadu_ps(in[3] + iter) : _mm256_set1_ps(1.f);
+			for (uint r = 0; r < 4; ++r) {
+				__m256 res = _mm256_mul_ps(_mm256_set1_ps(m[4 * r]), x);
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_set1_ps(m[4 * r + 1]), y));
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_set1_ps(m[4 * r + 2]), z));
+				res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_set1_ps(m[4 * r + 3]), w));
+				_mm256_storeu_ps(out[r] + iter, res);
+			}
+		}
+#endif
+#if defined(DK_MATH_SSE)
+		for (; iter + 4 <= count; iter += 4) {
+			__m128 x = _mm_loadu_ps(in[0] + iter);
+			__m128 y = _mm_loadu_ps(in[1] + iter);
+			__m128 z = _mm_loadu_ps(in[2] + iter);
+			__m128 w = in[3] != nullptr ? _mm_loadu_ps(in[3] + iter) : _mm_set1_ps(1.f);
+			for (uint r = 0; r < 4; ++r) {
+				__m128 res = _mm_mul_ps(_mm_set1_ps(m[4 * r]), x);
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(m[4 * r + 1]), y));
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(m[4 * r + 2]), z));
+				res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(m[4 * r + 3]), w));
+				_mm_storeu_ps(out[r] + iter, res);
+			}
+		}
+#endif
+		for (; iter < count; ++iter) {
+			float x = in[0][iter];
+			float y = in[1][iter];
+			float z = in[2][iter];
+			float w = in[3] != nullptr ? in[3][iter] : 1.f;
+			for (uint r = 0; r < 4; ++r) {
+				out[r][iter] = m[4 * r] * x + m[4 * r + 1] * y + m[4 * r + 2] * z + m[4 * r + 3] * w;
+			}
+		}
+	}
+
+	void determinants(const mat<4, 4>* in, float* out, uint count) {
+		for (uint iter = 0; iter < count; ++iter) {
+			out[iter] = determinant(in[iter]);
+		}
+	}
+
+	uint invertMatrices(const mat<4, 4>* in, mat<4, 4>* out, uint count) {
+		uint singular = 0;
+		for (uint iter = 0; iter < count; ++iter) {
+			mat<4, 4> inv;
+			if (invert4x4(in[iter], inv) == 0.f) {
+				++singular;
+			}
+			out[iter] = inv;
+		}
+		return singular;
+	}
+
+	// QUATERNION ===========================================
+
+	quat normalize(const quat& q) {
+		float len = q.norm();
+		if (len == 0.f) {
+			throw std::runtime_error("Cannot normalize the zero quaternion.");
+		}
+		float inv = 1.f / len;
+		return quat(q[0] * inv, q[1] * inv, q[2] * inv, q[3] * inv);
+	}
+
+	quat axisAngle(float angle, const vec<3>& axis) {
+		vec3 normAx = normalize(axis);
+		float halfAngle = angle * PI / 360.f;
+		float s = sin(halfAngle);
+		return quat(normAx[0] * s, normAx[1] * s, normAx[2] * s, cos(halfAngle));
+	}
+
+	quat nlerp(const quat& a, const quat& b, float t) {
+		// q and -q are the same rotation; blend towards the closer one
+		float wb = dot(a, b) < 0.f ? -t : t;
+		float wa = 1.f - t;
+		return normalize(quat(
+			a[0] * wa + b[0] * wb,
+			a[1] * wa + b[1] * wb,
+			a[2] * wa + b[2] * wb,
+			a[3] * wa + b[3] * wb
+		));
+	}
+
+	quat slerp(const quat& a, const quat& b, float t) {
+		float d = dot(a, b);
+		float sign = 1.f;
+		if (d < 0.f) {
+			d = -d;
+			sign = -1.f;
+		}
+		// nearly parallel: the sin ratio is ill-conditioned, nlerp is exact enough
+		if (d > 0.9995f) {
+			return nlerp(a, b, t);
+		}
+		float theta = acos(d);
+		float sinTheta = sin(theta);
+		float wa = sin((1.f - t) * theta) / sinTheta;
+		float wb = sign * sin(t * theta) / sinTheta;
+		return quat(
+			a[0] * wa + b[0] * wb,
+			a[1] * wa + b[1] * wb,
+			a[2] * wa + b[2] * wb,
+			a[3] * wa + b[3] * wb
+		);
+	}
+
+#ifdef DK_MATH_SSE
+	// Load four packed quaternions transposed so each register holds one component
+	static inline void loadQuats4(const quat* q, __m128& x, __m128& y, __m128& z, __m128& w) {
+		x = _mm_loadu_ps(q[0].data());
+		y = _mm_loadu_ps(q[1].data());
+		z = _mm_loadu_ps(q[2].data());
+		w = _mm_loadu_ps(q[3].data());
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+	}
+
+	// Arguments are passed by reference: 32-bit MSVC cannot pass more than three
+	//	__m128 values by value
+	static inline void storeQuats4(quat* q, const __m128& x, const __m128& y, const __m128& z, const __m128& w) {
+		__m128 r0 = x, r1 = y, r2 = z, r3 = w;
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(q[0].data(), r0);
+		_mm_storeu_ps(q[1].data(), r1);
+		_mm_storeu_ps(q[2].data(), r2);
+		_mm_storeu_ps(q[3].data(), r3);
+	}
+
+	static inline __m128 dot4(
+		const __m128& ax, const __m128& ay, const __m128& az, const __m128& aw,
+		const __m128& bx, const __m128& by, const __m128& bz, const __m128& bw
+	) {
+		__m128 d = _mm_mul_ps(ax, bx);
+		d = _mm_add_ps(d, _mm_mul_ps(ay, by));
+		d = _mm_add_ps(d, _mm_mul_ps(az, bz));
+		return _mm_add_ps(d, _mm_mul_ps(aw, bw));
+	}
+#endif
+
+	void multiplyQuats(const quat* a, const quat* b, quat* out, uint count) {
+		uint iter = 0;
+#ifdef DK_MATH_SSE
+		for (; iter + 4 <= count; iter += 4) {
+			__m128 ax, ay, az, aw, bx, by, bz, bw;
+			loadQuats4(a + iter, ax, ay, az, aw);
+			loadQuats4(b + iter, bx, by, bz, bw);
+			__m128 x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bx), _mm_mul_ps(ax, bw)), _mm_mul_ps(ay, bz)), _mm_mul_ps(az, by));
+			__m128 y = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(aw, by), _mm_mul_ps(ax, bz)), _mm_mul_ps(ay, bw)), _mm_mul_ps(az, bx));
+			__m128 z = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(aw, bz), _mm_mul_ps(ax, by)), _mm_mul_ps(ay, bx)), _mm_mul_ps(az, bw));
+			__m128 w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(aw, bw), _mm_mul_ps(ax, bx)), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+			storeQuats4(out + iter, x, y, z, w);
+		}
+#endif
+		for (; iter < count; ++iter) {
+			out[iter] = a[iter] * b[iter];
+		}
+	}
+
+	void nlerpQuats(const quat* a, const quat* b, float t, quat* out, uint count) {
+		uint iter = 0;
+#ifdef DK_MATH_SSE
+		__m128 ta = _mm_set1_ps(1.f - t);
+		__m128 tb = _mm_set1_ps(t);
+		__m128 signBit = _mm_set1_ps(-0.f);
+		for (; iter + 4 <= count; iter += 4) {
+			__m128 ax, ay, az, aw, bx, by, bz, bw;
+			loadQuats4(a + iter, ax, ay, az, aw);
+			loadQuats4(b + iter, bx, by, bz, bw);
+			// flip the weight of b where the quaternions are more than 90 degrees apart
+			__m128 wb = _mm_xor_ps(tb, _mm_and_ps(dot4(ax, ay, az, aw, bx, by, bz, bw), signBit));
+			__m128 x = _mm_add_ps(_mm_mul_ps(ax, ta), _mm_mul_ps(bx, wb));
+			__m128 y = _mm_add_ps(_mm_mul_ps(ay, ta), _mm_mul_ps(by, wb));
+			__m128 z = _mm_add_ps(_mm_mul_ps(az, ta), _mm_mul_ps(bz, wb));
+			__m128 w = _mm_add_ps(_mm_mul_ps(aw, ta), _mm_mul_ps(bw, wb));
+			__m128 inv = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(dot4(x, y, z, w, x, y, z, w)));
+			storeQuats4(out + iter, _mm_mul_ps(x, inv), _mm_mul_ps(y, inv), _mm_mul_ps(z, inv), _mm_mul_ps(w, inv));
+		}
+#endif
+		for (; iter < count; ++iter) {
+			out[iter] = nlerp(a[iter], b[iter], t);
+		}
+	}
+
+	void slerpQuats(const quat* a, const quat* b, float t, quat* out, uint count) {
+		uint iter = 0;
+#ifdef DK_MATH_SSE
+		// sin(t * theta) / sin(theta) as a series in (cos(theta) - 1), after
+		//	Eberly's "A Fast and Accurate Algorithm for Computing SLERP". With t
+		//	shared across the batch the coefficients are scalars, so each lane
+		//	costs a short Horner loop instead of acos and two sin calls. Twenty
+		//	terms keep the error near float precision over the whole shorter arc.
+		const uint terms = 20;
+		float coefA[terms];
+		float coefB[terms];
+		float s = 1.f - t;
+		for (uint i = 1; i < terms; ++i) {
+			float denom = (float)(i * (2 * i + 1));
+			coefA[i] = (s * s - (float)(i * i)) / denom;
+			coefB[i] = (t * t - (float)(i * i)) / denom;
+		}
+		__m128 one = _mm_set1_ps(1.f);
+		__m128 signBit = _mm_set1_ps(-0.f);
+		for (; iter + 4 <= count; iter += 4) {
+			__m128 ax, ay, az, aw, bx, by, bz, bw;
+			loadQuats4(a + iter, ax, ay, az, aw);
+			loadQuats4(b + iter, bx, by, bz, bw);
+			__m128 d = dot4(ax, ay, az, aw, bx, by, bz, bw);
+			__m128 sign = _mm_and_ps(d, signBit);
+			__m128 u = _mm_sub_ps(_mm_xor_ps(d, sign), one);
+			__m128 wa = one;
+			__m128 wb = one;
+			for (uint i = terms - 1; i > 0; --i) {
+				wa = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(coefA[i]), u), wa));
+				wb = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(coefB[i]), u), wb));
+			}
+			wa = _mm_mul_ps(wa, _mm_set1_ps(s));
+			wb = _mm_xor_ps(_mm_mul_ps(wb, _mm_set1_ps(t)), sign);
+			__m128 x = _mm_add_ps(_mm_mul_ps(ax, wa), _mm_mul_ps(bx, wb));
+			__m128 y = _mm_add_ps(_mm_mul_ps(ay, wa), _mm_mul_ps(by, wb));
+			__m128 z = _mm_add_ps(_mm_mul_ps(az, wa), _mm_mul_ps(bz, wb));
+			__m128 w = _mm_add_ps(_mm_mul_ps(aw, wa), _mm_mul_ps(bw, wb));
+			storeQuats4(out + iter, x, y, z, w);
+		}
+#endif
+		for (; iter < count; ++iter) {
+			out[iter] = slerp(a[iter], b[iter], t);
+		}
+	}
+
+	void quatsToMat4(const quat* in, const vec<4>* translations, mat<4, 4>* out, uint count) {
+		uint iter = 0;
+#ifdef DK_MATH_SSE
+		__m128 one = _mm_set1_ps(1.f);
+		__m128 two = _mm_set1_ps(2.f);
+		__m128 lastRow = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+		for (; iter + 4 <= count; iter += 4) {
+			__m128 x, y, z, w;
+			loadQuats4(in + iter, x, y, z, w);
+			__m128 tx = _mm_setzero_ps();
+			__m128 ty = _mm_setzero_ps();
+			__m128 tz = _mm_setzero_ps();
+			if (translations != nullptr) {
+				tx = _mm_loadu_ps(translations[iter].data());
+				ty = _mm_loadu_ps(translations[iter + 1].data());
+				tz = _mm_loadu_ps(translations[iter + 2].data());
+				__m128 tw = _mm_loadu_ps(translations[iter + 3].data());
+				_MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+			}
+			__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+			// each row is built for all four matrices, then transposed so every
+			//	register holds that row of a single matrix
+			__m128 r0 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+			__m128 r1 = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+			__m128 r2 = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+			__m128 r3 = tx;
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(out[iter].data(), r0);
+			_mm_storeu_ps(out[iter + 1].data(), r1);
+			_mm_storeu_ps(out[iter + 2].data(), r2);
+			_mm_storeu_ps(out[iter + 3].data(), r3);
+
+			r0 = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+			r1 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+			r2 = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+			r3 = ty;
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(out[iter].data() + 4, r0);
+			_mm_storeu_ps(out[iter + 1].data() + 4, r1);
+			_mm_storeu_ps(out[iter + 2].data() + 4, r2);
+			_mm_storeu_ps(out[iter + 3].data() + 4, r3);
+
+			r0 = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+			r1 = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+			r2 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+			r3 = tz;
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(out[iter].data() + 8, r0);
+			_mm_storeu_ps(out[iter + 1].data() + 8, r1);
+			_mm_storeu_ps(out[iter + 2].data() + 8, r2);
+			_mm_storeu_ps(out[iter + 3].data() + 8, r3);
+
+			for (uint k = 0; k < 4; ++k) {
+				_mm_storeu_ps(out[iter + k].data() + 12, lastRow);
+			}
+		}
+#endif
+		for (; iter < count; ++iter) {
+			mat4 m = toMat4(in[iter]);
+			if (translations != nullptr) {
+				m(0, 3) = translations[iter][0];
+				m(1, 3) = translations[iter][1];
+				m(2, 3) = translations[iter][2];
+			}
+			out[iter] = m;
+		}
+	}
 }
\ No newline at end of file
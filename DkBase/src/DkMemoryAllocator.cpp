@@ -0,0 +1,339 @@
+#include "DkMemoryAllocator.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static uint _bitScanForward(uint64 v) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, v);
+	return (uint)index;
+#else
+	return (uint)__builtin_ctzll(v);
+#endif
+}
+
+static uint _bitScanReverse(uint64 v) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, v);
+	return (uint)index;
+#else
+	return 63 - (uint)__builtin_clzll(v);
+#endif
+}
+
+const uint DkTlsfAllocator::INVALID_HANDLE;
+
+static VkDeviceSize _alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+DkTlsfAllocator::DkTlsfAllocator() :
+	m_size(0),
+	m_nodes(),
+	m_unusedNodes(INVALID_HANDLE),
+	m_flBitmap(0),
+	m_usedBytes(0),
+	m_allocationCount(0),
+	m_freeRangeCount(0)
+{
+	finalize();
+}
+
+bool DkTlsfAllocator::init(VkDeviceSize size) {
+	finalize();
+	if (size == 0) {
+		std::cout << "Cannot initialize an allocator with size zero." << std::endl;
+		return false;
+	}
+	m_size = size;
+	uint index = _newNode();
+	m_nodes[index] = {
+		0,
+		size,
+		INVALID_HANDLE,
+		INVALID_HANDLE,
+		INVALID_HANDLE,
+		INVALID_HANDLE,
+		true,
+		true
+	};
+	_insertFree(index);
+	return true;
+}
+
+void DkTlsfAllocator::finalize() {
+	m_size = 0;
+	m_nodes.clear();
+	m_unusedNodes = INVALID_HANDLE;
+	m_flBitmap = 0;
+	for (uint fl = 0; fl < FL_COUNT; ++fl) {
+		m_slBitmap[fl] = 0;
+		for (uint sl = 0; sl < SL_COUNT; ++sl) {
+			m_bins[fl][sl] = INVALID_HANDLE;
+		}
+	}
+	m_usedBytes = 0;
+	m_allocationCount = 0;
+	m_freeRangeCount = 0;
+}
+
+// Sizes below SL_COUNT get a bin each; above that, each power of two is split
+//	into SL_COUNT equal bins
+void DkTlsfAllocator::_mapping(VkDeviceSize size, uint& fl, uint& sl) {
+	if (size < SL_COUNT) {
+		fl = 0;
+		sl = (uint)size;
+		return;
+	}
+	uint msb = _bitScanReverse(size);
+	fl = msb - SL_LOG2 + 1;
+	sl = (uint)(size >> (msb - SL_LOG2)) - SL_COUNT;
+}
+
+// Finds the first non-empty bin whose every range is at least size bytes
+bool DkTlsfAllocator::_findFree(VkDeviceSize size, uint& fl, uint& sl) const {
+	if (size >= SL_COUNT) {
+		VkDeviceSize round = ((VkDeviceSize)1 << (_bitScanReverse(size) - SL_LOG2)) - 1;
+		if (size > ~(VkDeviceSize)0 - round) return false;
+		size += round;
+	}
+	_mapping(size, fl, sl);
+
+	uint slMap = m_slBitmap[fl] & (~0u << sl);
+	if (slMap == 0) {
+		if (fl + 1 >= FL_COUNT) return false;
+		uint64 flMap = m_flBitmap & (~(uint64)0 << (fl + 1));
+		if (flMap == 0) return false;
+		fl = _bitScanForward(flMap);
+		slMap = m_slBitmap[fl];
+	}
+	sl = _bitScanForward(slMap);
+	return true;
+}
+
+uint DkTlsfAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+	if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		std::cout << "Invalid allocation size or alignment." << std::endl;
+		return INVALID_HANDLE;
+	}
+
+	auto fits = [this, size, alignment](uint index) {
+		const node& n = m_nodes[index];
+		return _alignUp(n.offset, alignment) - n.offset + size <= n.size;
+	};
+
+	auto firstFit = [this, &fits](uint fl, uint sl) {
+		for (uint iter = m_bins[fl][sl]; iter != INVALID_HANDLE; iter = m_nodes[iter].nextFree) {
+			if (fits(iter)) return iter;
+		}
+		return INVALID_HANDLE;
+	};
+
+	// The head of the first bin large enough usually satisfies the alignment
+	//	as well; only pay for the worst-case padding when it does not
+	uint index = INVALID_HANDLE;
+	uint fl, sl;
+	bool found = _findFree(size, fl, sl);
+	uint paddedFl, paddedSl;
+	if (found && fits(m_bins[fl][sl])) {
+		index = m_bins[fl][sl];
+	}
+	else if (alignment > 1 && _findFree(size + alignment - 1, paddedFl, paddedSl)) {
+		index = m_bins[paddedFl][paddedSl];
+	}
+	else {
+		// No bin guarantees a fit; other ranges in the bin found for size, or
+		//	in the bin holding size itself, may still be aligned well enough
+		if (found) index = firstFit(fl, sl);
+		if (index == INVALID_HANDLE) {
+			_mapping(size, fl, sl);
+			index = firstFit(fl, sl);
+		}
+	}
+	if (index == INVALID_HANDLE) return INVALID_HANDLE;
+
+	_removeFree(index);
+
+	// Free the padding in front of the aligned start. The range before a free
+	//	range is never free, so nothing needs merging
+	VkDeviceSize aligned = _alignUp(m_nodes[index].offset, alignment);
+	if (aligned > m_nodes[index].offset) {
+		uint pad = _newNode();
+		node& n = m_nodes[index];
+		m_nodes[pad] = {
+			n.offset,
+			aligned - n.offset,
+			n.prevPhys,
+			index,
+			INVALID_HANDLE,
+			INVALID_HANDLE,
+			true,
+			true
+		};
+		if (n.prevPhys != INVALID_HANDLE) m_nodes[n.prevPhys].nextPhys = pad;
+		n.prevPhys = pad;
+		n.size -= aligned - n.offset;
+		n.offset = aligned;
+		_insertFree(pad);
+	}
+
+	// Return the remainder
+	if (m_nodes[index].size > size) {
+		uint tail = _newNode();
+		node& n = m_nodes[index];
+		m_nodes[tail] = {
+			n.offset + size,
+			n.size - size,
+			index,
+			n.nextPhys,
+			INVALID_HANDLE,
+			INVALID_HANDLE,
+			true,
+			true
+		};
+		if (n.nextPhys != INVALID_HANDLE) m_nodes[n.nextPhys].prevPhys = tail;
+		n.nextPhys = tail;
+		n.size = size;
+		_insertFree(tail);
+	}
+
+	m_nodes[index].free = false;
+	m_usedBytes += size;
+	++m_allocationCount;
+	offset = m_nodes[index].offset;
+	return index;
+}
+
+uint DkTlsfAllocator::allocateBelow(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize limit, VkDeviceSize& offset) {
+	uint handle = allocate(size, alignment, offset);
+	if (handle != INVALID_HANDLE && offset >= limit) {
+		// Free ranges are always fully merged, so freeing restores them
+		free(handle);
+		return INVALID_HANDLE;
+	}
+	return handle;
+}
+
+void DkTlsfAllocator::free(uint handle) {
+	if (!_isAllocated(handle)) {
+		std::cout << "Cannot free an allocation that is not live." << std::endl;
+		return;
+	}
+	m_usedBytes -= m_nodes[handle].size;
+	--m_allocationCount;
+	m_nodes[handle].free = true;
+
+	uint prev = m_nodes[handle].prevPhys;
+	if (prev != INVALID_HANDLE && m_nodes[prev].free) {
+		_removeFree(prev);
+		node& n = m_nodes[handle];
+		n.offset = m_nodes[prev].offset;
+		n.size += m_nodes[prev].size;
+		n.prevPhys = m_nodes[prev].prevPhys;
+		if (n.prevPhys != INVALID_HANDLE) m_nodes[n.prevPhys].nextPhys = handle;
+		_releaseNode(prev);
+	}
+
+	uint next = m_nodes[handle].nextPhys;
+	if (next != INVALID_HANDLE && m_nodes[next].free) {
+		_removeFree(next);
+		node& n = m_nodes[handle];
+		n.size += m_nodes[next].size;
+		n.nextPhys = m_nodes[next].nextPhys;
+		if (n.nextPhys != INVALID_HANDLE) m_nodes[n.nextPhys].prevPhys = handle;
+		_releaseNode(next);
+	}
+
+	_insertFree(handle);
+}
+
+VkDeviceSize DkTlsfAllocator::getOffset(uint handle) const {
+	if (!_isAllocated(handle)) {
+		std::cout << "Cannot query an allocation that is not live." << std::endl;
+		return 0;
+	}
+	return m_nodes[handle].offset;
+}
+
+VkDeviceSize DkTlsfAllocator::getAllocationSize(uint handle) const {
+	if (!_isAllocated(handle)) {
+		std::cout << "Cannot query an allocation that is not live." << std::endl;
+		return 0;
+	}
+	return m_nodes[handle].size;
+}
+
+DkAllocatorStats DkTlsfAllocator::getStats() const {
+	DkAllocatorStats stats = {
+		m_size,
+		m_usedBytes,
+		0,
+		m_allocationCount,
+		m_freeRangeCount
+	};
+	// The largest free range lives in the highest non-empty bin
+	if (m_flBitmap != 0) {
+		uint fl = _bitScanReverse(m_flBitmap);
+		uint sl = _bitScanReverse(m_slBitmap[fl]);
+		for (uint iter = m_bins[fl][sl]; iter != INVALID_HANDLE; iter = m_nodes[iter].nextFree) {
+			if (m_nodes[iter].size > stats.largestFreeRange) {
+				stats.largestFreeRange = m_nodes[iter].size;
+			}
+		}
+	}
+	return stats;
+}
+
+uint DkTlsfAllocator::_newNode() {
+	uint index = m_unusedNodes;
+	if (index != INVALID_HANDLE) {
+		m_unusedNodes = m_nodes[index].nextFree;
+	}
+	else {
+		index = (uint)m_nodes.size();
+		m_nodes.emplace_back();
+	}
+	m_nodes[index].live = true;
+	return index;
+}
+
+void DkTlsfAllocator::_releaseNode(uint index) {
+	m_nodes[index].live = false;
+	m_nodes[index].free = false;
+	m_nodes[index].nextFree = m_unusedNodes;
+	m_unusedNodes = index;
+}
+
+void DkTlsfAllocator::_insertFree(uint index) {
+	uint fl, sl;
+	_mapping(m_nodes[index].size, fl, sl);
+	node& n = m_nodes[index];
+	n.prevFree = INVALID_HANDLE;
+	n.nextFree = m_bins[fl][sl];
+	if (n.nextFree != INVALID_HANDLE) m_nodes[n.nextFree].prevFree = index;
+	m_bins[fl][sl] = index;
+	m_slBitmap[fl] |= 1u << sl;
+	m_flBitmap |= (uint64)1 << fl;
+	++m_freeRangeCount;
+}
+
+void DkTlsfAllocator::_removeFree(uint index) {
+	uint fl, sl;
+	_mapping(m_nodes[index].size, fl, sl);
+	node& n = m_nodes[index];
+	if (n.prevFree != INVALID_HANDLE) m_nodes[n.prevFree].nextFree = n.nextFree;
+	else m_bins[fl][sl] = n.nextFree;
+	if (n.nextFree != INVALID_HANDLE) m_nodes[n.nextFree].prevFree = n.prevFree;
+	if (m_bins[fl][sl] == INVALID_HANDLE) {
+		m_slBitmap[fl] &= ~(1u << sl);
+		if (m_slBitmap[fl] == 0) m_flBitmap &= ~((uint64)1 << fl);
+	}
+	--m_freeRangeCount;
+}
+
+bool DkTlsfAllocator::_isAllocated(uint handle) const {
+	return handle < (uint)m_nodes.size() && m_nodes[handle].live && !m_nodes[handle].free;
+}
\ No newline at end of file
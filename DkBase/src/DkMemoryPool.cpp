@@ -0,0 +1,250 @@
+#include <algorithm>
+
+#include "DkMemoryPool.h"
+#include "DkDevice.h"
+
+static VkDeviceSize _alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+DkMemoryPool::DkMemoryPool(DkDevice& device) :
+	m_device(device),
+	m_blockSize(DEFAULT_MEMORY_BLOCK_SIZE),
+	m_memProps({}),
+	m_atomSize(1),
+	m_separateLinear(false),
+	m_initialized(false),
+	m_blocks()
+{}
+
+void DkMemoryPool::setBlockSize(VkDeviceSize size) {
+	if (m_initialized) {
+		std::cout << "Cannot alter block size after initialization." << std::endl;
+		return;
+	}
+	m_blockSize = size;
+}
+
+bool DkMemoryPool::init() {
+	if (m_initialized) {
+		finalize();
+	}
+	m_memProps = m_device.getPhysDevice().getMemProps();
+	const VkPhysicalDeviceLimits& limits = m_device.getPhysDevice().getProperties().limits;
+	m_atomSize = limits.nonCoherentAtomSize > 0 ? limits.nonCoherentAtomSize : 1;
+	m_separateLinear = limits.bufferImageGranularity > 1;
+	m_initialized = true;
+	return true;
+}
+
+void DkMemoryPool::finalize() {
+	uint live = 0;
+	for (uint iter = 0; iter < (uint)m_blocks.size(); ++iter) {
+		if (m_blocks[iter] != nullptr) {
+			live += m_blocks[iter]->allocator.getStats().allocationCount;
+			_destroyBlock(iter);
+		}
+	}
+	if (live > 0) {
+		std::cout << "Memory pool finalized with " << live << " live allocations." << std::endl;
+	}
+	m_blocks.clear();
+	m_initialized = false;
+}
+
+VkDeviceSize DkMemoryPool::_getBlockSize(uint memoryType) {
+	// Don't let a single block claim a large share of small heaps, such as
+	//	the 256 MB device local + host visible window
+	VkDeviceSize heapSize = m_memProps.memoryHeaps[m_memProps.memoryTypes[memoryType].heapIndex].size;
+	return std::min(m_blockSize, std::max(heapSize / 8, (VkDeviceSize)1 << 20));
+}
+
+bool DkMemoryPool::_isCoherent(uint memoryType) {
+	return (m_memProps.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+bool DkMemoryPool::allocate(const VkMemoryRequirements& reqs, uint memoryType, bool linear, DkMemoryAllocation& alloc) {
+	if (!m_initialized) {
+		std::cout << "Cannot allocate from an uninitialized memory pool." << std::endl;
+		return false;
+	}
+	if (memoryType >= m_memProps.memoryTypeCount) {
+		std::cout << "Invalid memory type for pool allocation." << std::endl;
+		return false;
+	}
+
+	VkDeviceSize size = reqs.size;
+	VkDeviceSize alignment = std::max(reqs.alignment, (VkDeviceSize)1);
+	bool hostVisible = (m_memProps.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+	if (hostVisible && !_isCoherent(memoryType)) {
+		alignment = std::max(alignment, m_atomSize);
+		size = _alignUp(size, m_atomSize);
+	}
+	if (!m_separateLinear) linear = true;
+
+	VkDeviceSize blockSize = _getBlockSize(memoryType);
+	uint blockIndex = DkTlsfAllocator::INVALID_HANDLE;
+	uint handle = DkTlsfAllocator::INVALID_HANDLE;
+	VkDeviceSize offset = 0;
+	if (size > blockSize / 2) {
+		if (!_createBlock(memoryType, linear, size, true, blockIndex)) return false;
+		handle = m_blocks[blockIndex]->allocator.allocate(size, 1, offset);
+	}
+	else {
+		for (uint iter = 0; iter < (uint)m_blocks.size(); ++iter) {
+			block* b = m_blocks[iter];
+			if (b == nullptr || b->dedicated || b->memoryType != memoryType || b->linear != linear) continue;
+			handle = b->allocator.allocate(size, alignment, offset);
+			if (handle != DkTlsfAllocator::INVALID_HANDLE) {
+				blockIndex = iter;
+				break;
+			}
+		}
+		if (handle == DkTlsfAllocator::INVALID_HANDLE) {
+			if (!_createBlock(memoryType, linear, blockSize, false, blockIndex)) return false;
+			handle = m_blocks[blockIndex]->allocator.allocate(size, alignment, offset);
+		}
+	}
+	if (handle == DkTlsfAllocator::INVALID_HANDLE) {
+		std::cout << "Failed to sub-allocate memory from a new block." << std::endl;
+		return false;
+	}
+
+	m_device.getMemoryTracker().recordAllocation(memoryType, size);
+	block* b = m_blocks[blockIndex];
+	alloc = {
+		b->memory,
+		offset,
+		size,
+		b->mapped != nullptr ? (char*)b->mapped + offset : nullptr,
+		memoryType,
+		blockIndex,
+		handle
+	};
+	return true;
+}
+
+void DkMemoryPool::free(DkMemoryAllocation& alloc) {
+	if (alloc.block >= (uint)m_blocks.size() || m_blocks[alloc.block] == nullptr ||
+		m_blocks[alloc.block]->memory != alloc.memory) {
+		std::cout << "Cannot free memory that was not allocated by this pool." << std::endl;
+		return;
+	}
+	block* b = m_blocks[alloc.block];
+	b->allocator.free(alloc.handle);
+	m_device.getMemoryTracker().recordFree(alloc.memoryType, alloc.size);
+
+	if (b->allocator.isEmpty()) {
+		// Keep one empty block per type around so a free/allocate pattern
+		//	doesn't hit vkAllocateMemory every time
+		bool keep = !b->dedicated;
+		for (uint iter = 0; keep && iter < (uint)m_blocks.size(); ++iter) {
+			block* other = m_blocks[iter];
+			if (iter != alloc.block && other != nullptr && !other->dedicated && other->memoryType == b->memoryType &&
+				other->linear == b->linear && other->allocator.isEmpty()) {
+				keep = false;
+			}
+		}
+		if (!keep) _destroyBlock(alloc.block);
+	}
+	alloc = {};
+}
+
+bool DkMemoryPool::flush(const DkMemoryAllocation& alloc, VkDeviceSize offset, VkDeviceSize size) {
+	if (_isCoherent(alloc.memoryType)) return true;
+
+	// Allocations in non-coherent memory start and end on atom boundaries
+	VkDeviceSize start = alloc.offset + (offset & ~(m_atomSize - 1));
+	VkDeviceSize end = std::min(alloc.offset + _alignUp(offset + size, m_atomSize), alloc.offset + alloc.size);
+	VkMappedMemoryRange range = {
+		VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+		nullptr,
+		alloc.memory,
+		start,
+		end - start
+	};
+	if (vkFlushMappedMemoryRanges(m_device.get(), 1, &range) != VK_SUCCESS) {
+		std::cout << "Failed to flush memory." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool DkMemoryPool::_createBlock(uint memoryType, bool linear, VkDeviceSize size, bool dedicated, uint& index) {
+	VkMemoryAllocateInfo memInfo = {
+		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		nullptr,
+		size,
+		memoryType
+	};
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	if (vkAllocateMemory(m_device.get(), &memInfo, nullptr, &memory) != VK_SUCCESS) {
+		std::cout << "Failed to allocate memory block." << std::endl;
+		return false;
+	}
+
+	void* mapped = nullptr;
+	if ((m_memProps.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) &&
+		vkMapMemory(m_device.get(), memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+		std::cout << "Failed to map memory block." << std::endl;
+		vkFreeMemory(m_device.get(), memory, nullptr);
+		return false;
+	}
+
+	block* b = new block;
+	b->memory = memory;
+	b->mapped = mapped;
+	b->memoryType = memoryType;
+	b->linear = linear;
+	b->dedicated = dedicated;
+	b->size = size;
+	b->allocator.init(size);
+	m_device.getMemoryTracker().recordBlockAllocation(memoryType, size);
+
+	for (index = 0; index < (uint)m_blocks.size(); ++index) {
+		if (m_blocks[index] == nullptr) break;
+	}
+	if (index == (uint)m_blocks.size()) {
+		m_blocks.push_back(b);
+	}
+	else {
+		m_blocks[index] = b;
+	}
+	return true;
+}
+
+void DkMemoryPool::_destroyBlock(uint index) {
+	block* b = m_blocks[index];
+	if (b->mapped != nullptr) {
+		vkUnmapMemory(m_device.get(), b->memory);
+	}
+	vkFreeMemory(m_device.get(), b->memory, nullptr);
+	m_device.getMemoryTracker().recordBlockFree(b->memoryType, b->size);
+	delete b;
+	m_blocks[index] = nullptr;
+}
+
+void DkMemoryPool::getStats(std::vector<DkMemoryBlockStats>& stats) {
+	stats.clear();
+	for (auto& b : m_blocks) {
+		if (b == nullptr) continue;
+		stats.push_back({
+			b->memoryType,
+			b->linear,
+			b->dedicated,
+			b->mapped != nullptr,
+			b->allocator.getStats()
+		});
+	}
+}
+
+void DkMemoryPool::printStats() {
+	std::vector<DkMemoryBlockStats> stats;
+	getStats(stats);
+	std::cout << "Memory pool: " << stats.size() << " blocks" << std::endl;
+	for (auto& s : stats) {
+		std::cout << "\ttype " << s.memoryType << (s.dedicated ? " dedicated" : "") << (s.linear ? " linear" : " optimal") <<
+			": " << s.allocator.usedBytes << "/" << s.allocator.size << " bytes in " << s.allocator.allocationCount <<
+			" allocations, " << s.allocator.freeRangeCount << " free ranges, largest " << s.allocator.largestFreeRange << std::endl;
+	}
+}
\ No newline at end of file
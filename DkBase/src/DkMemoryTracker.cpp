@@ -0,0 +1,159 @@
+#include <algorithm>
+
+#include "DkMemoryTracker.h"
+
+DkMemoryTracker::DkMemoryTracker() :
+	m_memProps({}),
+	m_types(),
+	m_heaps(),
+	m_total({}),
+	m_histogram({})
+{}
+
+void DkMemoryTracker::init(const VkPhysicalDeviceMemoryProperties& memProps) {
+	m_memProps = memProps;
+	std::fill(std::begin(m_types), std::end(m_types), DkMemoryUsage({}));
+	std::fill(std::begin(m_heaps), std::end(m_heaps), DkMemoryUsage({}));
+	m_total = {};
+	m_histogram = {};
+}
+
+void DkMemoryTracker::finalize() {
+	if (m_total.allocations.count > 0 || m_total.blocks.count > 0) {
+		std::cout << "Memory tracker: " << m_total.allocations.count << " allocations (" << m_total.allocations.bytes <<
+			" bytes) in " << m_total.blocks.count << " blocks still live." << std::endl;
+	}
+	init({});
+}
+
+bool DkMemoryTracker::_validType(uint memoryType) {
+	if (memoryType >= m_memProps.memoryTypeCount) {
+		std::cout << "Memory tracker: invalid memory type " << memoryType << "." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void DkMemoryTracker::_add(DkMemoryCounter& counter, VkDeviceSize size) {
+	counter.bytes += size;
+	counter.peakBytes = std::max(counter.peakBytes, counter.bytes);
+	++counter.count;
+	++counter.totalCount;
+}
+
+void DkMemoryTracker::_remove(DkMemoryCounter& counter, VkDeviceSize size) {
+	counter.bytes -= std::min(counter.bytes, size);
+	if (counter.count > 0) --counter.count;
+}
+
+void DkMemoryTracker::recordBlockAllocation(uint memoryType, VkDeviceSize size) {
+	if (!_validType(memoryType)) return;
+	_add(m_types[memoryType].blocks, size);
+	_add(m_heaps[m_memProps.memoryTypes[memoryType].heapIndex].blocks, size);
+	_add(m_total.blocks, size);
+}
+
+void DkMemoryTracker::recordBlockFree(uint memoryType, VkDeviceSize size) {
+	if (!_validType(memoryType)) return;
+	if (m_types[memoryType].blocks.count == 0) {
+		std::cout << "Memory tracker: block freed that was never recorded." << std::endl;
+		return;
+	}
+	_remove(m_types[memoryType].blocks, size);
+	_remove(m_heaps[m_memProps.memoryTypes[memoryType].heapIndex].blocks, size);
+	_remove(m_total.blocks, size);
+}
+
+void DkMemoryTracker::recordAllocation(uint memoryType, VkDeviceSize size) {
+	if (!_validType(memoryType)) return;
+	_add(m_types[memoryType].allocations, size);
+	_add(m_heaps[m_memProps.memoryTypes[memoryType].heapIndex].allocations, size);
+	_add(m_total.allocations, size);
+	uint bucket = getHistogramBucket(size);
+	++m_histogram.live[bucket];
+	++m_histogram.total[bucket];
+}
+
+void DkMemoryTracker::recordFree(uint memoryType, VkDeviceSize size) {
+	if (!_validType(memoryType)) return;
+	if (m_types[memoryType].allocations.count == 0) {
+		std::cout << "Memory tracker: allocation freed that was never recorded." << std::endl;
+		return;
+	}
+	_remove(m_types[memoryType].allocations, size);
+	_remove(m_heaps[m_memProps.memoryTypes[memoryType].heapIndex].allocations, size);
+	_remove(m_total.allocations, size);
+	uint bucket = getHistogramBucket(size);
+	if (m_histogram.live[bucket] > 0) --m_histogram.live[bucket];
+}
+
+uint DkMemoryTracker::getHistogramBucket(VkDeviceSize size) {
+	uint bucket = 0;
+	VkDeviceSize limit = 256;
+	while (size > limit && bucket < DK_MEMORY_HISTOGRAM_BUCKETS - 1) {
+		limit <<= 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+VkDeviceSize DkMemoryTracker::getHistogramBucketLimit(uint bucket) {
+	if (bucket >= DK_MEMORY_HISTOGRAM_BUCKETS - 1) return ~(VkDeviceSize)0;
+	return (VkDeviceSize)256 << bucket;
+}
+
+static void _writeCounter(std::ostream& out, const char* name, const DkMemoryCounter& counter) {
+	out << "\"" << name << "\": { \"bytes\": " << counter.bytes << ", \"peakBytes\": " << counter.peakBytes <<
+		", \"count\": " << counter.count << ", \"totalCount\": " << counter.totalCount << " }";
+}
+
+static void _writeUsage(std::ostream& out, const DkMemoryUsage& usage) {
+	_writeCounter(out, "blocks", usage.blocks);
+	out << ", ";
+	_writeCounter(out, "allocations", usage.allocations);
+}
+
+void DkMemoryTracker::writeJson(std::ostream& out, const std::vector<DkHeapBudget>& budgets) {
+	out << "{" << std::endl;
+	out << "\t\"total\": { ";
+	_writeUsage(out, m_total);
+	out << " }," << std::endl;
+
+	out << "\t\"heaps\": [" << std::endl;
+	for (uint iter = 0; iter < m_memProps.memoryHeapCount; ++iter) {
+		const VkMemoryHeap& heap = m_memProps.memoryHeaps[iter];
+		out << "\t\t{ \"index\": " << iter << ", \"size\": " << heap.size << ", \"deviceLocal\": " <<
+			((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false") << ", ";
+		_writeUsage(out, m_heaps[iter]);
+		if (iter < budgets.size()) {
+			out << ", \"budget\": " << budgets[iter].budget << ", \"usage\": " << budgets[iter].usage;
+		}
+		out << " }" << (iter + 1 < m_memProps.memoryHeapCount ? "," : "") << std::endl;
+	}
+	out << "\t]," << std::endl;
+
+	out << "\t\"types\": [" << std::endl;
+	for (uint iter = 0; iter < m_memProps.memoryTypeCount; ++iter) {
+		out << "\t\t{ \"index\": " << iter << ", \"heap\": " << m_memProps.memoryTypes[iter].heapIndex <<
+			", \"propertyFlags\": " << m_memProps.memoryTypes[iter].propertyFlags << ", ";
+		_writeUsage(out, m_types[iter]);
+		out << " }" << (iter + 1 < m_memProps.memoryTypeCount ? "," : "") << std::endl;
+	}
+	out << "\t]," << std::endl;
+
+	// The last bucket has no upper bound; its maxSize is null
+	out << "\t\"histogram\": [" << std::endl;
+	for (uint iter = 0; iter < DK_MEMORY_HISTOGRAM_BUCKETS; ++iter) {
+		out << "\t\t{ \"maxSize\": ";
+		if (iter + 1 < DK_MEMORY_HISTOGRAM_BUCKETS) {
+			out << getHistogramBucketLimit(iter);
+		}
+		else {
+			out << "null";
+		}
+		out << ", \"live\": " << m_histogram.live[iter] << ", \"total\": " << m_histogram.total[iter] << " }" <<
+			(iter + 1 < DK_MEMORY_HISTOGRAM_BUCKETS ? "," : "") << std::endl;
+	}
+	out << "\t]" << std::endl;
+	out << "}" << std::endl;
+}
\ No newline at end of file
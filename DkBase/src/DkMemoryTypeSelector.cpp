@@ -0,0 +1,113 @@
+#include <algorithm>
+
+#include "DkMemoryTypeSelector.h"
+
+static uint _countBits(VkMemoryPropertyFlags flags) {
+	uint count = 0;
+	for (; flags != 0; flags &= flags - 1) {
+		++count;
+	}
+	return count;
+}
+
+DkMemoryTypeSelector::DkMemoryTypeSelector() :
+	m_memProps({}),
+	m_rankings()
+{}
+
+void DkMemoryTypeSelector::init(const VkPhysicalDeviceMemoryProperties& memProps) {
+	m_memProps = memProps;
+	m_rankings.clear();
+}
+
+void DkMemoryTypeSelector::finalize() {
+	m_memProps = {};
+	m_rankings.clear();
+}
+
+DkMemoryTypeRequest DkMemoryTypeSelector::resolve(const DkMemoryTypeRequest& request) {
+	DkMemoryTypeRequest hint = { 0, 0, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, request.usage };
+	switch (request.usage) {
+	case DK_MEMORY_USAGE_GPU_ONLY:
+		hint.preferred |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		hint.avoided |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		break;
+	case DK_MEMORY_USAGE_UPLOAD:
+		// Write-combined system memory: sequential writes are fast and the
+		//	small device local + host visible window is left alone
+		hint.required |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		hint.preferred |= VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		hint.avoided |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		break;
+	case DK_MEMORY_USAGE_READBACK:
+		// Uncached reads are very slow
+		hint.required |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		hint.preferred |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		hint.avoided |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		break;
+	case DK_MEMORY_USAGE_DYNAMIC:
+		// Read in place by the device, so device local if it can be mapped
+		hint.required |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		hint.preferred |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		hint.avoided |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		break;
+	default:
+		break;
+	}
+
+	// Explicit flags win over those implied by the hint
+	DkMemoryTypeRequest resolved;
+	resolved.required = request.required | hint.required;
+	resolved.preferred = request.preferred | (hint.preferred & ~request.avoided);
+	resolved.avoided = (request.avoided | (hint.avoided & ~request.preferred)) & ~resolved.required;
+	resolved.usage = request.usage;
+	return resolved;
+}
+
+const std::vector<uint>& DkMemoryTypeSelector::_getRanking(uint typeBits, const DkMemoryTypeRequest& request) {
+	DkMemoryTypeRequest resolved = resolve(request);
+	rankingKey key(typeBits, resolved.required, resolved.preferred, resolved.avoided);
+	auto known = m_rankings.find(key);
+	if (known != m_rankings.end()) return known->second;
+
+	std::vector<uint>& ranking = m_rankings[key];
+	for (uint iter = 0; iter < m_memProps.memoryTypeCount; ++iter) {
+		if ((typeBits & (1u << iter)) && (m_memProps.memoryTypes[iter].propertyFlags & resolved.required) == resolved.required) {
+			ranking.push_back(iter);
+		}
+	}
+
+	const VkPhysicalDeviceMemoryProperties& props = m_memProps;
+	VkMemoryPropertyFlags wanted = resolved.required | resolved.preferred;
+	std::stable_sort(ranking.begin(), ranking.end(), [&props, &resolved, wanted](uint a, uint b) {
+		VkMemoryPropertyFlags flagsA = props.memoryTypes[a].propertyFlags;
+		VkMemoryPropertyFlags flagsB = props.memoryTypes[b].propertyFlags;
+		uint preferredA = _countBits(flagsA & resolved.preferred), preferredB = _countBits(flagsB & resolved.preferred);
+		if (preferredA != preferredB) return preferredA > preferredB;
+		uint avoidedA = _countBits(flagsA & resolved.avoided), avoidedB = _countBits(flagsB & resolved.avoided);
+		if (avoidedA != avoidedB) return avoidedA < avoidedB;
+		uint extraA = _countBits(flagsA & ~wanted), extraB = _countBits(flagsB & ~wanted);
+		if (extraA != extraB) return extraA < extraB;
+		return props.memoryHeaps[props.memoryTypes[a].heapIndex].size > props.memoryHeaps[props.memoryTypes[b].heapIndex].size;
+	});
+	return ranking;
+}
+
+int DkMemoryTypeSelector::select(
+	uint typeBits,
+	const DkMemoryTypeRequest& request,
+	VkDeviceSize size,
+	const std::vector<VkDeviceSize>& heapUsage
+) {
+	const std::vector<uint>& ranking = _getRanking(typeBits, request);
+	for (auto& type : ranking) {
+		uint heap = m_memProps.memoryTypes[type].heapIndex;
+		VkDeviceSize used = heap < heapUsage.size() ? heapUsage[heap] : 0;
+		if (used + size <= m_memProps.memoryHeaps[heap].size) return (int)type;
+	}
+	// Every heap is full; let the driver try the best type that could hold it
+	for (auto& type : ranking) {
+		if (size <= m_memProps.memoryHeaps[m_memProps.memoryTypes[type].heapIndex].size) return (int)type;
+	}
+	return -1;
+}
\ No newline at end of file
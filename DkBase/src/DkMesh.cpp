@@ -1,28 +1,55 @@
+#include <algorithm>
 #include "DkMesh.h"
+#include "DkDevice.h"
 #include "DkBuffer.h"
 #include "DkUniformBuffer.h"
 #include "DkSemaphore.h"
+#include "DkUploadManager.h"
+#include "DkLinearAllocator.h"
 
 using namespace math;
 
 DkMesh::DkMesh(DkBuffer* buffer, uint maxInstances) :
 	m_maxInstances(maxInstances),
 	m_vertBuffer(buffer),
+	m_indexBuffer(nullptr),
+	m_indexType(VK_INDEX_TYPE_UINT32),
 	m_mvpBuffer(nullptr),
+	m_mvpBufferNormal(nullptr),
 	m_MV(),
 	m_proj(),
 	m_extBuffer(buffer != nullptr),
-	m_verts()
+	m_arena(nullptr),
+	m_arenaRange({ 0, 0, 0, 0, DkTlsfAllocator::INVALID_HANDLE, DkTlsfAllocator::INVALID_HANDLE }),
+	m_packedNormals(false),
+	m_frameCount(1),
+	m_mvpFrame(0),
+	m_mvpRange(0),
+	m_normalRange(0),
+	m_vertFormat(DK_VERTEX_FORMAT_FULL),
+	m_verts(),
+	m_indices(),
+	m_welder()
 {
-	m_MV.resize(m_maxInstances, ident<4>());
+	m_MV.resize(m_maxInstances, affine3x4(ident<4>()));
 	m_proj.resize(m_maxInstances, ident<4>());
 }
 
 void DkMesh::addVerts(const std::vector<DkVertex>& verts) {
-	m_verts.insert(m_verts.end(), verts.begin(), verts.end());
+	if (m_indexBuffer != nullptr) {
+		std::cout << "Cannot add vertices after initialization." << std::endl;
+		return;
+	}
+	// A mesh on an external buffer has no index buffer and draws its vertices
+	//	as added
+	if (m_extBuffer) {
+		m_verts.insert(m_verts.end(), verts.begin(), verts.end());
+		return;
+	}
+	m_welder.weld(verts.data(), (uint)verts.size(), m_verts, m_indices);
 }
 
-void DkMesh::setMV(const mat4& mv, uint index) {
+void DkMesh::setMV(const affine3x4& mv, uint index) {
 	if (index >= m_maxInstances) {
 		std::cout << "MV index exceeds max limit." << std::endl;
 		return;
@@ -38,30 +65,69 @@ void DkMesh::setProj(const mat4& proj, uint index) {
 	m_proj[index] = proj;
 }
 
+void DkMesh::setPackedNormalMatrices(bool packed) {
+	if (m_mvpBuffer != nullptr) {
+		std::cout << "Cannot alter normal matrix layout after initialization." << std::endl;
+		return;
+	}
+	m_packedNormals = packed;
+}
+
+void DkMesh::setFrameCount(uint count) {
+	if (m_mvpBuffer != nullptr) {
+		std::cout << "Cannot alter frame count after initialization." << std::endl;
+		return;
+	}
+	if (count == 0) {
+		std::cout << "Frame count must be at least 1." << std::endl;
+		return;
+	}
+	m_frameCount = count;
+}
+
+void DkMesh::setVertexFormat(DkVertexFormat format) {
+	if (m_vertBuffer != nullptr) {
+		std::cout << "Cannot alter vertex format after initialization." << std::endl;
+		return;
+	}
+	m_vertFormat = format;
+}
+
 bool DkMesh::pushMVP(DkCommandBuffer* bfr, DkQueue& queue, const std::vector<DkSemaphore*>& mvpSignalSemaphores, const std::vector<DkSemaphore*>& normalSignalSemaphores) {
 	if (m_mvpBuffer == nullptr) {
 		std::cout << "Cannot push view matrix. Buffers must be initialized first." << std::endl;
 		return false;
 	}
-	std::vector<mat4> locMVPS;
-	std::vector<mat4> locMVPSTranspInv;
-	for (uint iter = 0; iter < m_MV.size(); ++iter) {
-		locMVPS.push_back(transpose(m_proj[iter] * m_MV[iter]));
-		if (m_mvpBufferNormal != nullptr) {
-			locMVPSTranspInv.push_back(transpose(mat4(transpose(inverse(mat3(m_MV[iter]))))));
-		}
-	}
-	bool ret = m_mvpBuffer->pushData((uint)(sizeof(mat4) * locMVPS.size()), locMVPS.data(), bfr, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-		VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, VK_ACCESS_UNIFORM_READ_BIT, mvpSignalSemaphores, queue);
+	// MVPs are written straight into the column-major layout the shaders read
+	m_mvpFrame = (m_mvpFrame + 1) % m_frameCount;
+	std::vector<gpuMat4> locMVPS(m_MV.size());
+	mulToGpu(m_proj.data(), m_MV.data(), locMVPS.data(), (uint)m_MV.size());
+	bool ret = m_mvpBuffer->pushData((uint)(sizeof(gpuMat4) * locMVPS.size()), locMVPS.data(), bfr, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+		VK_ACCESS_UNIFORM_READ_BIT, mvpSignalSemaphores, queue, getMVPOffset());
 
 	if (ret && m_mvpBufferNormal != nullptr) {
-		return m_mvpBufferNormal->pushData((uint)(sizeof(mat4) * locMVPSTranspInv.size()), locMVPSTranspInv.data(), bfr, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-			VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, VK_ACCESS_UNIFORM_READ_BIT, normalSignalSemaphores, queue);
+		// normal matrices are written column-major, each column padded to a vec4
+		uint stride = _getNormalMatrixStride();
+		std::vector<float> locNormals(m_MV.size() * stride / sizeof(float), 0.f);
+		if (!m_packedNormals) {
+			for (uint iter = 0; iter < m_MV.size(); ++iter) {
+				locNormals[iter * 16 + 15] = 1.f;
+			}
+		}
+		normalMatrices(m_MV.data(), locNormals.data(), stride, (uint)m_MV.size());
+		return m_mvpBufferNormal->pushData((uint)(sizeof(float) * locNormals.size()), locNormals.data(), bfr, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+			VK_ACCESS_UNIFORM_READ_BIT, normalSignalSemaphores, queue, getMVNormalOffset());
 	}
 
 	return ret;
 }
 
+bool DkMesh::pushMVP(DkLinearAllocator& allocator, DkTransientAllocation& alloc) {
+	if (!allocator.allocateUniform(sizeof(gpuMat4) * m_MV.size(), alloc)) return false;
+	mulToGpu(m_proj.data(), m_MV.data(), (gpuMat4*)alloc.data, (uint)m_MV.size());
+	return true;
+}
+
 DkBuffer* DkMesh::getMVPBuffer() {
 	return m_mvpBuffer;
 }
@@ -104,6 +170,101 @@ void DkMesh::getPipelineCreateInfo(
 }
 
 bool DkMesh::initVertBuffer(DkDevice& device, DkCommandBuffer* bfr, DkQueue& queue, bool useUniformMVPBuffer) {
+	std::vector<DkVertexPacked> packed;
+	std::vector<DkVertexOct> packedOct;
+	if (!_createBuffers(device, useUniformMVPBuffer)) return false;
+	const void* vertData = _packVertices(packed, packedOct);
+	if (!m_vertBuffer->pushData(getVertexStride(m_vertFormat) * (uint)m_verts.size(), vertData, bfr, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, {}, queue)) return false;
+	std::vector<uint16_t> packedIndices;
+	if (!m_indexBuffer->pushData(getIndexStride(m_indexType) * (uint)m_indices.size(), _packIndices(packedIndices), bfr, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		VK_ACCESS_INDEX_READ_BIT, {}, queue)) return false;
+
+	if (useUniformMVPBuffer) {
+		return pushMVP(bfr, queue);
+	}
+	return true;
+}
+
+bool DkMesh::initVertBuffer(DkDevice& device, DkUploadManager& uploader, bool useUniformMVPBuffer) {
+	std::vector<DkVertexPacked> packed;
+	std::vector<DkVertexOct> packedOct;
+	if (!_createBuffers(device, useUniformMVPBuffer)) return false;
+	const void* vertData = _packVertices(packed, packedOct);
+	if (!uploader.uploadBuffer(*m_vertBuffer, vertData, getVertexStride(m_vertFormat) * m_verts.size(), 0,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT)) return false;
+	std::vector<uint16_t> packedIndices;
+	if (!uploader.uploadBuffer(*m_indexBuffer, _packIndices(packedIndices), getIndexStride(m_indexType) * m_indices.size(), 0,
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT)) return false;
+
+	// the MVP buffers are host visible and written in place; no command
+	//	buffer is needed
+	if (useUniformMVPBuffer) {
+		return pushMVP(nullptr, uploader.getOwnerQueue());
+	}
+	return true;
+}
+
+bool DkMesh::initVertBuffer(DkDevice& device, DkGeometryArena& arena, DkUploadManager& uploader, bool useUniformMVPBuffer) {
+	if (!_checkNoBuffer()) return false;
+	if (arena.getVertexFormat() != m_vertFormat) {
+		std::cout << "Cannot place mesh in arena. Vertex formats differ." << std::endl;
+		return false;
+	}
+	if (arena.getIndexBuffer() == nullptr) {
+		std::cout << "Cannot place mesh in arena. Arena has no index buffer." << std::endl;
+		return false;
+	}
+	// the arena's indices are relative to the mesh's first vertex
+	if (arena.getIndexType() == VK_INDEX_TYPE_UINT16 && ::getIndexType((uint)m_verts.size()) != VK_INDEX_TYPE_UINT16) {
+		std::cout << "Cannot place mesh in arena. Too many vertices for 16-bit indices." << std::endl;
+		return false;
+	}
+
+	if (!arena.allocate((uint)m_verts.size(), (uint)m_indices.size(), m_arenaRange)) return false;
+	m_arena = &arena;
+	m_vertBuffer = arena.getVertBuffer();
+	m_indexBuffer = arena.getIndexBuffer();
+	m_indexType = arena.getIndexType();
+
+	std::vector<DkVertexPacked> packed;
+	std::vector<DkVertexOct> packedOct;
+	if (!arena.uploadVertices(uploader, m_arenaRange, _packVertices(packed, packedOct))) return false;
+	std::vector<uint16_t> packedIndices;
+	if (!arena.uploadIndices(uploader, m_arenaRange, _packIndices(packedIndices))) return false;
+
+	if (useUniformMVPBuffer) {
+		if (!_createMVPBuffers(device)) return false;
+		return pushMVP(nullptr, uploader.getOwnerQueue());
+	}
+	return true;
+}
+
+const void* DkMesh::_packVertices(std::vector<DkVertexPacked>& packed, std::vector<DkVertexOct>& packedOct) {
+	// pack into the requested layout; the full format uploads m_verts as is
+	if (m_vertFormat == DK_VERTEX_FORMAT_PACKED) {
+		packed.resize(m_verts.size());
+		packVertices(m_verts.data(), packed.data(), (uint)m_verts.size());
+		return packed.data();
+	}
+	else if (m_vertFormat == DK_VERTEX_FORMAT_OCT) {
+		packedOct.resize(m_verts.size());
+		packVertices(m_verts.data(), packedOct.data(), (uint)m_verts.size());
+		return packedOct.data();
+	}
+	return m_verts.data();
+}
+
+const void* DkMesh::_packIndices(std::vector<uint16_t>& packed) {
+	if (m_indexType == VK_INDEX_TYPE_UINT16) {
+		packed.resize(m_indices.size());
+		packIndices(m_indices.data(), packed.data(), (uint)m_indices.size());
+		return packed.data();
+	}
+	return m_indices.data();
+}
+
+bool DkMesh::_checkNoBuffer() {
 	if (m_extBuffer) {
 		std::cout << "Cannot init buffer; one has already been provided." << std::endl;
 		return false;
@@ -111,37 +272,74 @@ bool DkMesh::initVertBuffer(DkDevice& device, DkCommandBuffer* bfr, DkQueue& que
 
 	if (m_vertBuffer != nullptr) {
 		std::cout << "Cannot init new buffer before finalizing current buffer." << std::endl;
+		return false;
 	}
+	return true;
+}
+
+bool DkMesh::_createBuffers(DkDevice& device, bool useUniformMVPBuffer) {
+	if (!_checkNoBuffer()) return false;
 
 	m_vertBuffer = new DkBuffer(device, nullptr);
-	m_vertBuffer->setSize(sizeof(DkVertex) * m_verts.size());
+	m_vertBuffer->setSize(getVertexStride(m_vertFormat) * m_verts.size());
 	m_vertBuffer->setUsage(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
 	if (!m_vertBuffer->init()) return false;
-	if (!m_vertBuffer->pushData((uint)m_vertBuffer->getSize(), m_verts.data(), bfr, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, {}, queue)) return false;
 
-	// initialize transformation matrix buffer
+	m_indexType = ::getIndexType((uint)m_verts.size());
+	m_indexBuffer = new DkBuffer(device, nullptr);
+	m_indexBuffer->setSize((VkDeviceSize)getIndexStride(m_indexType) * m_indices.size());
+	m_indexBuffer->setUsage(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	if (!m_indexBuffer->init()) return false;
+
 	if (useUniformMVPBuffer) {
-		m_mvpBuffer = new DkUniformBuffer(device, nullptr);
-		m_mvpBuffer->setSize(sizeof(mat4) * MAX_MESH_INSTANCES);
-		if (!m_mvpBuffer->init()) return false;
+		return _createMVPBuffers(device);
+	}
+	return true;
+}
 
-		m_mvpBufferNormal = new DkUniformBuffer(device, nullptr);
-		m_mvpBufferNormal->setSize(sizeof(mat4) * MAX_MESH_INSTANCES);
-		if (!m_mvpBufferNormal->init()) return false;
+bool DkMesh::_createMVPBuffers(DkDevice& device) {
+	// one range per frame in flight, each at a valid dynamic offset
+	VkDeviceSize align = std::max(device.getPhysDevice().getProperties().limits.minUniformBufferOffsetAlignment, (VkDeviceSize)16);
+	m_mvpRange = (sizeof(gpuMat4) * m_maxInstances + align - 1) & ~(align - 1);
+	m_normalRange = ((VkDeviceSize)_getNormalMatrixStride() * m_maxInstances + align - 1) & ~(align - 1);
+	m_mvpFrame = 0;
 
-		return pushMVP(bfr, queue);
-	}
+	// initialize transformation matrix buffer; host visible, so the per-frame
+	//	pushMVP writes it in place instead of staging a copy
+	m_mvpBuffer = new DkUniformBuffer(device, nullptr);
+	m_mvpBuffer->getMemory()->setPropFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	m_mvpBuffer->getMemory()->setUsage(DK_MEMORY_USAGE_DYNAMIC);
+	m_mvpBuffer->setSize(m_mvpRange * m_frameCount);
+	if (!m_mvpBuffer->init()) return false;
+
+	m_mvpBufferNormal = new DkUniformBuffer(device, nullptr);
+	m_mvpBufferNormal->getMemory()->setPropFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	m_mvpBufferNormal->getMemory()->setUsage(DK_MEMORY_USAGE_DYNAMIC);
+	m_mvpBufferNormal->setSize(m_normalRange * m_frameCount);
+	if (!m_mvpBufferNormal->init()) return false;
 	return true;
 }
 
 void DkMesh::finalizeBuffer() {
-	if (!m_extBuffer && m_vertBuffer != nullptr) {
+	if (m_arena != nullptr) {
+		// the arena owns the buffers; only give the range back
+		m_arena->free(m_arenaRange);
+		m_arena = nullptr;
+		m_vertBuffer = nullptr;
+		m_indexBuffer = nullptr;
+	}
+	else if (!m_extBuffer && m_vertBuffer != nullptr) {
 		m_vertBuffer->finalize();
 		delete m_vertBuffer;
 		m_vertBuffer = nullptr;
 	}
 
+	if (m_indexBuffer != nullptr) {
+		m_indexBuffer->finalize();
+		delete m_indexBuffer;
+		m_indexBuffer = nullptr;
+	}
+
 	if (m_mvpBuffer != nullptr) {
 		delete m_mvpBuffer;
 		m_mvpBuffer = nullptr;
@@ -156,4 +354,6 @@ void DkMesh::finalizeBuffer() {
 void DkMesh::finalize() {
 	finalizeBuffer();
 	m_verts.clear();
+	m_indices.clear();
+	m_welder.clear();
 }
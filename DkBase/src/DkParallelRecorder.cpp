@@ -0,0 +1,118 @@
+#include <algorithm>
+
+#include "DkParallelRecorder.h"
+#include "DkCommandPool.h"
+#include "DkCommandBuffer.h"
+
+DkParallelRecorder::DkParallelRecorder(DkDevice& device, DkQueue& queue) :
+	m_device(device),
+	m_queue(queue),
+	m_threadCount(std::max(std::thread::hardware_concurrency(), 1u)),
+	m_frameCount(3),
+	m_minDrawsPerThread(DEFAULT_MIN_DRAWS_PER_THREAD),
+	m_pools(),
+	m_bfrs(),
+	m_workers(),
+	m_initialized(false)
+{}
+
+void DkParallelRecorder::setThreadCount(uint count) {
+	if (m_initialized) {
+		std::cout << "Cannot alter recording thread count after initialization." << std::endl;
+		return;
+	}
+	m_threadCount = std::max(count, 1u);
+}
+
+void DkParallelRecorder::setFrameCount(uint count) {
+	if (m_initialized) {
+		std::cout << "Cannot alter recording frame count after initialization." << std::endl;
+		return;
+	}
+	m_frameCount = std::max(count, 1u);
+}
+
+void DkParallelRecorder::setMinDrawsPerThread(uint count) {
+	m_minDrawsPerThread = std::max(count, 1u);
+}
+
+bool DkParallelRecorder::init() {
+	if (m_initialized) {
+		finalize();
+	}
+
+	for (uint iter = 0; iter < m_frameCount * m_threadCount; ++iter) {
+		// Whole pools are reset each frame; no per-buffer reset needed
+		DkCommandPool* pool = new DkCommandPool(m_device, m_queue);
+		pool->setParameters(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		m_pools.push_back(pool);
+		if (!pool->init()) return false;
+
+		DkCommandBuffer* bfr = pool->allocate(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+		if (bfr == nullptr) return false;
+		m_bfrs.push_back(bfr);
+	}
+
+	if (!m_workers.init(m_threadCount - 1)) return false;
+	m_initialized = true;
+	return true;
+}
+
+void DkParallelRecorder::finalize() {
+	m_workers.finalize();
+	// The pools free their buffers
+	for (auto& pool : m_pools) {
+		delete pool;
+		pool = nullptr;
+	}
+	m_pools.clear();
+	m_bfrs.clear();
+	m_initialized = false;
+}
+
+bool DkParallelRecorder::record(
+	uint frameIndex,
+	DkCommandBuffer& primary,
+	DkRenderPass* renderPass,
+	uint subpass,
+	DkFramebuffer* framebuffer,
+	uint drawCount,
+	const DkRecordFunc& recordFunc
+) {
+	if (!m_initialized) {
+		std::cout << "Cannot record. Parallel recorder not initialized." << std::endl;
+		return false;
+	}
+
+	if (frameIndex >= m_frameCount) {
+		std::cout << "Cannot record. Frame index exceeds frame count." << std::endl;
+		return false;
+	}
+
+	if (drawCount == 0) return true;
+
+	uint parts = std::min(m_threadCount, (drawCount + m_minDrawsPerThread - 1) / m_minDrawsPerThread);
+	uint base = frameIndex * m_threadCount;
+	// One flag per part; std::vector<bool> packs bits and is not safe to
+	//	write from several threads
+	std::vector<char> recorded(parts, 0);
+
+	m_workers.run(parts, [&](uint part) {
+		if (!m_pools[base + part]->reset()) return;
+
+		uint first = 0, count = 0;
+		DkWorkerPool::split(drawCount, parts, part, first, count);
+		DkCommandBuffer* bfr = m_bfrs[base + part];
+		if (!bfr->beginRecording(renderPass, subpass, framebuffer)) return;
+		bool ok = recordFunc(*bfr, first, count);
+		recorded[part] = bfr->endRecording() && ok;
+	});
+
+	if (std::find(recorded.begin(), recorded.end(), 0) != recorded.end()) {
+		std::cout << "Failed to record secondary command buffers." << std::endl;
+		return false;
+	}
+
+	std::vector<DkCommandBuffer*> secondaries(m_bfrs.begin() + base, m_bfrs.begin() + base + parts);
+	return primary.executeCommands(secondaries);
+}
\ No newline at end of file
@@ -73,6 +73,16 @@ int DkPhysicalDevice::findQueueFamilyIndex(VkQueueFlags desirecCapabilities) {
 	return -1;
 }
 
+int DkPhysicalDevice::findDedicatedQueueFamilyIndex(VkQueueFlags desiredCapabilities, VkQueueFlags excludedCapabilities) {
+	for (uint index = 0; index < (uint)m_queueFamilyProps.size(); ++index) {
+		if ((m_queueFamilyProps[index].queueCount > 0) && (m_queueFamilyProps[index].queueFlags & desiredCapabilities) &&
+			!(m_queueFamilyProps[index].queueFlags & excludedCapabilities)) {
+			return index;
+		}
+	}
+	return -1;
+}
+
 int DkPhysicalDevice::findQueueFamilyPresentIndex(DkWindow& window) {
 	for (uint index = 0; index < (uint)m_queueFamilyProps.size(); ++index) {
 		if (m_queueFamilyProps[index].queueCount > 0) {
@@ -0,0 +1,185 @@
+#include "DkResourceState.h"
+
+static const VkAccessFlags WRITE_ACCESS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+	VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT |
+	VK_ACCESS_MEMORY_WRITE_BIT;
+
+static const DkUsageInfo USAGE_INFO[DK_RESOURCE_USAGE_COUNT] = {
+	{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL },
+	{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+	{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+	{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+	{ VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED },
+	{ VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+	{ VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+	{ VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL },
+	{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+	{ VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL },
+	{ VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT, VK_IMAGE_LAYOUT_GENERAL },
+	// Presentation is ordered by semaphores; only the layout matters
+	{ VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR }
+};
+
+DkResourceState DkResourceStateTracker::initialState(VkImageLayout layout) {
+	return {
+		layout,
+		VK_QUEUE_FAMILY_IGNORED,
+		0,
+		0,
+		0,
+		0,
+		0,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_IMAGE_LAYOUT_UNDEFINED
+	};
+}
+
+DkUsageInfo DkResourceStateTracker::getUsageInfo(DkResourceUsage usage) {
+	if (usage >= DK_RESOURCE_USAGE_COUNT) {
+		std::cout << "Invalid resource usage." << std::endl;
+		return { 0, 0, VK_IMAGE_LAYOUT_UNDEFINED };
+	}
+	return USAGE_INFO[usage];
+}
+
+bool DkResourceStateTracker::isWrite(VkAccessFlags access) {
+	return (access & WRITE_ACCESS) != 0;
+}
+
+bool DkResourceStateTracker::equal(const DkResourceState& a, const DkResourceState& b) {
+	return a.layout == b.layout && a.queueFamily == b.queueFamily && a.writeStages == b.writeStages &&
+		a.writeAccess == b.writeAccess && a.readStages == b.readStages && a.syncedStages == b.syncedStages &&
+		a.visibleAccess == b.visibleAccess && a.releasedTo == b.releasedTo && a.releasedFromLayout == b.releasedFromLayout;
+}
+
+void DkResourceStateTracker::settle(DkResourceState& state) {
+	state.writeStages = 0;
+	state.writeAccess = 0;
+	state.readStages = 0;
+	state.syncedStages = 0;
+	state.visibleAccess = 0;
+}
+
+bool DkResourceStateTracker::require(DkResourceState& state, DkResourceUsage usage, uint queueFamily, bool image, std::vector<DkStateTransition>& out) {
+	DkUsageInfo info = getUsageInfo(usage);
+	if (info.stages == 0) return false;
+	return require(state, info, queueFamily, image, out);
+}
+
+bool DkResourceStateTracker::require(DkResourceState& state, const DkUsageInfo& info, uint queueFamily, bool image, std::vector<DkStateTransition>& out) {
+	if (info.stages == 0) {
+		std::cout << "Cannot require resource state without pipeline stages." << std::endl;
+		return false;
+	}
+	VkImageLayout layout = image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+	if (state.releasedTo != VK_QUEUE_FAMILY_IGNORED) {
+		if (state.releasedTo != queueFamily) {
+			std::cout << "Cannot use resource. It was released to another queue family." << std::endl;
+			return false;
+		}
+		// The acquiring half repeats the release's layouts and takes the
+		//	place of the last write. It starts at the stages the semaphore
+		//	between the queues waits at, so its layout transition runs after
+		//	the release
+		out.push_back({
+			info.stages,
+			info.stages,
+			0,
+			info.access,
+			state.releasedFromLayout,
+			state.layout,
+			state.queueFamily,
+			queueFamily
+		});
+		state.queueFamily = queueFamily;
+		state.releasedTo = VK_QUEUE_FAMILY_IGNORED;
+		state.writeStages = info.stages;
+		state.writeAccess = 0;
+		state.readStages = 0;
+		state.syncedStages = info.stages;
+		state.visibleAccess = info.access;
+	}
+	else if (state.queueFamily == VK_QUEUE_FAMILY_IGNORED) {
+		state.queueFamily = queueFamily;
+	}
+	else if (queueFamily != VK_QUEUE_FAMILY_IGNORED && queueFamily != state.queueFamily) {
+		std::cout << "Cannot use resource. It is owned by another queue family; release it there first." << std::endl;
+		return false;
+	}
+
+	bool write = isWrite(info.access);
+	bool layoutChange = image && layout != state.layout;
+	if (!write && !layoutChange) {
+		// Reads only wait on the last write, and only once per stage and
+		//	access type
+		if (state.writeStages != 0 && ((info.stages & ~state.syncedStages) != 0 || (info.access & ~state.visibleAccess) != 0)) {
+			out.push_back({ state.writeStages, info.stages, state.writeAccess, info.access, layout, layout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED });
+			state.syncedStages |= info.stages;
+			state.visibleAccess |= info.access;
+		}
+		state.readStages |= info.stages;
+		return true;
+	}
+
+	// Writes and layout transitions wait on everything since the last write
+	VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+	if (srcStages != 0 || layoutChange) {
+		out.push_back({
+			srcStages != 0 ? srcStages : (VkPipelineStageFlags)VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			info.stages,
+			state.writeAccess,
+			info.access,
+			image ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED,
+			layout,
+			VK_QUEUE_FAMILY_IGNORED,
+			VK_QUEUE_FAMILY_IGNORED
+		});
+	}
+	// A layout transition is a write of its own, made visible to info.access
+	state.layout = layout;
+	state.writeStages = info.stages;
+	state.writeAccess = info.access & WRITE_ACCESS;
+	state.readStages = write ? 0 : info.stages;
+	state.syncedStages = info.stages;
+	state.visibleAccess = info.access;
+	return true;
+}
+
+bool DkResourceStateTracker::release(DkResourceState& state, DkResourceUsage usage, uint dstQueueFamily, bool image, std::vector<DkStateTransition>& out) {
+	DkUsageInfo info = getUsageInfo(usage);
+	if (info.stages == 0) return false;
+	return release(state, info, dstQueueFamily, image, out);
+}
+
+bool DkResourceStateTracker::release(DkResourceState& state, const DkUsageInfo& info, uint dstQueueFamily, bool image, std::vector<DkStateTransition>& out) {
+	if (state.queueFamily == VK_QUEUE_FAMILY_IGNORED || dstQueueFamily == VK_QUEUE_FAMILY_IGNORED) {
+		std::cout << "Cannot release resource. It has no owning queue family." << std::endl;
+		return false;
+	}
+	if (state.releasedTo != VK_QUEUE_FAMILY_IGNORED) {
+		std::cout << "Cannot release resource. It is already released." << std::endl;
+		return false;
+	}
+	if (dstQueueFamily == state.queueFamily) return true;
+
+	VkImageLayout layout = image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+	VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+	out.push_back({
+		srcStages != 0 ? srcStages : (VkPipelineStageFlags)VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		state.writeAccess,
+		0,
+		image ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED,
+		layout,
+		state.queueFamily,
+		dstQueueFamily
+	});
+	state.releasedFromLayout = image ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+	state.layout = layout;
+	state.releasedTo = dstQueueFamily;
+	settle(state);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,493 @@
+#include <algorithm>
+#include <cstring>
+
+#include "DkUploadManager.h"
+#include "DkDevice.h"
+#include "DkDeviceMemory.h"
+#include "DkBuffer.h"
+#include "DkImage.h"
+#include "DkCommandBuffer.h"
+#include "DkCommandPool.h"
+#include "DkFence.h"
+#include "DkSemaphore.h"
+
+// Satisfies vkCmdCopyBufferToImage for every format, block compressed included
+static const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+DkUploadManager::DkUploadManager(DkDevice& device, DkCommandPool& pool, DkQueue& queue) :
+	m_device(device),
+	m_pool(pool),
+	m_queue(queue),
+	m_stagingSize(DEFAULT_STAGING_RING_SIZE),
+	m_ownerPool(nullptr),
+	m_ownerQueue(nullptr),
+	m_staging(nullptr),
+	m_ring(nullptr),
+	m_transferOwnership(false),
+	m_initialized(false),
+	m_head(0),
+	m_tail(0),
+	m_batchStart(0),
+	m_bufferCopies(),
+	m_imageCopies(),
+	m_inFlight(),
+	m_idle(),
+	m_nextTicket(1),
+	m_completedTicket(0)
+{}
+
+void DkUploadManager::setStagingSize(VkDeviceSize size) {
+	if (m_initialized) {
+		std::cout << "Cannot alter staging size after initialization." << std::endl;
+		return;
+	}
+	m_stagingSize = size;
+}
+
+void DkUploadManager::setOwnerQueue(DkCommandPool& pool, DkQueue& queue) {
+	if (m_initialized) {
+		std::cout << "Cannot alter owner queue after initialization." << std::endl;
+		return;
+	}
+	m_ownerPool = &pool;
+	m_ownerQueue = &queue;
+}
+
+bool DkUploadManager::init() {
+	if (m_initialized) {
+		finalize();
+	}
+
+	m_staging = new DkBuffer(m_device, nullptr);
+	m_staging->getMemory()->setPropFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	m_staging->getMemory()->setUsage(DK_MEMORY_USAGE_UPLOAD);
+	m_staging->setSize(m_stagingSize);
+	m_staging->setUsage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	if (!m_staging->init()) return false;
+	m_ring = (char*)m_staging->getMappedData();
+	if (m_ring == nullptr) {
+		std::cout << "Failed to map staging ring." << std::endl;
+		return false;
+	}
+
+	m_transferOwnership = m_ownerQueue != nullptr && m_ownerQueue->getFamilyIndex() != m_queue.getFamilyIndex();
+	m_head = 0;
+	m_tail = 0;
+	m_batchStart = 0;
+	m_nextTicket = 1;
+	m_completedTicket = 0;
+	m_initialized = true;
+	return true;
+}
+
+void DkUploadManager::finalize() {
+	while (!m_inFlight.empty()) {
+		if (!_retireOldest()) break;
+	}
+	for (auto& b : m_inFlight) {
+		m_idle.push_back(b);
+	}
+	m_inFlight.clear();
+	for (auto& b : m_idle) {
+		m_pool.freeBuffer(b->cmdBfr);
+		if (b->acquireBfr != nullptr) m_ownerPool->freeBuffer(b->acquireBfr);
+		if (b->reclaimBfr != nullptr) m_ownerPool->freeBuffer(b->reclaimBfr);
+		delete b->handoff;
+		delete b->reclaim;
+		delete b->fence;
+		delete b;
+	}
+	m_idle.clear();
+	m_bufferCopies.clear();
+	m_imageCopies.clear();
+	if (m_staging != nullptr) {
+		delete m_staging;
+		m_staging = nullptr;
+	}
+	m_ring = nullptr;
+	m_initialized = false;
+}
+
+bool DkUploadManager::uploadBuffer(
+	DkBuffer& dst,
+	const void* data,
+	VkDeviceSize size,
+	VkDeviceSize dstOffset,
+	VkPipelineStageFlags consumingStage,
+	VkAccessFlags newAccess
+) {
+	if (!m_initialized) {
+		std::cout << "Cannot queue upload: upload manager not initialized." << std::endl;
+		return false;
+	}
+	if (consumingStage == 0) {
+		std::cout << "Cannot queue upload without a consuming stage." << std::endl;
+		return false;
+	}
+	if (dstOffset + size > dst.getSize()) {
+		std::cout << "Cannot queue upload past the end of the destination buffer." << std::endl;
+		return false;
+	}
+
+	// Split so that a large upload never needs the whole ring to itself
+	const char* src = (const char*)data;
+	VkDeviceSize maxChunk = std::max(m_stagingSize / 2, STAGING_ALIGNMENT);
+	while (size > 0) {
+		VkDeviceSize chunk = std::min(size, maxChunk);
+		VkDeviceSize offset;
+		if (!_reserve(chunk, offset)) return false;
+		std::memcpy(m_ring + offset, src, chunk);
+		m_bufferCopies.push_back({
+			&dst,
+			{ offset, dstOffset, chunk },
+			consumingStage,
+			newAccess
+		});
+		src += chunk;
+		dstOffset += chunk;
+		size -= chunk;
+	}
+	return true;
+}
+
+bool DkUploadManager::uploadImage(
+	DkImage& dst,
+	const void* data,
+	VkDeviceSize size,
+	const VkImageSubresourceLayers& subresource,
+	VkExtent3D extent,
+	VkImageLayout newLayout,
+	VkPipelineStageFlags consumingStage,
+	VkAccessFlags newAccess
+) {
+	if (!m_initialized) {
+		std::cout << "Cannot queue upload: upload manager not initialized." << std::endl;
+		return false;
+	}
+	if (consumingStage == 0) {
+		std::cout << "Cannot queue upload without a consuming stage." << std::endl;
+		return false;
+	}
+
+	VkDeviceSize offset;
+	if (!_reserve(size, offset)) return false;
+	std::memcpy(m_ring + offset, data, size);
+	m_imageCopies.push_back({
+		&dst,
+		{
+			offset,
+			0,					// tightly packed rows
+			0,
+			subresource,
+			{ 0, 0, 0 },
+			extent
+		},
+		newLayout,
+		consumingStage,
+		newAccess
+	});
+	return true;
+}
+
+bool DkUploadManager::submit(uint64& ticket, const std::vector<DkSemaphore*>& signalSemaphores) {
+	if (!m_initialized) {
+		std::cout << "Cannot submit uploads: upload manager not initialized." << std::endl;
+		return false;
+	}
+	_retireCompleted();
+
+	// Flush what this batch wrote to the ring, in two pieces if it wrapped
+	if (m_head > m_batchStart) {
+		VkDeviceSize start = m_batchStart % m_stagingSize;
+		VkDeviceSize size = m_head - m_batchStart;
+		VkDeviceSize first = std::min(size, m_stagingSize - start);
+		if (!m_staging->flush(start, first)) return false;
+		if (first < size && !m_staging->flush(0, size - first)) return false;
+	}
+
+	batch* b = _getBatch();
+	if (b == nullptr) return false;
+	// Set once anything of this batch went to a queue; errors after that
+	//	have to wait for it before the batch can be reused
+	bool submitted = false;
+	DkCommandBuffer* cmd = b->cmdBfr;
+	if (!cmd->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)) return _abandon(b, submitted);
+
+	// With an ownership transfer the upload queue only releases the resources;
+	//	the consumer stages and accesses belong to the acquire on the owner queue
+	uint dstFamily = m_transferOwnership ? m_ownerQueue->getFamilyIndex() : VK_QUEUE_FAMILY_IGNORED;
+	VkPipelineStageFlags consumers = 0;
+
+	// One transition per buffer and per image subresource range, however many
+	//	regions it receives
+	struct bufferUse {
+		DkBuffer* dst;
+		DkUsageInfo usage;
+	};
+	struct imageUse {
+		DkImage* dst;
+		uint mip;
+		uint baseLayer;
+		uint layerCount;
+		DkUsageInfo usage;
+	};
+	std::vector<bufferUse> buffers;
+	std::vector<imageUse> images;
+	for (auto& copy : m_bufferCopies) {
+		consumers |= copy.stage;
+		auto known = std::find_if(buffers.begin(), buffers.end(), [&copy](const bufferUse& use) {
+			return use.dst == copy.dst;
+		});
+		if (known != buffers.end()) {
+			known->usage.stages |= copy.stage;
+			known->usage.access |= copy.access;
+			continue;
+		}
+		buffers.push_back({ copy.dst, { copy.stage, copy.access, VK_IMAGE_LAYOUT_UNDEFINED } });
+	}
+	for (auto& copy : m_imageCopies) {
+		consumers |= copy.stage;
+		const VkImageSubresourceLayers& sub = copy.region.imageSubresource;
+		auto known = std::find_if(images.begin(), images.end(), [&copy, &sub](const imageUse& use) {
+			return use.dst == copy.dst && use.mip == sub.mipLevel && use.baseLayer == sub.baseArrayLayer && use.layerCount == sub.layerCount;
+		});
+		if (known != images.end()) {
+			known->usage.stages |= copy.stage;
+			known->usage.access |= copy.access;
+			known->usage.layout = copy.layout;
+			continue;
+		}
+		images.push_back({ copy.dst, sub.mipLevel, sub.baseArrayLayer, sub.layerCount, { copy.stage, copy.access, copy.layout } });
+	}
+
+	// Resources an earlier batch handed to the owner are released back by the
+	//	owner queue first, after its earlier uses of them. Buffers are uploaded
+	//	in pieces and keep the rest of their contents; images are uploaded
+	//	whole, so their release discards the old contents (old layout
+	//	UNDEFINED). The upload queue waits on that before acquiring them
+	std::vector<DkWaitSemaphoreData> reclaimWait;
+	if (m_transferOwnership) {
+		DkCommandBuffer* reclaimCmd = b->reclaimBfr;
+		bool recording = false;
+		for (auto& use : buffers) {
+			if (use.dst->getState().queueFamily != dstFamily) continue;
+			if (!recording && !reclaimCmd->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)) return _abandon(b, submitted);
+			recording = true;
+			if (!reclaimCmd->releaseState(*use.dst, DK_RESOURCE_USAGE_TRANSFER_DST, m_queue.getFamilyIndex())) return _abandon(b, submitted);
+		}
+		for (auto& use : images) {
+			for (uint layer = use.baseLayer; layer < use.baseLayer + use.layerCount; ++layer) {
+				DkResourceState& state = use.dst->getState(use.mip, layer);
+				if (state.queueFamily != dstFamily) continue;
+				if (!recording && !reclaimCmd->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)) return _abandon(b, submitted);
+				recording = true;
+				state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+				if (!reclaimCmd->releaseState(*use.dst, DK_RESOURCE_USAGE_TRANSFER_DST, m_queue.getFamilyIndex(), use.mip, 1, layer, 1)) {
+					return _abandon(b, submitted);
+				}
+			}
+		}
+		if (recording) {
+			if (!reclaimCmd->endRecording()) return _abandon(b, submitted);
+			submitted = true;
+			if (!reclaimCmd->submit(*m_ownerQueue, {}, { b->reclaim })) return _abandon(b, submitted);
+			reclaimWait.push_back({ b->reclaim, VK_PIPELINE_STAGE_TRANSFER_BIT });
+		}
+	}
+
+	if (!buffers.empty() || !images.empty()) {
+		// Released resources are acquired here; the rest wait on their
+		//	tracked previous use. Images not being released discard their
+		//	previous contents here instead
+		for (auto& use : buffers) {
+			if (!cmd->requireState(*use.dst, DK_RESOURCE_USAGE_TRANSFER_DST)) return _abandon(b, submitted);
+		}
+		for (auto& use : images) {
+			for (uint layer = use.baseLayer; layer < use.baseLayer + use.layerCount; ++layer) {
+				DkResourceState& state = use.dst->getState(use.mip, layer);
+				if (state.releasedTo == VK_QUEUE_FAMILY_IGNORED) {
+					state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+				}
+			}
+			if (!cmd->requireState(*use.dst, DK_RESOURCE_USAGE_TRANSFER_DST, use.mip, 1, use.baseLayer, use.layerCount)) return _abandon(b, submitted);
+		}
+
+		// Consecutive regions for the same buffer go out in one command
+		if (!cmd->flushBarriers()) return _abandon(b, submitted);
+		std::vector<VkBufferCopy> regions;
+		for (size_t iter = 0; iter < m_bufferCopies.size(); ++iter) {
+			regions.push_back(m_bufferCopies[iter].region);
+			if (iter + 1 == m_bufferCopies.size() || m_bufferCopies[iter + 1].dst != m_bufferCopies[iter].dst) {
+				vkCmdCopyBuffer(cmd->get(), m_staging->get(), m_bufferCopies[iter].dst->get(), (uint)regions.size(), regions.data());
+				regions.clear();
+			}
+		}
+		for (auto& copy : m_imageCopies) {
+			vkCmdCopyBufferToImage(cmd->get(), m_staging->get(), copy.dst->get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.region);
+		}
+
+		// A transfer-only queue can't name graphics stages; its release
+		//	barrier ends at BOTTOM_OF_PIPE and the semaphore carries the rest
+		for (auto& use : buffers) {
+			if (!(m_transferOwnership ? cmd->releaseState(*use.dst, use.usage, dstFamily) : cmd->requireState(*use.dst, use.usage))) return _abandon(b, submitted);
+		}
+		for (auto& use : images) {
+			if (!(m_transferOwnership ? cmd->releaseState(*use.dst, use.usage, dstFamily, use.mip, 1, use.baseLayer, use.layerCount) :
+				cmd->requireState(*use.dst, use.usage, use.mip, 1, use.baseLayer, use.layerCount))) return _abandon(b, submitted);
+		}
+	}
+
+	if (!cmd->endRecording()) return _abandon(b, submitted);
+	if (m_transferOwnership) {
+		// The acquire starts at the consumer stages, which the semaphore
+		//	waits at
+		DkCommandBuffer* acquireCmd = b->acquireBfr;
+		VkPipelineStageFlags waitStage = consumers != 0 ? consumers : (VkPipelineStageFlags)VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		submitted = true;
+		if (!cmd->submit(m_queue, reclaimWait, { b->handoff })) return _abandon(b, submitted);
+		if (!acquireCmd->beginRecording(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)) return _abandon(b, submitted);
+		for (auto& use : buffers) {
+			if (!acquireCmd->requireState(*use.dst, use.usage)) return _abandon(b, submitted);
+		}
+		for (auto& use : images) {
+			if (!acquireCmd->requireState(*use.dst, use.usage, use.mip, 1, use.baseLayer, use.layerCount)) return _abandon(b, submitted);
+		}
+		if (!acquireCmd->endRecording()) return _abandon(b, submitted);
+		if (!acquireCmd->submit(*m_ownerQueue, { { b->handoff, waitStage } }, signalSemaphores, *b->fence)) return _abandon(b, submitted);
+	}
+	else if (!cmd->submit(m_queue, {}, signalSemaphores, *b->fence)) return _abandon(b, submitted);
+
+	b->ticket = m_nextTicket++;
+	b->ringEnd = m_head;
+	m_inFlight.push_back(b);
+	m_batchStart = m_head;
+	m_bufferCopies.clear();
+	m_imageCopies.clear();
+	ticket = b->ticket;
+	return true;
+}
+
+bool DkUploadManager::isComplete(uint64 ticket) {
+	_retireCompleted();
+	return ticket <= m_completedTicket;
+}
+
+bool DkUploadManager::wait(uint64 ticket) {
+	if (ticket >= m_nextTicket) {
+		std::cout << "Cannot wait on an upload ticket that was not submitted." << std::endl;
+		return false;
+	}
+	while (m_completedTicket < ticket) {
+		if (!_retireOldest()) return false;
+	}
+	return true;
+}
+
+bool DkUploadManager::_reserve(VkDeviceSize size, VkDeviceSize& offset) {
+	if (size > m_stagingSize) {
+		std::cout << "Upload does not fit in the staging ring." << std::endl;
+		return false;
+	}
+	for (;;) {
+		_retireCompleted();
+		if (m_inFlight.empty() && m_head == m_batchStart) {
+			// Nothing in use: restart at the beginning of the ring
+			m_head = (m_head + m_stagingSize - 1) / m_stagingSize * m_stagingSize;
+			m_tail = m_head;
+			m_batchStart = m_head;
+		}
+
+		uint64 start = (m_head + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+		VkDeviceSize pos = start % m_stagingSize;
+		if (pos + size > m_stagingSize) start += m_stagingSize - pos;
+		if (start + size - m_tail <= m_stagingSize) {
+			m_head = start + size;
+			offset = start % m_stagingSize;
+			return true;
+		}
+
+		// Out of space: send what is queued, then wait for the oldest batch
+		if (!m_bufferCopies.empty() || !m_imageCopies.empty()) {
+			uint64 ticket;
+			if (!submit(ticket)) return false;
+		}
+		else if (!m_inFlight.empty()) {
+			if (!_retireOldest()) return false;
+		}
+		else {
+			// Only this batch's padding is left; drop it
+			m_batchStart = m_head;
+		}
+	}
+}
+
+// Returns a batch that failed part way to the idle list in a reusable state.
+//	Command buffers still recording are ended. If any of its work was
+//	submitted, the device is waited on so none of it is pending, and its
+//	semaphores are recreated as one may be signalled with nobody to wait on it
+bool DkUploadManager::_abandon(batch* b, bool submitted) {
+	for (DkCommandBuffer* cmd : { b->cmdBfr, b->acquireBfr, b->reclaimBfr }) {
+		if (cmd != nullptr && cmd->isRecording()) cmd->endRecording();
+	}
+	if (submitted) {
+		m_device.waitIdle();
+		for (DkSemaphore* sem : { b->handoff, b->reclaim }) {
+			if (sem == nullptr) continue;
+			sem->finalize();
+			sem->init();
+		}
+	}
+	m_idle.push_back(b);
+	return false;
+}
+
+bool DkUploadManager::_retireOldest() {
+	batch* b = m_inFlight.front();
+	if (!b->fence->wait()) return false;
+	m_tail = b->ringEnd;
+	m_completedTicket = b->ticket;
+	m_inFlight.pop_front();
+	m_idle.push_back(b);
+	return true;
+}
+
+void DkUploadManager::_retireCompleted() {
+	while (!m_inFlight.empty() && m_inFlight.front()->fence->isSignaled()) {
+		_retireOldest();
+	}
+}
+
+DkUploadManager::batch* DkUploadManager::_getBatch() {
+	if (!m_idle.empty()) {
+		batch* b = m_idle.back();
+		m_idle.pop_back();
+		if (!b->fence->reset()) {
+			m_idle.push_back(b);
+			return nullptr;
+		}
+		return b;
+	}
+
+	batch* b = new batch({ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0 });
+	b->cmdBfr = m_pool.allocate(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+	b->fence = new DkFence(m_device);
+	bool valid = b->cmdBfr != nullptr && b->fence->init(false);
+	if (valid && m_transferOwnership) {
+		b->acquireBfr = m_ownerPool->allocate(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+		b->reclaimBfr = m_ownerPool->allocate(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+		b->handoff = new DkSemaphore(m_device);
+		b->reclaim = new DkSemaphore(m_device);
+		valid = b->acquireBfr != nullptr && b->reclaimBfr != nullptr && b->handoff->init() && b->reclaim->init();
+	}
+	if (!valid) {
+		if (b->cmdBfr != nullptr) m_pool.freeBuffer(b->cmdBfr);
+		if (b->acquireBfr != nullptr) m_ownerPool->freeBuffer(b->acquireBfr);
+		if (b->reclaimBfr != nullptr) m_ownerPool->freeBuffer(b->reclaimBfr);
+		delete b->handoff;
+		delete b->reclaim;
+		delete b->fence;
+		delete b;
+		return nullptr;
+	}
+	return b;
+}
\ No newline at end of file
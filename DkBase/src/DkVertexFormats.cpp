@@ -0,0 +1,421 @@
+#include <cstring>
+#include "DkVertexFormats.h"
+
+#if defined(DK_MATH_SSE) && (defined(__F16C__) || (defined(_MSC_VER) && defined(DK_MATH_AVX2)))
+#define DK_VERTEX_F16C
+#endif
+
+using namespace math;
+
+namespace math {
+	static uint32_t floatBits(float f) {
+		uint32_t u;
+		memcpy(&u, &f, sizeof(u));
+		return u;
+	}
+
+	static float bitsFloat(uint32_t u) {
+		float f;
+		memcpy(&f, &u, sizeof(f));
+		return f;
+	}
+
+	uint16_t floatToHalf(float f) {
+		uint32_t u = floatBits(f);
+		uint32_t sign = u & 0x80000000u;
+		u ^= sign;
+
+		uint32_t h;
+		if (u >= 0x47800000u) {
+			// too large for a half, or already inf/NaN
+			h = u > 0x7f800000u ? 0x7e00u : 0x7c00u;
+		}
+		else if (u < 0x38800000u) {
+			// subnormal or zero: adding 0.5 lines the half's mantissa up with the
+			//	low float bits and lets the FPU do the rounding
+			h = floatBits(bitsFloat(u) + 0.5f) - 0x3f000000u;
+		}
+		else {
+			// rebias the exponent and round to nearest even on the dropped 13 bits
+			uint32_t mantOdd = (u >> 13) & 1u;
+			u += ((uint32_t)(15 - 127) << 23) + 0xfffu + mantOdd;
+			h = u >> 13;
+		}
+		return (uint16_t)(h | (sign >> 16));
+	}
+
+	float halfToFloat(uint16_t h) {
+		uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+		uint32_t exp = (h >> 10) & 0x1fu;
+		uint32_t mant = h & 0x3ffu;
+		if (exp == 0) {
+			float f = (float)mant * (1.f / 16777216.f);
+			return bitsFloat(floatBits(f) | sign);
+		}
+		if (exp == 31) {
+			return bitsFloat(sign | 0x7f800000u | (mant << 13));
+		}
+		return bitsFloat(sign | ((exp + 112) << 23) | (mant << 13));
+	}
+
+	static int32_t roundClamped(float f, float lo, float hi, float scale) {
+		f = f < lo ? lo : (f > hi ? hi : f);
+		return (int32_t)std::nearbyint(f * scale);
+	}
+
+	uint32_t packUnorm8(const vec<4>& v) {
+		uint32_t ret = 0;
+		for (uint iter = 0; iter < 4; ++iter) {
+			ret |= (uint32_t)roundClamped(v[iter], 0.f, 1.f, 255.f) << (8 * iter);
+		}
+		return ret;
+	}
+
+	vec<4> unpackUnorm8(uint32_t p) {
+		vec<4> ret;
+		for (uint iter = 0; iter < 4; ++iter) {
+			ret[iter] = (float)((p >> (8 * iter)) & 0xffu) / 255.f;
+		}
+		return ret;
+	}
+
+	uint32_t packSnorm10(const vec<4>& v) {
+		uint32_t ret = 0;
+		for (uint iter = 0; iter < 3; ++iter) {
+			ret |= ((uint32_t)roundClamped(v[iter], -1.f, 1.f, 511.f) & 0x3ffu) << (10 * iter);
+		}
+		ret |= ((uint32_t)roundClamped(v[3], -1.f, 1.f, 1.f) & 0x3u) << 30;
+		return ret;
+	}
+
+	vec<4> unpackSnorm10(uint32_t p) {
+		vec<4> ret;
+		for (uint iter = 0; iter < 3; ++iter) {
+			// sign-extend the 10-bit field
+			int32_t c = (int32_t)(p << (22 - 10 * iter)) >> 22;
+			ret[iter] = std::max((float)c / 511.f, -1.f);
+		}
+		ret[3] = std::max((float)((int32_t)p >> 30), -1.f);
+		return ret;
+	}
+
+	vec<2> octEncode(const vec<3>& n) {
+		float l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+		float inv = l1 > 0.f ? 1.f / l1 : 0.f;
+		float x = n[0] * inv;
+		float y = n[1] * inv;
+		if (n[2] < 0.f) {
+			// fold the lower hemisphere over the diagonals
+			float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+			float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+			x = fx;
+			y = fy;
+		}
+		vec<2> ret;
+		ret[0] = x;
+		ret[1] = y;
+		return ret;
+	}
+
+	vec<3> octDecode(const vec<2>& e) {
+		vec3 n(e[0], e[1], 1.f - std::abs(e[0]) - std::abs(e[1]));
+		float t = std::max(-n[2], 0.f);
+		n[0] += n[0] >= 0.f ? -t : t;
+		n[1] += n[1] >= 0.f ? -t : t;
+		return normalize(n);
+	}
+}
+
+uint getVertexStride(DkVertexFormat format) {
+	switch (format) {
+	case DK_VERTEX_FORMAT_PACKED:
+		return sizeof(DkVertexPacked);
+	case DK_VERTEX_FORMAT_OCT:
+		return sizeof(DkVertexOct);
+	default:
+		return sizeof(DkVertex);
+	}
+}
+
+// Shared by both packed layouts: half position and unorm8 color in front
+static void packPositionColor(const DkVertex& in, uint16_t* vert, uint32_t& color) {
+	for (uint iter = 0; iter < 4; ++iter) {
+		vert[iter] = floatToHalf(in.vert[iter]);
+	}
+	color = packUnorm8(in.color);
+}
+
+static void packOctNormal(const vec<4>& normal, int16_t* out) {
+	vec<2> e = octEncode(vec3(normal));
+	out[0] = (int16_t)roundClamped(e[0], -1.f, 1.f, 32767.f);
+	out[1] = (int16_t)roundClamped(e[1], -1.f, 1.f, 32767.f);
+}
+
+#ifdef DK_MATH_SSE
+// Four vertices at a time. Position halves come from F16C when available, one
+//	vertex per conversion; colors and normals are transposed to one register
+//	per component so each packed field is built with constant shifts.
+static inline __m128 clampPs(__m128 v, __m128 lo, __m128 hi) {
+	return _mm_min_ps(_mm_max_ps(v, lo), hi);
+}
+
+static inline __m128i packColors4(const DkVertex* in) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 scale = _mm_set1_ps(255.f);
+	__m128 r = _mm_loadu_ps(in[0].color.data());
+	__m128 g = _mm_loadu_ps(in[1].color.data());
+	__m128 b = _mm_loadu_ps(in[2].color.data());
+	__m128 a = _mm_loadu_ps(in[3].color.data());
+	_MM_TRANSPOSE4_PS(r, g, b, a);
+	__m128i ri = _mm_cvtps_epi32(_mm_mul_ps(clampPs(r, zero, one), scale));
+	__m128i gi = _mm_cvtps_epi32(_mm_mul_ps(clampPs(g, zero, one), scale));
+	__m128i bi = _mm_cvtps_epi32(_mm_mul_ps(clampPs(b, zero, one), scale));
+	__m128i ai = _mm_cvtps_epi32(_mm_mul_ps(clampPs(a, zero, one), scale));
+	return _mm_or_si128(_mm_or_si128(ri, _mm_slli_epi32(gi, 8)),
+		_mm_or_si128(_mm_slli_epi32(bi, 16), _mm_slli_epi32(ai, 24)));
+}
+
+static inline void packPositions4(const DkVertex* in, uint16_t* vert0, uint stride) {
+	char* dst = reinterpret_cast<char*>(vert0);
+	for (uint iter = 0; iter < 4; ++iter) {
+#ifdef DK_VERTEX_F16C
+		__m128i h = _mm_cvtps_ph(_mm_loadu_ps(in[iter].vert.data()), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + iter * stride), h);
+#else
+		uint16_t* vert = reinterpret_cast<uint16_t*>(dst + iter * stride);
+		for (uint c = 0; c < 4; ++c) {
+			vert[c] = floatToHalf(in[iter].vert[c]);
+		}
+#endif
+	}
+}
+#endif
+
+void packVertices(const DkVertex* in, DkVertexPacked* out, uint count) {
+	uint iter = 0;
+#ifdef DK_MATH_SSE
+	const __m128 negOne = _mm_set1_ps(-1.f);
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 scale = _mm_set1_ps(511.f);
+	const __m128i mask10 = _mm_set1_epi32(0x3ff);
+	const __m128i mask2 = _mm_set1_epi32(0x3);
+	for (; iter + 4 <= count; iter += 4) {
+		packPositions4(in + iter, out[iter].vert, (uint)sizeof(DkVertexPacked));
+
+		__m128 x = _mm_loadu_ps(in[iter].normal.data());
+		__m128 y = _mm_loadu_ps(in[iter + 1].normal.data());
+		__m128 z = _mm_loadu_ps(in[iter + 2].normal.data());
+		__m128 w = _mm_loadu_ps(in[iter + 3].normal.data());
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		__m128i xi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(clampPs(x, negOne, one), scale)), mask10);
+		__m128i yi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(clampPs(y, negOne, one), scale)), mask10);
+		__m128i zi = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(clampPs(z, negOne, one), scale)), mask10);
+		__m128i wi = _mm_and_si128(_mm_cvtps_epi32(clampPs(w, negOne, one)), mask2);
+		__m128i normals = _mm_or_si128(_mm_or_si128(xi, _mm_slli_epi32(yi, 10)),
+			_mm_or_si128(_mm_slli_epi32(zi, 20), _mm_slli_epi32(wi, 30)));
+
+		alignas(16) uint32_t colors[4];
+		alignas(16) uint32_t norms[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(colors), packColors4(in + iter));
+		_mm_store_si128(reinterpret_cast<__m128i*>(norms), normals);
+		for (uint v = 0; v < 4; ++v) {
+			out[iter + v].color = colors[v];
+			out[iter + v].normal = norms[v];
+		}
+	}
+#endif
+	for (; iter < count; ++iter) {
+		packPositionColor(in[iter], out[iter].vert, out[iter].color);
+		out[iter].normal = packSnorm10(in[iter].normal);
+	}
+}
+
+void packVertices(const DkVertex* in, DkVertexOct* out, uint count) {
+	uint iter = 0;
+#ifdef DK_MATH_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 negOne = _mm_set1_ps(-1.f);
+	const __m128 signMask = _mm_set1_ps(-0.f);
+	const __m128 scale = _mm_set1_ps(32767.f);
+	for (; iter + 4 <= count; iter += 4) {
+		packPositions4(in + iter, out[iter].vert, (uint)sizeof(DkVertexOct));
+
+		__m128 x = _mm_loadu_ps(in[iter].normal.data());
+		__m128 y = _mm_loadu_ps(in[iter + 1].normal.data());
+		__m128 z = _mm_loadu_ps(in[iter + 2].normal.data());
+		__m128 w = _mm_loadu_ps(in[iter + 3].normal.data());
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		__m128 l1 = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+		__m128 nonZero = _mm_cmpgt_ps(l1, zero);
+		__m128 inv = _mm_and_ps(nonZero, _mm_div_ps(one, l1));
+		__m128 px = _mm_mul_ps(x, inv);
+		__m128 py = _mm_mul_ps(y, inv);
+		// lower hemisphere: (1 - |p.yx|) * signNotZero(p.xy)
+		__m128 sx = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(px, zero), signMask), one);
+		__m128 sy = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(py, zero), signMask), one);
+		__m128 fx = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, py)), sx);
+		__m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, px)), sy);
+		__m128 lower = _mm_cmplt_ps(z, zero);
+		px = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, px));
+		py = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, py));
+
+		__m128i xi = _mm_cvtps_epi32(_mm_mul_ps(clampPs(px, negOne, one), scale));
+		__m128i yi = _mm_cvtps_epi32(_mm_mul_ps(clampPs(py, negOne, one), scale));
+		__m128i normals = _mm_or_si128(_mm_and_si128(xi, _mm_set1_epi32(0xffff)), _mm_slli_epi32(yi, 16));
+
+		alignas(16) uint32_t colors[4];
+		alignas(16) uint32_t norms[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(colors), packColors4(in + iter));
+		_mm_store_si128(reinterpret_cast<__m128i*>(norms), normals);
+		for (uint v = 0; v < 4; ++v) {
+			out[iter + v].color = colors[v];
+			memcpy(out[iter + v].normal, &norms[v], sizeof(norms[v]));
+		}
+	}
+#endif
+	for (; iter < count; ++iter) {
+		packPositionColor(in[iter], out[iter].vert, out[iter].color);
+		packOctNormal(in[iter].normal, out[iter].normal);
+	}
+}
+
+DkVertex unpackVertex(const DkVertexPacked& v) {
+	DkVertex ret;
+	for (uint iter = 0; iter < 4; ++iter) {
+		ret.vert[iter] = halfToFloat(v.vert[iter]);
+	}
+	ret.color = unpackUnorm8(v.color);
+	ret.normal = unpackSnorm10(v.normal);
+	return ret;
+}
+
+DkVertex unpackVertex(const DkVertexOct& v) {
+	DkVertex ret;
+	for (uint iter = 0; iter < 4; ++iter) {
+		ret.vert[iter] = halfToFloat(v.vert[iter]);
+	}
+	ret.color = unpackUnorm8(v.color);
+	vec<2> e;
+	e[0] = std::max((float)v.normal[0] / 32767.f, -1.f);
+	e[1] = std::max((float)v.normal[1] / 32767.f, -1.f);
+	ret.normal = vec4(octDecode(e));
+	ret.normal[3] = 0.f;
+	return ret;
+}
+
+VkIndexType getIndexType(uint vertexCount) {
+	// 16-bit indices reach vertex 65535; primitive restart is never enabled
+	return vertexCount <= 0x10000 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+uint getIndexStride(VkIndexType type) {
+	return type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+void packIndices(const uint* in, uint16_t* out, uint count) {
+	for (uint iter = 0; iter < count; ++iter) {
+		out[iter] = (uint16_t)in[iter];
+	}
+}
+
+DkVertexWelder::DkVertexWelder() :
+	m_lookup()
+{}
+
+size_t DkVertexWelder::vertexHash::operator()(const DkVertex& v) const {
+	// FNV-1a over the vertex's bytes
+	const unsigned char* bytes = (const unsigned char*)&v;
+	uint64_t hash = 14695981039346656037ull;
+	for (uint iter = 0; iter < sizeof(DkVertex); ++iter) {
+		hash = (hash ^ bytes[iter]) * 1099511628211ull;
+	}
+	return (size_t)hash;
+}
+
+bool DkVertexWelder::vertexEqual::operator()(const DkVertex& a, const DkVertex& b) const {
+	return memcmp(&a, &b, sizeof(DkVertex)) == 0;
+}
+
+void DkVertexWelder::weld(const DkVertex* in, uint count, std::vector<DkVertex>& verts, std::vector<uint>& indices) {
+	indices.reserve(indices.size() + count);
+	for (uint iter = 0; iter < count; ++iter) {
+		auto inserted = m_lookup.emplace(in[iter], (uint)verts.size());
+		if (inserted.second) {
+			verts.push_back(in[iter]);
+		}
+		indices.push_back(inserted.first->second);
+	}
+}
+
+void DkVertexWelder::clear() {
+	m_lookup.clear();
+}
+
+void DkVertexPacked::getPipelineCreateInfo(
+	uint bindingIndex,
+	std::vector<VkVertexInputBindingDescription>& bindingDescription,
+	std::vector<VkVertexInputAttributeDescription>& attributeDescriptions
+) {
+	bindingDescription.push_back({
+		bindingIndex,
+		sizeof(DkVertexPacked),
+		VK_VERTEX_INPUT_RATE_VERTEX
+	});
+
+	attributeDescriptions.push_back({
+		0,
+		bindingIndex,
+		VK_FORMAT_R16G16B16A16_SFLOAT,
+		offsetof(DkVertexPacked, vert)
+	});
+
+	attributeDescriptions.push_back({
+		1,
+		bindingIndex,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		offsetof(DkVertexPacked, color)
+	});
+
+	attributeDescriptions.push_back({
+		2,
+		bindingIndex,
+		VK_FORMAT_A2B10G10R10_SNORM_PACK32,
+		offsetof(DkVertexPacked, normal)
+	});
+}
+
+void DkVertexOct::getPipelineCreateInfo(
+	uint bindingIndex,
+	std::vector<VkVertexInputBindingDescription>& bindingDescription,
+	std::vector<VkVertexInputAttributeDescription>& attributeDescriptions
+) {
+	bindingDescription.push_back({
+		bindingIndex,
+		sizeof(DkVertexOct),
+		VK_VERTEX_INPUT_RATE_VERTEX
+	});
+
+	attributeDescriptions.push_back({
+		0,
+		bindingIndex,
+		VK_FORMAT_R16G16B16A16_SFLOAT,
+		offsetof(DkVertexOct, vert)
+	});
+
+	attributeDescriptions.push_back({
+		1,
+		bindingIndex,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		offsetof(DkVertexOct, color)
+	});
+
+	attributeDescriptions.push_back({
+		2,
+		bindingIndex,
+		VK_FORMAT_R16G16_SNORM,
+		offsetof(DkVertexOct, normal)
+	});
+}
\ No newline at end of file
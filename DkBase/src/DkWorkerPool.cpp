@@ -0,0 +1,107 @@
+#include "DkWorkerPool.h"
+
+DkWorkerPool::DkWorkerPool() :
+	m_threads(),
+	m_mutex(),
+	m_wake(),
+	m_done(),
+	m_task(nullptr),
+	m_taskCount(0),
+	m_next(0),
+	m_active(0),
+	m_generation(0),
+	m_stop(false)
+{}
+
+bool DkWorkerPool::init(uint threadCount) {
+	finalize();
+	m_stop = false;
+	for (uint iter = 0; iter < threadCount; ++iter) {
+		m_threads.emplace_back(&DkWorkerPool::_workerLoop, this);
+	}
+	return true;
+}
+
+void DkWorkerPool::finalize() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto& thread : m_threads) {
+		thread.join();
+	}
+	m_threads.clear();
+	m_task = nullptr;
+	m_taskCount = 0;
+}
+
+void DkWorkerPool::run(uint count, const std::function<void(uint)>& task) {
+	if (count == 0) return;
+	if (m_threads.empty() || count == 1) {
+		for (uint iter = 0; iter < count; ++iter) {
+			task(iter);
+		}
+		return;
+	}
+
+	{
+		// A worker late to wake for the previous run may still be leaving
+		//	_work; it must not see the new task half published
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return m_active == 0; });
+		m_task = &task;
+		m_taskCount = count;
+		m_next = 0;
+		++m_generation;
+	}
+	m_wake.notify_all();
+
+	_work();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this] { return m_active == 0; });
+	m_task = nullptr;
+	m_taskCount = 0;
+}
+
+void DkWorkerPool::_workerLoop() {
+	uint64 seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this, seen] { return m_stop || m_generation != seen; });
+			if (m_stop) return;
+			seen = m_generation;
+			++m_active;
+		}
+
+		_work();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_active;
+		}
+		m_done.notify_all();
+	}
+}
+
+void DkWorkerPool::_work() {
+	// Indices past the end mean the run is over; the caller and the workers
+	//	all leave through here
+	for (uint index = m_next++; index < m_taskCount; index = m_next++) {
+		(*m_task)(index);
+	}
+}
+
+void DkWorkerPool::split(uint total, uint parts, uint part, uint& first, uint& count) {
+	if (parts == 0 || part >= parts) {
+		first = total;
+		count = 0;
+		return;
+	}
+	uint base = total / parts;
+	uint extra = total % parts;
+	first = part * base + (part < extra ? part : extra);
+	count = base + (part < extra ? 1 : 0);
+}
\ No newline at end of file
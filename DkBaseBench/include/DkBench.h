@@ -0,0 +1,99 @@
+#ifndef DK_BENCH_H
+#define DK_BENCH_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "DkCommon.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Minimal benchmark harness for DkBase. Benchmarks register themselves with
+//	DK_BENCHMARK and are run by name, so adding one is a single function:
+//
+//		DK_BENCHMARK(math, mat4Mul, 1) {
+//			for (uint64 iter = 0; iter < iterations; ++iter) {
+//				bench::doNotOptimize(a[iter & mask] * b[iter & mask]);
+//			}
+//		}
+//
+//	Benchmarks are named group/name. Comparison baselines, e.g. glm, use their
+//	own group and the same name as the DkBase benchmark they mirror.
+
+namespace bench {
+	// Runs the measured operation iterations times
+	typedef void(*benchFn)(uint64 iterations);
+
+	struct benchmark {
+		std::string group;
+		std::string name;
+		benchFn fn;
+		uint64 itemsPerIteration;	// e.g. matrices per batched call; used for throughput
+	};
+
+	struct result {
+		std::string group;
+		std::string name;
+		uint64 iterations;			// iterations per repetition
+		double nsPerIteration;		// median over repetitions
+		double nsMin;
+		double nsMax;
+		double itemsPerSecond;
+	};
+
+	struct options {
+		std::string filter;			// substring of group/name; empty runs everything
+		double minTimeMs;			// minimum duration of one repetition
+		uint repetitions;
+	};
+
+	bool registerBenchmark(const char* group, const char* name, benchFn fn, uint64 itemsPerIteration);
+	const std::vector<benchmark>& getBenchmarks();
+
+	std::vector<result> runBenchmarks(const options& opts);
+	void printResults(const std::vector<result>& results, std::ostream& out);
+
+	// Writes results in the JSON layout of Google Benchmark (a context object and
+	//	a benchmarks array, times in ns) so its comparison tools can diff runs
+	void writeJson(const std::vector<result>& results, const options& opts, std::ostream& out);
+
+	// Keeps the compiler from discarding value, and the work that produced it,
+	//	without adding more than a store to the measured loop
+#ifdef _MSC_VER
+	extern volatile const char* g_sink;
+
+	template <typename T>
+	inline void doNotOptimize(const T& value) {
+		g_sink = &reinterpret_cast<const volatile char&>(value);
+		_ReadWriteBarrier();
+	}
+#else
+	template <typename T>
+	inline void doNotOptimize(const T& value) {
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+#endif
+
+	// Deterministic inputs so runs are comparable between builds
+	class random {
+	public:
+		explicit random(uint seed = 1) : m_state(seed) {}
+		// uniform in [lo, hi)
+		float next(float lo = -1.f, float hi = 1.f) {
+			m_state = m_state * 1664525u + 1013904223u;
+			return lo + (hi - lo) * (float)(m_state >> 8) * (1.f / 16777216.f);
+		}
+	private:
+		uint m_state;
+	};
+}
+
+#define DK_BENCHMARK(group, name, itemsPerIteration) \
+	static void dkBench_##group##_##name(uint64 iterations); \
+	static const bool dkBenchRegistered_##group##_##name = \
+		bench::registerBenchmark(#group, #name, dkBench_##group##_##name, itemsPerIteration); \
+	static void dkBench_##group##_##name(uint64 iterations)
+
+#endif//DK_BENCH_H
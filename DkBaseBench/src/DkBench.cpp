@@ -0,0 +1,166 @@
+#include "DkBench.h"
+#include "DkMath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+
+namespace bench {
+#ifdef _MSC_VER
+	volatile const char* g_sink = nullptr;
+#endif
+
+	static std::vector<benchmark>& registry() {
+		// function-local so registration from other translation units' static
+		//	initializers never sees it unconstructed
+		static std::vector<benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	bool registerBenchmark(const char* group, const char* name, benchFn fn, uint64 itemsPerIteration) {
+		registry().push_back({ group, name, fn, itemsPerIteration });
+		return true;
+	}
+
+	const std::vector<benchmark>& getBenchmarks() {
+		return registry();
+	}
+
+	static double timeRun(benchFn fn, uint64 iterations) {
+		auto start = std::chrono::steady_clock::now();
+		fn(iterations);
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	}
+
+	static result runBenchmark(const benchmark& b, const options& opts) {
+		const double minTimeNs = opts.minTimeMs * 1.e6;
+
+		// grow the iteration count until one run lasts minTime, aiming a little
+		//	past it so the final estimate does not land just short
+		uint64 iterations = 1;
+		double elapsed = timeRun(b.fn, iterations);
+		while (elapsed < minTimeNs && iterations < (1ull << 40)) {
+			double scale = elapsed > 0. ? 1.4 * minTimeNs / elapsed : 10.;
+			scale = std::max(2., std::min(scale, 10.));
+			iterations = (uint64)((double)iterations * scale);
+			elapsed = timeRun(b.fn, iterations);
+		}
+
+		std::vector<double> samples;
+		for (uint iter = 0; iter < std::max(opts.repetitions, 1u); ++iter) {
+			samples.push_back(timeRun(b.fn, iterations) / (double)iterations);
+		}
+		std::sort(samples.begin(), samples.end());
+
+		result r;
+		r.group = b.group;
+		r.name = b.name;
+		r.iterations = iterations;
+		r.nsPerIteration = samples[samples.size() / 2];
+		r.nsMin = samples.front();
+		r.nsMax = samples.back();
+		r.itemsPerSecond = r.nsPerIteration > 0. ? (double)b.itemsPerIteration * 1.e9 / r.nsPerIteration : 0.;
+		return r;
+	}
+
+	std::vector<result> runBenchmarks(const options& opts) {
+		std::vector<result> results;
+		for (const benchmark& b : registry()) {
+			std::string fullName = b.group + "/" + b.name;
+			if (!opts.filter.empty() && fullName.find(opts.filter) == std::string::npos) continue;
+			results.push_back(runBenchmark(b, opts));
+		}
+		return results;
+	}
+
+	void printResults(const std::vector<result>& results, std::ostream& out) {
+		out << std::left << std::setw(40) << "Benchmark"
+			<< std::right << std::setw(14) << "ns/iter"
+			<< std::setw(14) << "min"
+			<< std::setw(14) << "max"
+			<< std::setw(16) << "items/s" << std::endl;
+		out << std::string(98, '-') << std::endl;
+		for (const result& r : results) {
+			out << std::left << std::setw(40) << (r.group + "/" + r.name) << std::right << std::fixed << std::setprecision(2)
+				<< std::setw(14) << r.nsPerIteration
+				<< std::setw(14) << r.nsMin
+				<< std::setw(14) << r.nsMax
+				<< std::setw(16) << std::scientific << std::setprecision(3) << r.itemsPerSecond
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	static const char* simdLevel() {
+#if defined(DK_MATH_AVX512)
+		return "AVX-512";
+#elif defined(DK_MATH_AVX2)
+		return "AVX2";
+#elif defined(DK_MATH_AVX)
+		return "AVX";
+#elif defined(DK_MATH_SSE)
+		return "SSE2";
+#else
+		return "none";
+#endif
+	}
+
+	static std::string jsonString(const std::string& s) {
+		std::string ret = "\"";
+		for (char c : s) {
+			if (c == '"' || c == '\\') ret += '\\';
+			ret += c;
+		}
+		return ret + "\"";
+	}
+
+	void writeJson(const std::vector<result>& results, const options& opts, std::ostream& out) {
+		std::time_t now = std::time(nullptr);
+		std::tm utc;
+#ifdef _MSC_VER
+		gmtime_s(&utc, &now);
+#else
+		gmtime_r(&now, &utc);
+#endif
+		char date[32];
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+		out << "{" << std::endl;
+		out << "  \"context\": {" << std::endl;
+		out << "    \"date\": " << jsonString(date) << "," << std::endl;
+		out << "    \"library\": \"DkBase\"," << std::endl;
+#ifdef _DEBUG
+		out << "    \"library_build_type\": \"debug\"," << std::endl;
+#else
+		out << "    \"library_build_type\": \"release\"," << std::endl;
+#endif
+		out << "    \"simd\": " << jsonString(simdLevel()) << "," << std::endl;
+		out << "    \"checked_indexing\": " << (DK_MATH_CHECKED_INDEXING ? "true" : "false") << "," << std::endl;
+		out << "    \"pointer_bits\": " << sizeof(void*) * 8 << "," << std::endl;
+		out << "    \"min_time_ms\": " << opts.minTimeMs << "," << std::endl;
+		out << "    \"repetitions\": " << opts.repetitions << std::endl;
+		out << "  }," << std::endl;
+		out << "  \"benchmarks\": [" << std::endl;
+		out << std::setprecision(6);
+		for (uint iter = 0; iter < results.size(); ++iter) {
+			const result& r = results[iter];
+			out << "    {" << std::endl;
+			out << "      \"name\": " << jsonString(r.group + "/" + r.name) << "," << std::endl;
+			out << "      \"run_name\": " << jsonString(r.group + "/" + r.name) << "," << std::endl;
+			out << "      \"run_type\": \"iteration\"," << std::endl;
+			out << "      \"group\": " << jsonString(r.group) << "," << std::endl;
+			out << "      \"iterations\": " << r.iterations << "," << std::endl;
+			out << "      \"real_time\": " << r.nsPerIteration << "," << std::endl;
+			// only wall time is measured; cpu_time is repeated for the comparison tools
+			out << "      \"cpu_time\": " << r.nsPerIteration << "," << std::endl;
+			out << "      \"min_time\": " << r.nsMin << "," << std::endl;
+			out << "      \"max_time\": " << r.nsMax << "," << std::endl;
+			out << "      \"time_unit\": \"ns\"," << std::endl;
+			out << "      \"items_per_second\": " << r.itemsPerSecond << std::endl;
+			out << "    }" << (iter + 1 < results.size() ? "," : "") << std::endl;
+		}
+		out << "  ]" << std::endl;
+		out << "}" << std::endl;
+	}
+}
\ No newline at end of file
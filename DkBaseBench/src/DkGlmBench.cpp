@@ -0,0 +1,182 @@
+// glm counterparts of the DkMath benchmarks, under the same names in the glm
+//	group. Built only when DK_BENCH_GLM is defined and glm is on the include
+//	path (the Vulkan SDK ships it in $(VULKAN_SDK)\Include).
+#ifdef DK_BENCH_GLM
+
+#include "DkBench.h"
+
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+static const uint POOL_SIZE = 64;
+static const uint POOL_MASK = POOL_SIZE - 1;
+static const uint MESH_INSTANCES = 16;
+
+struct glmInputs {
+	glm::vec4 v4[POOL_SIZE];
+	glm::vec3 v3[POOL_SIZE];
+	glm::mat4 m4[POOL_SIZE];
+	glm::mat3 m3[POOL_SIZE];
+	glm::quat q[POOL_SIZE];
+	float angles[POOL_SIZE];
+
+	glmInputs() {
+		// same sequence as DkMathBench so both libraries see comparable values
+		bench::random rng;
+		for (uint iter = 0; iter < POOL_SIZE; ++iter) {
+			v4[iter] = glm::vec4(rng.next(), rng.next(), rng.next(), rng.next());
+			v3[iter] = glm::vec3(rng.next(), rng.next(), rng.next());
+			angles[iter] = rng.next(-180.f, 180.f);
+			glm::vec3 axis(rng.next(), rng.next(), rng.next(0.5f, 1.f));
+			glm::mat3 rot(glm::rotate(glm::mat4(1.f), glm::radians(angles[iter]), axis));
+			m3[iter] = rot * rng.next(0.5f, 2.f);
+			m4[iter] = glm::mat4(m3[iter]);
+			m4[iter][3] = glm::vec4(rng.next(-10.f, 10.f), rng.next(-10.f, 10.f), rng.next(-10.f, 10.f), 1.f);
+			m4[iter][0][3] = rng.next(-0.1f, 0.1f);
+			q[iter] = glm::angleAxis(glm::radians(angles[iter]), glm::normalize(glm::vec3(rng.next(), rng.next(), rng.next(0.5f, 1.f))));
+		}
+	}
+};
+
+static const glmInputs& inputs() {
+	static glmInputs in;
+	return in;
+}
+
+DK_BENCHMARK(glm, vec4Add, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.v4[iter & POOL_MASK] + in.v4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(glm, vec4Dot, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::dot(in.v4[iter & POOL_MASK], in.v4[(iter + 1) & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(glm, vec3Cross, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::cross(in.v3[iter & POOL_MASK], in.v3[(iter + 1) & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(glm, vec3Normalize, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::normalize(in.v3[iter & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(glm, mat4Add, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.m4[iter & POOL_MASK] + in.m4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(glm, mat4Mul, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.m4[iter & POOL_MASK] * in.m4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(glm, mat4MulVec4, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.m4[iter & POOL_MASK] * in.v4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(glm, mat4Transpose, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::transpose(in.m4[iter & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(glm, mat3Inverse, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::inverse(in.m3[iter & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(glm, mat4Inverse, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::inverse(in.m4[iter & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(glm, rotation, 1) {
+	const glmInputs& in = inputs();
+	const glm::mat4 ident(1.f);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::rotate(ident, glm::radians(in.angles[iter & POOL_MASK]), in.v3[(iter + 1) & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(glm, lookAt, 1) {
+	const glmInputs& in = inputs();
+	const glm::vec3 up(0.f, 1.f, 0.f);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::lookAt(in.v3[iter & POOL_MASK] * 10.f, in.v3[(iter + 1) & POOL_MASK], up));
+	}
+}
+
+DK_BENCHMARK(glm, perspective, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		float fovy = 60.f + in.angles[iter & POOL_MASK] * 0.1f;
+		bench::doNotOptimize(glm::perspective(glm::radians(fovy), 16.f / 9.f, 0.1f, 100.f));
+	}
+}
+
+DK_BENCHMARK(glm, quatMul, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.q[iter & POOL_MASK] * in.q[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(glm, quatSlerp, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::slerp(in.q[iter & POOL_MASK], in.q[(iter + 1) & POOL_MASK], 0.3f));
+	}
+}
+
+DK_BENCHMARK(glm, quatToMat4, 1) {
+	const glmInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(glm::mat4_cast(in.q[iter & POOL_MASK]));
+	}
+}
+
+// The usual glm formulation of DkMesh::pushMVP's preparation: full 4x4
+//	products and inverseTranspose for the normal matrices
+DK_BENCHMARK(glm, pushMVPPrep, MESH_INSTANCES) {
+	const glmInputs& in = inputs();
+	const glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+	glm::mat4 locMVPS[MESH_INSTANCES];
+	glm::mat4 locNormals[MESH_INSTANCES];
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		for (uint inst = 0; inst < MESH_INSTANCES; ++inst) {
+			const glm::mat4& mv = in.m4[inst];
+			locMVPS[inst] = proj * mv;
+			locNormals[inst] = glm::mat4(glm::inverseTranspose(glm::mat3(mv)));
+		}
+		bench::doNotOptimize(locMVPS[0]);
+		bench::doNotOptimize(locNormals[0]);
+	}
+}
+
+#endif//DK_BENCH_GLM
\ No newline at end of file
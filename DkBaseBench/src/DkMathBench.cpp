@@ -0,0 +1,280 @@
+#include "DkBench.h"
+#include "DkMath.h"
+#include "DkCulling.h"
+
+using namespace math;
+
+// Inputs are drawn from small pools indexed by the loop counter, so every
+//	iteration sees different values the compiler cannot fold away while the
+//	pools stay in L1
+static const uint POOL_SIZE = 64;
+static const uint POOL_MASK = POOL_SIZE - 1;
+static const uint BATCH_SIZE = 1024;
+
+struct mathInputs {
+	vec4 v4[POOL_SIZE];
+	vec3 v3[POOL_SIZE];
+	mat4 m4[POOL_SIZE];
+	mat3 m3[POOL_SIZE];
+	affine3x4 affine[POOL_SIZE];
+	quat q[POOL_SIZE];
+	float angles[POOL_SIZE];
+
+	std::vector<vec4> points;
+	std::vector<mat4> batchMats;
+
+	mathInputs() : points(BATCH_SIZE), batchMats(POOL_SIZE) {
+		bench::random rng;
+		for (uint iter = 0; iter < POOL_SIZE; ++iter) {
+			v4[iter] = vec4(rng.next(), rng.next(), rng.next(), rng.next());
+			v3[iter] = vec3(rng.next(), rng.next(), rng.next());
+			angles[iter] = rng.next(-180.f, 180.f);
+			// well-conditioned rigid transforms with a little scale
+			mat3 rot = rotation(angles[iter], vec3(rng.next(), rng.next(), rng.next(0.5f, 1.f)));
+			m3[iter] = rot * rng.next(0.5f, 2.f);
+			affine[iter] = affine3x4(m3[iter], vec3(rng.next(-10.f, 10.f), rng.next(-10.f, 10.f), rng.next(-10.f, 10.f)));
+			m4[iter] = toMat4(affine[iter]);
+			m4[iter](3, 0) = rng.next(-0.1f, 0.1f);	// keep the general 4x4 path honest
+			q[iter] = axisAngle(angles[iter], vec3(rng.next(), rng.next(), rng.next(0.5f, 1.f)));
+			batchMats[iter] = m4[iter];
+		}
+		for (uint iter = 0; iter < BATCH_SIZE; ++iter) {
+			points[iter] = vec4(rng.next(-10.f, 10.f), rng.next(-10.f, 10.f), rng.next(-10.f, 10.f), 1.f);
+		}
+	}
+};
+
+static const mathInputs& inputs() {
+	static mathInputs in;
+	return in;
+}
+
+// VECTOR ===============================================
+
+DK_BENCHMARK(math, vec4Add, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.v4[iter & POOL_MASK] + in.v4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(math, vec4Dot, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(dot(in.v4[iter & POOL_MASK], in.v4[(iter + 1) & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(math, vec3Cross, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(cross(in.v3[iter & POOL_MASK], in.v3[(iter + 1) & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(math, vec3Normalize, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(normalize(in.v3[iter & POOL_MASK]));
+	}
+}
+
+// MATRIX ===============================================
+
+DK_BENCHMARK(math, mat4Add, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.m4[iter & POOL_MASK] + in.m4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(math, mat4Mul, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.m4[iter & POOL_MASK] * in.m4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(math, mat4MulVec4, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.m4[iter & POOL_MASK] * in.v4[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(math, mat4Transpose, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(transpose(in.m4[iter & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(math, mat3Inverse, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(inverse(in.m3[iter & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(math, mat4Inverse, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(inverse(in.m4[iter & POOL_MASK]));
+	}
+}
+
+// SPECIAL ==============================================
+
+DK_BENCHMARK(math, rotation, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(rotation(in.angles[iter & POOL_MASK], in.v3[(iter + 1) & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(math, lookAt, 1) {
+	const mathInputs& in = inputs();
+	const vec3 up(0.f, 1.f, 0.f);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(lookAt(in.v3[iter & POOL_MASK] * 10.f, in.v3[(iter + 1) & POOL_MASK], up));
+	}
+}
+
+DK_BENCHMARK(math, perspective, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		float fovy = 60.f + in.angles[iter & POOL_MASK] * 0.1f;
+		bench::doNotOptimize(perspective(fovy, 16.f / 9.f, 0.1f, 100.f));
+	}
+}
+
+// AFFINE TRANSFORMS ====================================
+
+DK_BENCHMARK(math, affineMul, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.affine[iter & POOL_MASK] * in.affine[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(math, affineInverse, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(inverse(in.affine[iter & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(math, normalMatrix, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(normalMatrix(in.affine[iter & POOL_MASK]));
+	}
+}
+
+// GPU LAYOUT ===========================================
+
+// the upload path before gpuMat4, kept as a baseline for mulToGpu
+DK_BENCHMARK(math, transposedProduct, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(transpose(in.m4[iter & POOL_MASK] * in.affine[(iter + 1) & POOL_MASK]));
+	}
+}
+
+DK_BENCHMARK(math, mulToGpu, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(mulToGpu(in.m4[iter & POOL_MASK], in.affine[(iter + 1) & POOL_MASK]));
+	}
+}
+
+// QUATERNIONS ==========================================
+
+DK_BENCHMARK(math, quatMul, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(in.q[iter & POOL_MASK] * in.q[(iter + 1) & POOL_MASK]);
+	}
+}
+
+DK_BENCHMARK(math, quatSlerp, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(slerp(in.q[iter & POOL_MASK], in.q[(iter + 1) & POOL_MASK], 0.3f));
+	}
+}
+
+DK_BENCHMARK(math, quatToMat4, 1) {
+	const mathInputs& in = inputs();
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(toMat4(in.q[iter & POOL_MASK]));
+	}
+}
+
+// BATCHED ==============================================
+
+DK_BENCHMARK(math, transformPoints, BATCH_SIZE) {
+	const mathInputs& in = inputs();
+	std::vector<vec4> out(BATCH_SIZE);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		transformPoints(in.m4[iter & POOL_MASK], in.points.data(), out.data(), BATCH_SIZE);
+		bench::doNotOptimize(out[0]);
+	}
+}
+
+DK_BENCHMARK(math, invertMatrices, POOL_SIZE) {
+	const mathInputs& in = inputs();
+	std::vector<mat4> out(POOL_SIZE);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(invertMatrices(in.batchMats.data(), out.data(), POOL_SIZE));
+		bench::doNotOptimize(out[0]);
+	}
+}
+
+DK_BENCHMARK(math, slerpQuats, POOL_SIZE) {
+	const mathInputs& in = inputs();
+	quat out[POOL_SIZE];
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		slerpQuats(in.q, in.q + 1, 0.3f, out, POOL_SIZE - 1);
+		bench::doNotOptimize(out[0]);
+	}
+}
+
+// CULLING ==============================================
+
+DK_BENCHMARK(culling, spheres, BATCH_SIZE) {
+	const mathInputs& in = inputs();
+	frustum f = extractFrustum(perspective(60.f, 16.f / 9.f, 0.1f, 100.f) *
+		lookAt(vec3(0.f, 0.f, 20.f), vec3(0.f), vec3(0.f, 1.f, 0.f)));
+	std::vector<float> x(BATCH_SIZE), y(BATCH_SIZE), z(BATCH_SIZE), r(BATCH_SIZE);
+	for (uint iter = 0; iter < BATCH_SIZE; ++iter) {
+		x[iter] = in.points[iter][0] * 3.f;
+		y[iter] = in.points[iter][1] * 3.f;
+		z[iter] = in.points[iter][2] * 3.f;
+		r[iter] = 1.f;
+	}
+	sphereSoA spheres = { x.data(), y.data(), z.data(), r.data() };
+	std::vector<uint> visible(BATCH_SIZE);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(cullSpheres(f, spheres, BATCH_SIZE, visible.data()));
+	}
+}
+
+DK_BENCHMARK(culling, aabbs, BATCH_SIZE) {
+	const mathInputs& in = inputs();
+	frustum f = extractFrustum(perspective(60.f, 16.f / 9.f, 0.1f, 100.f) *
+		lookAt(vec3(0.f, 0.f, 20.f), vec3(0.f), vec3(0.f, 1.f, 0.f)));
+	std::vector<float> bounds[6];
+	for (uint c = 0; c < 6; ++c) bounds[c].resize(BATCH_SIZE);
+	for (uint iter = 0; iter < BATCH_SIZE; ++iter) {
+		for (uint c = 0; c < 3; ++c) {
+			bounds[c][iter] = in.points[iter][c] * 3.f - 1.f;
+			bounds[c + 3][iter] = in.points[iter][c] * 3.f + 1.f;
+		}
+	}
+	aabbSoA boxes = { bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), bounds[4].data(), bounds[5].data() };
+	std::vector<uint> visible(BATCH_SIZE);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		bench::doNotOptimize(cullAABBs(f, boxes, BATCH_SIZE, visible.data()));
+	}
+}
\ No newline at end of file
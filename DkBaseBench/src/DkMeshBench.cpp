@@ -0,0 +1,114 @@
+#include "DkBench.h"
+#include "DkMesh.h"
+
+using namespace math;
+
+// CPU side of DkMesh: the per-frame matrix preparation done by pushMVP and the
+//	interleaving of vertex streams into DkVertex. Neither touches the device,
+//	so they are measured here without one.
+
+static const uint VERT_COUNT = 4096;
+
+struct meshInputs {
+	affine3x4 mv[MAX_MESH_INSTANCES];
+	mat4 proj[MAX_MESH_INSTANCES];
+	std::vector<vec3> positions;
+	std::vector<vec3> normals;
+	std::vector<vec4> colors;
+
+	meshInputs() : positions(VERT_COUNT), normals(VERT_COUNT), colors(VERT_COUNT) {
+		bench::random rng(7);
+		mat4 persp = perspective(45.f, 16.f / 9.f, 0.1f, 100.f);
+		for (uint iter = 0; iter < MAX_MESH_INSTANCES; ++iter) {
+			mat3 rot = rotation(rng.next(-180.f, 180.f), vec3(rng.next(), rng.next(), 1.f));
+			mv[iter] = affine3x4(lookAt(vec3(0.f, 2.f, 8.f), vec3(0.f), vec3(0.f, 1.f, 0.f))) *
+				affine3x4(rot, vec3(rng.next(-3.f, 3.f), rng.next(-3.f, 3.f), rng.next(-3.f, 3.f)));
+			proj[iter] = persp;
+		}
+		for (uint iter = 0; iter < VERT_COUNT; ++iter) {
+			positions[iter] = vec3(rng.next(), rng.next(), rng.next());
+			normals[iter] = normalize(vec3(rng.next(), rng.next(), rng.next(0.1f, 1.f)));
+			colors[iter] = vec4(rng.next(0.f, 1.f), rng.next(0.f, 1.f), rng.next(0.f, 1.f), 1.f);
+		}
+	}
+};
+
+static const meshInputs& inputs() {
+	static meshInputs in;
+	return in;
+}
+
+// Mirrors DkMesh::pushMVP up to the buffer upload: one MVP and one std140 mat4
+//	normal matrix per instance
+DK_BENCHMARK(mesh, pushMVPPrep, MAX_MESH_INSTANCES) {
+	const meshInputs& in = inputs();
+	std::vector<gpuMat4> locMVPS(MAX_MESH_INSTANCES);
+	std::vector<float> locNormals(MAX_MESH_INSTANCES * 16, 0.f);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		mulToGpu(in.proj, in.mv, locMVPS.data(), MAX_MESH_INSTANCES);
+		normalMatrices(in.mv, locNormals.data(), (uint)sizeof(mat4), MAX_MESH_INSTANCES);
+		bench::doNotOptimize(locMVPS[0]);
+		bench::doNotOptimize(locNormals[0]);
+	}
+}
+
+// Interleaving separate position, color and normal streams into the vertex
+//	layout uploaded by DkMesh::initVertBuffer
+DK_BENCHMARK(mesh, vertexPacking, VERT_COUNT) {
+	const meshInputs& in = inputs();
+	std::vector<DkVertex> verts(VERT_COUNT);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		for (uint v = 0; v < VERT_COUNT; ++v) {
+			verts[v].vert = in.positions[v];
+			verts[v].color = in.colors[v];
+			verts[v].normal = vec4(in.normals[v][0], in.normals[v][1], in.normals[v][2], 0.f);
+		}
+		bench::doNotOptimize(verts[0]);
+	}
+}
+
+// CPU skinning-style transform of the positions inside an interleaved DkVertex array
+DK_BENCHMARK(mesh, transformVertices, VERT_COUNT) {
+	const meshInputs& in = inputs();
+	std::vector<DkVertex> verts(VERT_COUNT);
+	for (uint v = 0; v < VERT_COUNT; ++v) {
+		verts[v].vert = in.positions[v];
+	}
+	std::vector<DkVertex> out(VERT_COUNT);
+	mat4 mvp = in.proj[0] * in.mv[0];
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		transformPoints(mvp, verts[0].vert.data(), (uint)sizeof(DkVertex), out[0].vert.data(), (uint)sizeof(DkVertex), VERT_COUNT);
+		bench::doNotOptimize(out[0]);
+	}
+}
+
+static std::vector<DkVertex> fullVertices() {
+	const meshInputs& in = inputs();
+	std::vector<DkVertex> verts(VERT_COUNT);
+	for (uint v = 0; v < VERT_COUNT; ++v) {
+		verts[v].vert = in.positions[v];
+		verts[v].color = in.colors[v];
+		verts[v].normal = vec4(in.normals[v][0], in.normals[v][1], in.normals[v][2], 0.f);
+	}
+	return verts;
+}
+
+// Compression done by DkMesh::initVertBuffer for DK_VERTEX_FORMAT_PACKED: 48 to 16 bytes
+DK_BENCHMARK(mesh, packVerticesPacked, VERT_COUNT) {
+	std::vector<DkVertex> verts = fullVertices();
+	std::vector<DkVertexPacked> out(VERT_COUNT);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		packVertices(verts.data(), out.data(), VERT_COUNT);
+		bench::doNotOptimize(out[0]);
+	}
+}
+
+// As above for DK_VERTEX_FORMAT_OCT
+DK_BENCHMARK(mesh, packVerticesOct, VERT_COUNT) {
+	std::vector<DkVertex> verts = fullVertices();
+	std::vector<DkVertexOct> out(VERT_COUNT);
+	for (uint64 iter = 0; iter < iterations; ++iter) {
+		packVertices(verts.data(), out.data(), VERT_COUNT);
+		bench::doNotOptimize(out[0]);
+	}
+}
\ No newline at end of file
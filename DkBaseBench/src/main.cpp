@@ -0,0 +1,59 @@
+#define MAIN_SRC
+#include "DkCommon.h"
+#include "DkBench.h"
+
+#include <cstdlib>
+#include <fstream>
+
+static bool parseArg(const std::string& arg, const char* flag, std::string& value) {
+	std::string prefix = std::string(flag) + "=";
+	if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+	value = arg.substr(prefix.size());
+	return true;
+}
+
+// DkBaseBench [--filter=<substring>] [--json=<file>|-] [--min_time=<ms>] [--repetitions=<n>] [--list]
+int main(int argc, char** argv) {
+	bench::options opts;
+	opts.minTimeMs = 50.;
+	opts.repetitions = 5;
+	std::string jsonPath;
+
+	for (int iter = 1; iter < argc; ++iter) {
+		std::string arg = argv[iter];
+		std::string value;
+		if (arg == "--list") {
+			for (const bench::benchmark& b : bench::getBenchmarks()) {
+				std::cout << b.group << "/" << b.name << std::endl;
+			}
+			return 0;
+		}
+		else if (parseArg(arg, "--filter", value)) opts.filter = value;
+		else if (parseArg(arg, "--json", value)) jsonPath = value;
+		else if (parseArg(arg, "--min_time", value)) opts.minTimeMs = std::atof(value.c_str());
+		else if (parseArg(arg, "--repetitions", value)) opts.repetitions = (uint)std::atoi(value.c_str());
+		else {
+			std::cout << "Unknown argument " << arg << std::endl;
+			std::cout << "Usage: DkBaseBench [--filter=<substring>] [--json=<file>|-] [--min_time=<ms>] [--repetitions=<n>] [--list]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<bench::result> results = bench::runBenchmarks(opts);
+
+	if (jsonPath == "-") {
+		bench::writeJson(results, opts, std::cout);
+		return 0;
+	}
+
+	bench::printResults(results, std::cout);
+	if (!jsonPath.empty()) {
+		std::ofstream out(jsonPath);
+		if (!out) {
+			std::cout << "Failed to open " << jsonPath << " for writing." << std::endl;
+			return 1;
+		}
+		bench::writeJson(results, opts, out);
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "pch.h"
+
+#include "DkBarrierBatch.h"
+
+template<typename T>
+static T _handle(uint64 value) {
+	return (T)(uintptr_t)value;
+}
+
+static VkBufferMemoryBarrier _bufferBarrier(VkBuffer bfr, VkAccessFlags src, VkAccessFlags dst, uint srcQF = VK_QUEUE_FAMILY_IGNORED, uint dstQF = VK_QUEUE_FAMILY_IGNORED) {
+	return { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr, src, dst, srcQF, dstQF, bfr, 0, VK_WHOLE_SIZE };
+}
+
+static VkImageMemoryBarrier _imageBarrier(VkImage img, VkImageLayout oldLayout, VkImageLayout newLayout, uint baseMip = 0, uint mips = VK_REMAINING_MIP_LEVELS) {
+	return {
+		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr, 0, 0, oldLayout, newLayout,
+		VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, img,
+		{ VK_IMAGE_ASPECT_COLOR_BIT, baseMip, mips, 0, VK_REMAINING_ARRAY_LAYERS }
+	};
+}
+
+TEST(DkBarrierBatchTests, mergesUploads) {
+	// hundreds of uploads: one barrier before and one after per buffer
+	DkBarrierBatch before, after;
+	for (uint iter = 1; iter <= 300; ++iter) {
+		VkBuffer bfr = _handle<VkBuffer>(iter);
+		ASSERT_TRUE(before.addBuffer(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			_bufferBarrier(bfr, 0, VK_ACCESS_TRANSFER_WRITE_BIT)));
+		ASSERT_TRUE(after.addBuffer(VK_PIPELINE_STAGE_TRANSFER_BIT, iter % 2 ? VK_PIPELINE_STAGE_VERTEX_INPUT_BIT : VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+			_bufferBarrier(bfr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT)));
+	}
+	ASSERT_EQ(300u, before.getAddedCount());
+	ASSERT_EQ(300u, before.getBufferBarriers().size());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, before.getSrcStages());
+	ASSERT_EQ((VkPipelineStageFlags)(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT), after.getDstStages());
+
+	// the same buffer twice folds into one element
+	VkBuffer bfr = _handle<VkBuffer>(1);
+	ASSERT_TRUE(after.addBuffer(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		_bufferBarrier(bfr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT)));
+	ASSERT_EQ(300u, after.getBufferBarriers().size());
+	ASSERT_EQ((VkAccessFlags)(VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT), after.getBufferBarriers()[0].dstAccessMask);
+
+	after.clear();
+	ASSERT_TRUE(after.isEmpty());
+	ASSERT_EQ(0u, after.getBufferBarriers().size());
+	ASSERT_EQ(0u, after.getSrcStages());
+}
+
+TEST(DkBarrierBatchTests, globalsAndFlags) {
+	DkBarrierBatch batch;
+	ASSERT_TRUE(batch.addGlobal(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_DEPENDENCY_BY_REGION_BIT));
+	ASSERT_EQ((VkDependencyFlags)VK_DEPENDENCY_BY_REGION_BIT, batch.getDependencyFlags());
+	ASSERT_TRUE(batch.addGlobal(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+	ASSERT_EQ(1u, batch.getMemoryBarriers().size());
+	ASSERT_EQ((VkAccessFlags)(VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT), batch.getMemoryBarriers()[0].srcAccessMask);
+	// by-region weakens the dependency; it only survives if every barrier asked
+	ASSERT_EQ(0u, batch.getDependencyFlags());
+}
+
+TEST(DkBarrierBatchTests, imageLayoutChains) {
+	DkBarrierBatch batch;
+	VkImage img = _handle<VkImage>(7);
+	ASSERT_TRUE(batch.addImage(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		_imageBarrier(img, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)));
+	ASSERT_TRUE(batch.addImage(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		_imageBarrier(img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)));
+	ASSERT_EQ(1u, batch.getImageBarriers().size());
+	ASSERT_EQ(VK_IMAGE_LAYOUT_UNDEFINED, batch.getImageBarriers()[0].oldLayout);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, batch.getImageBarriers()[0].newLayout);
+
+	// doesn't continue from the queued layout
+	ASSERT_FALSE(batch.addImage(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		_imageBarrier(img, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)));
+	// partial overlap with the queued range
+	ASSERT_FALSE(batch.addImage(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		_imageBarrier(img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 2, 1)));
+	ASSERT_EQ(2u, batch.getAddedCount());
+
+	// disjoint mip ranges of another image sit side by side
+	VkImage other = _handle<VkImage>(8);
+	ASSERT_TRUE(batch.addImage(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		_imageBarrier(other, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, 1)));
+	ASSERT_TRUE(batch.addImage(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		_imageBarrier(other, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, 1)));
+	ASSERT_EQ(3u, batch.getImageBarriers().size());
+}
+
+TEST(DkBarrierBatchTests, queueTransfers) {
+	DkBarrierBatch batch;
+	VkBuffer bfr = _handle<VkBuffer>(1);
+	ASSERT_TRUE(batch.addBuffer(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		_bufferBarrier(bfr, VK_ACCESS_TRANSFER_WRITE_BIT, 0, 1, 0)));
+	// a second transfer not starting where the first ended
+	ASSERT_FALSE(batch.addBuffer(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		_bufferBarrier(bfr, VK_ACCESS_TRANSFER_WRITE_BIT, 0, 2, 0)));
+	// one without a transfer folds in and keeps it
+	ASSERT_TRUE(batch.addBuffer(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		_bufferBarrier(bfr, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT)));
+	ASSERT_EQ(1u, batch.getBufferBarriers().size());
+	ASSERT_EQ(1u, batch.getBufferBarriers()[0].srcQueueFamilyIndex);
+	ASSERT_EQ(0u, batch.getBufferBarriers()[0].dstQueueFamilyIndex);
+}
+
+TEST(DkBarrierBatchTests, transferKeepsLayouts) {
+	DkBarrierBatch batch;
+	VkImage img = _handle<VkImage>(9);
+	VkImageMemoryBarrier acquire = _imageBarrier(img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	acquire.srcQueueFamilyIndex = 1;
+	acquire.dstQueueFamilyIndex = 0;
+	ASSERT_TRUE(batch.addImage(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, acquire));
+	// a further layout change has to wait for the next batch
+	ASSERT_FALSE(batch.addImage(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		_imageBarrier(img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)));
+	// more access in the same layout is fine
+	ASSERT_TRUE(batch.addImage(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+		_imageBarrier(img, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)));
+	ASSERT_EQ(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, batch.getImageBarriers()[0].oldLayout);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, batch.getImageBarriers()[0].newLayout);
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "pch.h"
+
+#include "DkCommandStateCache.h"
+
+// Non-dispatchable handles are only compared, never used
+template<typename T>
+static T _handle(uint64 value) {
+	return (T)(uintptr_t)value;
+}
+
+TEST(DkCommandStateCacheTests, bindsAndSkips) {
+	DkCommandStateCache cache;
+	VkPipeline pipeA = _handle<VkPipeline>(1), pipeB = _handle<VkPipeline>(2);
+	ASSERT_TRUE(cache.setPipeline(pipeA));
+	ASSERT_FALSE(cache.setPipeline(pipeA));
+	ASSERT_TRUE(cache.setPipeline(pipeB));
+
+	VkBuffer bfr = _handle<VkBuffer>(3);
+	ASSERT_TRUE(cache.setVertexBuffer(0, bfr, 0));
+	ASSERT_FALSE(cache.setVertexBuffer(0, bfr, 0));
+	ASSERT_TRUE(cache.setVertexBuffer(0, bfr, 64));
+	ASSERT_TRUE(cache.setVertexBuffer(1, bfr, 64));
+	ASSERT_TRUE(cache.setIndexBuffer(bfr, 0, VK_INDEX_TYPE_UINT16));
+	ASSERT_TRUE(cache.setIndexBuffer(bfr, 0, VK_INDEX_TYPE_UINT32));
+	ASSERT_FALSE(cache.setIndexBuffer(bfr, 0, VK_INDEX_TYPE_UINT32));
+
+	VkPipelineLayout layoutA = _handle<VkPipelineLayout>(4), layoutB = _handle<VkPipelineLayout>(5);
+	VkDescriptorSet set = _handle<VkDescriptorSet>(6);
+	ASSERT_TRUE(cache.setDescriptorSet(layoutA, 0, set, { 0 }));
+	ASSERT_FALSE(cache.setDescriptorSet(layoutA, 0, set, { 0 }));
+	ASSERT_TRUE(cache.setDescriptorSet(layoutA, 0, set, { 256 }));
+	ASSERT_TRUE(cache.setDescriptorSet(layoutB, 0, set, { 256 }));
+	ASSERT_EQ(4u, cache.getSkippedCount());
+
+	cache.invalidate();
+	ASSERT_TRUE(cache.setPipeline(pipeB));
+	ASSERT_TRUE(cache.setVertexBuffer(1, bfr, 64));
+	ASSERT_EQ(4u, cache.getSkippedCount());
+	cache.resetSkippedCount();
+	ASSERT_EQ(0u, cache.getSkippedCount());
+}
+
+TEST(DkCommandStateCacheTests, viewportsAndScissors) {
+	DkCommandStateCache cache;
+	VkViewport full = { 0.f, 0.f, 1080.f, 1080.f, 0.f, 1.f };
+	VkViewport half = { 0.f, 0.f, 540.f, 1080.f, 0.f, 1.f };
+	ASSERT_TRUE(cache.setViewports(0, { full }));
+	ASSERT_FALSE(cache.setViewports(0, { full }));
+	ASSERT_TRUE(cache.setViewports(0, { half }));
+	// partly known range
+	ASSERT_TRUE(cache.setViewports(0, { half, full }));
+	ASSERT_FALSE(cache.setViewports(1, { full }));
+
+	VkRect2D rect = { { 0, 0 }, { 1080, 1080 } };
+	ASSERT_TRUE(cache.setScissors(0, { rect }));
+	ASSERT_FALSE(cache.setScissors(0, { rect }));
+	rect.extent.width = 100;
+	ASSERT_TRUE(cache.setScissors(0, { rect }));
+}
+
+TEST(DkCommandStateCacheTests, pushConstants) {
+	DkCommandStateCache cache;
+	VkPipelineLayout layoutA = _handle<VkPipelineLayout>(1), layoutB = _handle<VkPipelineLayout>(2);
+	float mat[16] = {};
+	ASSERT_TRUE(cache.setPushConstants(layoutA, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat), mat));
+	ASSERT_FALSE(cache.setPushConstants(layoutA, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat), mat));
+	// a sub-range of what was pushed is known too
+	ASSERT_FALSE(cache.setPushConstants(layoutA, VK_SHADER_STAGE_VERTEX_BIT, 16, 16, mat));
+
+	mat[5] = 1.f;
+	ASSERT_TRUE(cache.setPushConstants(layoutA, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat), mat));
+	ASSERT_TRUE(cache.setPushConstants(layoutA, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(mat), mat));
+	ASSERT_TRUE(cache.setPushConstants(layoutB, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(mat), mat));
+	// bytes never pushed are unknown, even if they match the zeroed shadow
+	float zero[4] = {};
+	ASSERT_TRUE(cache.setPushConstants(layoutB, VK_SHADER_STAGE_VERTEX_BIT, 128, sizeof(zero), zero));
+	// beyond the shadow: always recorded
+	std::vector<uint8_t> big(DK_MAX_CACHED_PUSH_CONSTANT_BYTES + 4, 0);
+	ASSERT_TRUE(cache.setPushConstants(layoutB, VK_SHADER_STAGE_VERTEX_BIT, 0, (uint)big.size(), big.data()));
+	ASSERT_TRUE(cache.setPushConstants(layoutB, VK_SHADER_STAGE_VERTEX_BIT, 0, (uint)big.size(), big.data()));
+}
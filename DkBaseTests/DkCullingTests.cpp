@@ -0,0 +1,86 @@
+#include "pch.h"
+
+#pragma warning(disable : 4244)
+#include "DkCulling.h"
+
+using namespace math;
+
+static frustum testFrustum() {
+	// camera at the origin looking down -z, 90 degree field of view, depth 1..100
+	mat4 viewProj = perspective(90.f, 1.f, 1.f, 100.f) * lookAt(vec3(0.f), vec3(0.f, 0.f, -1.f), vec3(0.f, 1.f, 0.f));
+	return extractFrustum(viewProj);
+}
+
+TEST(DkCullingTests, planeExtraction) {
+	frustum f = testFrustum();
+	for (uint i = 0; i < FRUSTUM_PLANE_COUNT; ++i) {
+		const vec<4>& p = f.planes[i];
+		ASSERT_NEAR(1.f, sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]), 1.e-5f);
+	}
+	// near and far planes are 1 and 100 units down -z
+	ASSERT_NEAR(-1.f, f.planes[FRUSTUM_NEAR][2], 1.e-5f);
+	ASSERT_NEAR(-1.f, f.planes[FRUSTUM_NEAR][3], 1.e-4f);
+	ASSERT_NEAR(1.f, f.planes[FRUSTUM_FAR][2], 1.e-5f);
+	ASSERT_NEAR(100.f, f.planes[FRUSTUM_FAR][3], 1.e-2f);
+}
+
+TEST(DkCullingTests, singleVolumes) {
+	frustum f = testFrustum();
+	ASSERT_TRUE(isSphereVisible(f, vec3(0.f, 0.f, -10.f), 1.f));
+	ASSERT_FALSE(isSphereVisible(f, vec3(0.f, 0.f, 10.f), 1.f));		// behind
+	ASSERT_FALSE(isSphereVisible(f, vec3(0.f, 0.f, -200.f), 1.f));		// beyond far
+	ASSERT_FALSE(isSphereVisible(f, vec3(-30.f, 0.f, -10.f), 1.f));	// left
+	ASSERT_TRUE(isSphereVisible(f, vec3(-10.5f, 0.f, -10.f), 1.f));	// straddles left
+	ASSERT_TRUE(isSphereVisible(f, vec3(0.f, 0.f, -0.5f), 1.f));		// straddles near
+
+	ASSERT_TRUE(isAABBVisible(f, vec3(-1.f, -1.f, -11.f), vec3(1.f, 1.f, -9.f)));
+	ASSERT_FALSE(isAABBVisible(f, vec3(-1.f, -1.f, 9.f), vec3(1.f, 1.f, 11.f)));
+	ASSERT_FALSE(isAABBVisible(f, vec3(-1.f, 20.f, -11.f), vec3(1.f, 22.f, -9.f)));
+	ASSERT_TRUE(isAABBVisible(f, vec3(-50.f, -50.f, -60.f), vec3(50.f, 50.f, 10.f)));	// contains the frustum tip
+}
+
+TEST(DkCullingTests, batchMatchesScalar) {
+	frustum f = testFrustum();
+	const uint count = 61;
+	std::vector<float> x(count), y(count), z(count), r(count);
+	std::vector<float> minX(count), minY(count), minZ(count), maxX(count), maxY(count), maxZ(count);
+	for (uint i = 0; i < count; ++i) {
+		x[i] = (float)((int)(i * 37 % 41) - 20);
+		y[i] = (float)((int)(i * 13 % 29) - 14);
+		z[i] = -(float)(i * 7 % 130) + 10.f;
+		r[i] = 0.5f + (float)(i % 5);
+		minX[i] = x[i] - r[i];
+		minY[i] = y[i] - 0.5f * r[i];
+		minZ[i] = z[i] - r[i];
+		maxX[i] = x[i] + r[i];
+		maxY[i] = y[i] + 0.5f * r[i];
+		maxZ[i] = z[i] + 2.f * r[i];
+	}
+
+	std::vector<uint> visible(count);
+	std::vector<uint> expected;
+	for (uint i = 0; i < count; ++i) {
+		if (isSphereVisible(f, vec3(x[i], y[i], z[i]), r[i])) expected.push_back(i);
+	}
+	ASSERT_TRUE(expected.size() > 0 && expected.size() < count);
+	sphereSoA spheres = { x.data(), y.data(), z.data(), r.data() };
+	uint visibleCount = cullSpheres(f, spheres, count, visible.data());
+	ASSERT_EQ((uint)expected.size(), visibleCount);
+	for (uint i = 0; i < visibleCount; ++i) {
+		ASSERT_EQ(expected[i], visible[i]);
+	}
+
+	expected.clear();
+	for (uint i = 0; i < count; ++i) {
+		if (isAABBVisible(f, vec3(minX[i], minY[i], minZ[i]), vec3(maxX[i], maxY[i], maxZ[i]))) expected.push_back(i);
+	}
+	ASSERT_TRUE(expected.size() > 0 && expected.size() < count);
+	aabbSoA boxes = { minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data() };
+	visibleCount = cullAABBs(f, boxes, count, visible.data());
+	ASSERT_EQ((uint)expected.size(), visibleCount);
+	for (uint i = 0; i < visibleCount; ++i) {
+		ASSERT_EQ(expected[i], visible[i]);
+	}
+
+	ASSERT_EQ(0u, cullSpheres(f, spheres, 0, visible.data()));
+}
@@ -12,6 +12,38 @@ static void vecNear(vec<n> first, vec<n> second, float tol = 1.e-7f) {
 	}
 }
 
+template<uint n, uint m>
+static void matNear(mat<n, m> first, mat<n, m> second, float tol = 1.e-5f) {
+	for (uint i = 0; i < n; ++i) {
+		for (uint j = 0; j < m; ++j) {
+			ASSERT_NEAR(first(i, j), second(i, j), tol);
+		}
+	}
+}
+
+// Scalar references for checking the SIMD specializations
+static mat4 refMult(const mat4& a, const mat4& b) {
+	mat4 ret;
+	for (uint i = 0; i < 4; ++i) {
+		for (uint j = 0; j < 4; ++j) {
+			for (uint k = 0; k < 4; ++k) {
+				ret(i, j) += a(i, k) * b(k, j);
+			}
+		}
+	}
+	return ret;
+}
+
+static vec4 refMult(const mat4& a, const vec4& v) {
+	vec4 ret;
+	for (uint i = 0; i < 4; ++i) {
+		for (uint k = 0; k < 4; ++k) {
+			ret[i] += a(i, k) * v[k];
+		}
+	}
+	return ret;
+}
+
 // VECTOR TESTS
 
 TEST(DkMathTests, vecIndex) {
@@ -20,7 +52,9 @@ TEST(DkMathTests, vecIndex) {
 	ASSERT_EQ(4.f, a[1]);
 	ASSERT_EQ(5.f, a[2]);
 	ASSERT_EQ(6.f, a[3]);
+#if DK_MATH_CHECKED_INDEXING
 	ASSERT_ANY_THROW(a[4]);
+#endif
 }
 
 TEST(DkMathTests, vecScalMult) {
@@ -153,8 +187,10 @@ TEST(DkMathTests, matIndex) {
 	ASSERT_EQ(3.f, a(2, 0));
 	ASSERT_EQ(3.f, a(3, 0));
 	ASSERT_EQ(1.f, a(3, 3));
+#if DK_MATH_CHECKED_INDEXING
 	ASSERT_ANY_THROW(a(4, 3));
 	ASSERT_ANY_THROW(a(3, 4));
+#endif
 }
 
 TEST(DkMathTests, matIdent) {
@@ -464,6 +500,78 @@ TEST(DkMathTests, mat3Invert) {
 	ASSERT_ANY_THROW(inverse(z));
 }
 
+TEST(DkMathTests, mat4Determinant) {
+	mat4 a(
+		2.f, 0.f, 1.f, 3.f,
+		1.f, 1.f, 0.f, 2.f,
+		0.f, 3.f, 1.f, 1.f,
+		1.f, 0.f, 2.f, 1.f
+	);
+	ASSERT_NEAR(-1.f, determinant(a), 1.e-5f);
+	ASSERT_NEAR(-1.f, determinant(transpose(a)), 1.e-5f);
+	ASSERT_NEAR(24.f, determinant(mat4(scale(2.f, 3.f, 4.f))), 1.e-5f);
+	ASSERT_EQ(0.f, determinant(mat4()));
+
+	float dets[3];
+	mat4 batch[3] = { a, ident<4>(), translate(1.f, 2.f, 3.f) };
+	determinants(batch, dets, 3);
+	ASSERT_NEAR(-1.f, dets[0], 1.e-5f);
+	ASSERT_EQ(1.f, dets[1]);
+	ASSERT_EQ(1.f, dets[2]);
+}
+
+TEST(DkMathTests, mat4Invert) {
+	mat4 a(
+		2.f, 0.f, 1.f, 3.f,
+		1.f, 1.f, 0.f, 2.f,
+		0.f, 3.f, 1.f, 1.f,
+		1.f, 0.f, 2.f, 1.f
+	);
+	matNear(ident<4>(), a * inverse(a));
+	matNear(ident<4>(), inverse(a) * a);
+	matNear(a, inverse(inverse(a)));
+
+	// projective and affine paths
+	mat4 proj = perspective(60.f, 1.5f, 0.1f, 100.f);
+	matNear(ident<4>(), proj * inverse(proj), 1.e-4f);
+	mat4 view = lookAt(vec3(3.f, 4.f, 5.f), vec3(0.f), vec3(0.f, 1.f, 0.f)) * scale(2.f, 1.f, 0.5f);
+	matNear(ident<4>(), view * inverse(view));
+
+	ASSERT_ANY_THROW(inverse(mat4()));
+	// rank 3: the last row repeats the first
+	mat4 singular(
+		1.f, 2.f, 3.f, 4.f,
+		0.f, 1.f, 0.f, 2.f,
+		5.f, 0.f, 1.f, 1.f,
+		1.f, 2.f, 3.f, 4.f
+	);
+	ASSERT_ANY_THROW(inverse(singular));
+	ASSERT_ANY_THROW(inverse(mat4(scale(1.f, 0.f, 1.f))));
+}
+
+TEST(DkMathTests, mat4InvertNearSingular) {
+	// determinant 1e-4: the inverse is large but must still be accurate
+	float eps = 1.e-4f;
+	mat4 a = mat4(rotation(30.f, vec3(1.f, 1.f, 0.f))) * mat4(
+		1.f, 0.f, 0.f, 0.f,
+		0.f, 1.f, 0.f, 0.f,
+		0.f, 0.f, 1.f, 0.f,
+		0.f, 0.f, 0.f, eps
+	) * perspective(45.f, 1.f, 1.f, 10.f);
+	mat4 inv = inverse(a);
+	matNear(ident<4>(), a * inv, 1.e-3f);
+
+	// nearly dependent rows
+	mat4 b(
+		1.f, 2.f, 3.f, 4.f,
+		0.f, 1.f, 0.f, 2.f,
+		5.f, 0.f, 1.f, 1.f,
+		1.f, 2.f, 3.f, 4.f + eps
+	);
+	ASSERT_NEAR(eps * determinant(mat3(1.f, 2.f, 3.f, 0.f, 1.f, 0.f, 5.f, 0.f, 1.f)), determinant(b), 1.e-5f);
+	matNear(ident<4>(), b * inverse(b), 1.e-2f);
+}
+
 // MATRIX/VECTOR INTERACTION
 
 TEST(DkMathTests, matVecMult) {
@@ -533,4 +641,394 @@ TEST(DkMathTests, mat4Translate) {
 	vec4 exp(1.f, 2.f, 3.f, 1.f);
 
 	vecNear(exp, tr * a);
-}
\ No newline at end of file
+}
+
+TEST(DkMathTests, compoundOps) {
+	vec4 v(1.f, 2.f, 3.f, 4.f);
+	v += vec4(1.f);
+	v -= vec4(0.5f, 0.5f, 0.5f, 0.5f);
+	v *= 2.f;
+	v /= 4.f;
+	vecNear(vec4(0.75f, 1.25f, 1.75f, 2.25f), v);
+
+	mat3 mt = ident<3>();
+	mt += mat3(1.f);
+	mt -= ident<3>() * 2.f;
+	mt *= 3.f;
+	matNear(mat3(3.f) - ident<3>() * 3.f, mt);
+}
+
+TEST(DkMathTests, lookAtBasis) {
+	vec3 eye(3.f, 4.f, 5.f);
+	mat4 look = lookAt(eye, vec3(0.f), vec3(0.f, 1.f, 0.f));
+	mat3 rot = look;
+	matNear(ident<3>(), rot * transpose(rot));
+	vecNear(vec4(0.f, 0.f, 0.f, 1.f), look * vec4(eye), 1.e-5f);
+	ASSERT_ANY_THROW(lookAt(eye, eye, vec3(0.f, 1.f, 0.f)));
+}
+
+// SIMD SPECIALIZATIONS
+
+static const mat4 simdA(
+	 1.5f, -2.f,  0.25f,  4.f,
+	 3.f,   7.f, -1.f,   -0.5f,
+	-6.f,   2.f,  9.f,    1.f,
+	 0.1f,  8.f, -3.f,    2.f
+);
+
+static const mat4 simdB(
+	 2.f,  0.5f, -1.f,   3.f,
+	-4.f,  1.f,   6.f,   0.f,
+	 1.f, -7.f,   2.5f,  1.f,
+	 5.f,  3.f,  -2.f,  -1.f
+);
+
+TEST(DkMathTests, simdAlignment) {
+	ASSERT_EQ(16u, alignof(vec4));
+	ASSERT_EQ(16u, alignof(mat4));
+	ASSERT_EQ(4 * sizeof(float), sizeof(vec4));
+	ASSERT_EQ(16 * sizeof(float), sizeof(mat4));
+	ASSERT_EQ(3 * sizeof(float), sizeof(vec3));
+}
+
+TEST(DkMathTests, simdMatMult) {
+	matNear(refMult(simdA, simdB), simdA * simdB);
+	matNear(refMult(simdB, simdA), simdB * simdA);
+	matNear(refMult(simdA, simdA), simdA * simdA);
+	matNear(simdA, simdA * ident<4>(), 0.f);
+	matNear(simdA, ident<4>() * simdA, 0.f);
+}
+
+TEST(DkMathTests, simdMatVecMult) {
+	vec4 v(1.f, -2.f, 3.5f, 0.5f);
+	vec4 w(-3.f, 0.f, 2.f, 1.f);
+	vecNear(refMult(simdA, v), simdA * v, 1.e-5f);
+	vecNear(refMult(simdB, w), simdB * w, 1.e-5f);
+	vecNear(simdA * (simdB * v), (simdA * simdB) * v, 1.e-4f);
+}
+
+TEST(DkMathTests, simdTranspose) {
+	mat4 t = transpose(simdA);
+	for (uint i = 0; i < 4; ++i) {
+		for (uint j = 0; j < 4; ++j) {
+			ASSERT_EQ(simdA(i, j), t(j, i));
+		}
+	}
+	matNear(transpose(simdB * simdA), transpose(simdA) * transpose(simdB));
+}
+
+TEST(DkMathTests, simdScalarOps) {
+	mat4 scaled = simdA * 3.f;
+	mat4 summed = simdA + simdB;
+	mat4 diff = simdA - simdB;
+	for (uint i = 0; i < 4; ++i) {
+		for (uint j = 0; j < 4; ++j) {
+			ASSERT_EQ(simdA(i, j) * 3.f, scaled(i, j));
+			ASSERT_EQ(simdA(i, j) + simdB(i, j), summed(i, j));
+			ASSERT_EQ(simdA(i, j) - simdB(i, j), diff(i, j));
+		}
+	}
+
+	vec4 v(1.f, -2.f, 3.5f, 0.5f);
+	vec4 w(-3.f, 0.f, 2.f, 1.f);
+	vec4 vw = v + w;
+	vec4 v3 = v * 3.f;
+	for (uint i = 0; i < 4; ++i) {
+		ASSERT_EQ(v[i] + w[i], vw[i]);
+		ASSERT_EQ(v[i] * 3.f, v3[i]);
+	}
+}
+// BATCHED TRANSFORMS
+
+TEST(DkMathTests, batchTransformPoints) {
+	const uint count = 37;
+	std::vector<vec4> pts;
+	for (uint i = 0; i < count; ++i) {
+		pts.push_back(vec4((float)i, 2.f - (float)i, 0.5f * (float)i, (i % 3 == 0) ? 0.f : 1.f));
+	}
+
+	std::vector<vec4> out(count);
+	transformPoints(simdA, pts.data(), out.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		vecNear(refMult(simdA, pts[i]), out[i], 1.e-4f);
+	}
+
+	// in place
+	std::vector<vec4> inPlace = pts;
+	transformPoints(simdA, inPlace.data(), inPlace.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		vecNear(out[i], inPlace[i], 0.f);
+	}
+}
+
+TEST(DkMathTests, batchTransformStrided) {
+	struct vert {
+		vec4 pos;
+		vec4 color;
+	};
+	const uint count = 11;
+	std::vector<vert> verts(count);
+	for (uint i = 0; i < count; ++i) {
+		verts[i].pos = vec4((float)i, 1.f, -(float)i, 1.f);
+		verts[i].color = vec4(9.f);
+	}
+
+	std::vector<vec4> out(count);
+	transformPoints(simdB, verts[0].pos.data(), sizeof(vert), out[0].data(), sizeof(vec4), count);
+	for (uint i = 0; i < count; ++i) {
+		vecNear(refMult(simdB, verts[i].pos), out[i], 1.e-4f);
+	}
+}
+
+TEST(DkMathTests, batchTransformSoA) {
+	const uint count = 45;
+	std::vector<float> x(count), y(count), z(count), w(count);
+	for (uint i = 0; i < count; ++i) {
+		x[i] = (float)i;
+		y[i] = 3.f - (float)i;
+		z[i] = 0.25f * (float)i;
+		w[i] = (i % 2 == 0) ? 1.f : 0.f;
+	}
+	std::vector<float> ox(count), oy(count), oz(count), ow(count);
+	const float* in[4] = { x.data(), y.data(), z.data(), w.data() };
+	float* out[4] = { ox.data(), oy.data(), oz.data(), ow.data() };
+
+	transformPointsSoA(simdA, in, out, count);
+	for (uint i = 0; i < count; ++i) {
+		vecNear(refMult(simdA, vec4(x[i], y[i], z[i], w[i])), vec4(ox[i], oy[i], oz[i], ow[i]), 1.e-4f);
+	}
+
+	// implicit w = 1
+	const float* inNoW[4] = { x.data(), y.data(), z.data(), nullptr };
+	transformPointsSoA(simdA, inNoW, out, count);
+	for (uint i = 0; i < count; ++i) {
+		vecNear(refMult(simdA, vec4(x[i], y[i], z[i], 1.f)), vec4(ox[i], oy[i], oz[i], ow[i]), 1.e-4f);
+	}
+}
+
+TEST(DkMathTests, mat4InvertBatch) {
+	mat4 batch[5] = {
+		perspective(60.f, 1.5f, 0.1f, 100.f),
+		mat4(),
+		translate(1.f, 2.f, 3.f) * mat4(rotation(40.f, vec3(0.f, 0.f, 1.f))),
+		simdA,
+		simdB
+	};
+	mat4 out[5];
+	ASSERT_EQ(1u, invertMatrices(batch, out, 5));
+	matNear(mat4(), out[1]);
+	for (uint i = 0; i < 5; ++i) {
+		if (i != 1) {
+			matNear(inverse(batch[i]), out[i]);
+		}
+	}
+	// in place
+	ASSERT_EQ(1u, invertMatrices(batch, batch, 5));
+	matNear(out[0], batch[0]);
+}
+
+// AFFINE TRANSFORMS
+
+static const mat4 affA = translate(1.f, -2.f, 0.5f) * mat4(rotation(35.f, vec3(1.f, 2.f, 3.f))) * scale(2.f, 2.f, 2.f);
+static const mat4 affB = translate(-3.f, 0.f, 4.f) * mat4(rotation(-80.f, vec3(0.f, 1.f, 1.f))) * scale(1.f, 0.5f, 3.f);
+
+TEST(DkMathTests, affineCompose) {
+	affine3x4 a = affA;
+	affine3x4 b = affB;
+	matNear(affA * affB, toMat4(a * b));
+	matNear(simdA * affB, simdA * b);
+	vec4 p(1.f, 2.f, 3.f, 1.f);
+	vecNear(affA * p, a * p, 1.e-5f);
+}
+
+TEST(DkMathTests, affineInverse) {
+	affine3x4 a = affA;
+	affine3x4 b = affB;
+	matNear(ident<4>(), toMat4(a * inverse(a)));
+	matNear(ident<4>(), toMat4(b * inverse(b)));
+	matNear(toMat4(inverse(a)), toMat4(inverseUniformScale(a)));
+	ASSERT_ANY_THROW(inverse(affine3x4(0.f)));
+	ASSERT_ANY_THROW(inverseUniformScale(affine3x4(0.f)));
+}
+
+TEST(DkMathTests, affineNormalMatrix) {
+	const uint count = 7;
+	std::vector<affine3x4> mv(count);
+	for (uint i = 0; i < count; ++i) {
+		mv[i] = translate((float)i, 1.f, 2.f) * mat4(rotation(20.f * i, vec3(1.f, (float)i, 1.f))) * scale(1.f + i, 2.f, 0.5f);
+	}
+	// singular transforms must not produce infinities
+	mv[5] = scale(1.f, 0.f, 1.f);
+
+	for (uint i = 0; i < count; ++i) {
+		if (i != 5) {
+			matNear(transpose(inverse(mat3(toMat4(mv[i])))), normalMatrix(mv[i]));
+		}
+	}
+
+	std::vector<mat4> packed(count, ident<4>());
+	normalMatrices(mv.data(), packed[0].data(), (uint)sizeof(mat4), count);
+	for (uint i = 0; i < count; ++i) {
+		matNear(transpose(mat4(normalMatrix(mv[i]))), packed[i]);
+	}
+	vec4 n = transpose(packed[5]) * vec4(0.f, 1.f, 0.f, 0.f);
+	ASSERT_TRUE(n.norm() > 0.f && std::isfinite(n.norm()));
+}
+
+// GPU LAYOUT
+
+TEST(DkMathTests, gpuMat4Layout) {
+	gpuMat4 g(affA);
+	for (uint i = 0; i < 4; ++i) {
+		for (uint j = 0; j < 4; ++j) {
+			ASSERT_EQ(affA(i, j), g(i, j));
+			ASSERT_EQ(affA(i, j), g.data()[i + 4 * j]);
+		}
+	}
+	matNear(transpose(affA), *reinterpret_cast<const mat4*>(g.data()), 0.f);
+	matNear(affA, toMat4(gpuMat4(affine3x4(affA))), 0.f);
+#if DK_MATH_CHECKED_INDEXING
+	ASSERT_ANY_THROW(g(4, 0));
+#endif
+}
+
+TEST(DkMathTests, gpuMat4Product) {
+	mat4 proj = perspective(45.f, 1.5f, 0.1f, 100.f);
+	matNear(proj * affB, toMat4(mulToGpu(proj, affB)));
+	matNear(proj * affB, toMat4(mulToGpu(proj, affine3x4(affB))));
+
+	const uint count = 6;
+	std::vector<mat4> projs(count, proj);
+	std::vector<affine3x4> mv(count);
+	for (uint i = 0; i < count; ++i) {
+		projs[i](0, 0) += (float)i;
+		mv[i] = translate((float)i, 2.f, -3.f) * mat4(rotation(30.f * i, vec3(1.f, 1.f, (float)i)));
+	}
+	std::vector<gpuMat4> out(count);
+	mulToGpu(projs.data(), mv.data(), out.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		matNear(transpose(projs[i] * mv[i]), *reinterpret_cast<const mat4*>(out[i].data()));
+	}
+}
+
+// QUATERNIONS
+
+static void quatNear(quat first, quat second, float tol = 1.e-5f) {
+	// q and -q are the same rotation
+	float sign = dot(first, second) < 0.f ? -1.f : 1.f;
+	for (uint i = 0; i < 4; ++i) {
+		ASSERT_NEAR(first[i], sign * second[i], tol);
+	}
+}
+
+TEST(DkMathTests, quatToMat) {
+	vec3 axis(1.f, 2.f, -0.5f);
+	for (float angle = -170.f; angle < 180.f; angle += 35.f) {
+		quat q = axisAngle(angle, axis);
+		matNear(rotation(angle, axis), toMat3(q));
+		vec3 v(0.3f, -1.f, 2.f);
+		vecNear(rotation(angle, axis) * v, q * v, 1.e-5f);
+	}
+	matNear(ident<4>(), toMat4(quat()));
+	ASSERT_ANY_THROW(normalize(quat(0.f, 0.f, 0.f, 0.f)));
+}
+
+TEST(DkMathTests, quatCompose) {
+	quat a = axisAngle(30.f, vec3(0.f, 0.f, 1.f));
+	quat b = axisAngle(70.f, vec3(1.f, 1.f, 0.f));
+	matNear(toMat3(a) * toMat3(b), toMat3(a * b));
+	quatNear(quat(), a * conjugate(a));
+	quatNear(axisAngle(60.f, vec3(0.f, 0.f, 1.f)), a * a);
+}
+
+TEST(DkMathTests, quatInterpolate) {
+	vec3 axis(0.f, 1.f, 0.f);
+	quat a = axisAngle(10.f, axis);
+	quat b = axisAngle(130.f, axis);
+	quatNear(axisAngle(40.f, axis), slerp(a, b, 0.25f));
+	quatNear(a, slerp(a, b, 0.f));
+	quatNear(b, slerp(a, b, 1.f));
+	// the negated end point is the same rotation and must take the same path
+	quatNear(axisAngle(40.f, axis), slerp(a, quat(-b[0], -b[1], -b[2], -b[3]), 0.25f));
+
+	quat n = nlerp(a, b, 0.5f);
+	ASSERT_NEAR(1.f, n.norm(), 1.e-6f);
+	quatNear(axisAngle(70.f, axis), n);
+}
+
+TEST(DkMathTests, batchQuats) {
+	const uint count = 23;
+	std::vector<quat> a(count), b(count), out(count);
+	for (uint i = 0; i < count; ++i) {
+		a[i] = axisAngle(15.f * i, vec3(1.f, (float)i, 2.f));
+		b[i] = axisAngle(-40.f + 13.f * i, vec3((float)i, 1.f, -1.f));
+		// exercise the shorter-arc flip
+		if (i % 3 == 0) {
+			b[i] = quat(-b[i][0], -b[i][1], -b[i][2], -b[i][3]);
+		}
+	}
+
+	multiplyQuats(a.data(), b.data(), out.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		quatNear(a[i] * b[i], out[i]);
+	}
+
+	nlerpQuats(a.data(), b.data(), 0.3f, out.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		quatNear(nlerp(a[i], b[i], 0.3f), out[i]);
+	}
+
+	for (float t = 0.f; t <= 1.f; t += 0.125f) {
+		slerpQuats(a.data(), b.data(), t, out.data(), count);
+		for (uint i = 0; i < count; ++i) {
+			quatNear(slerp(a[i], b[i], t), out[i], 1.e-5f);
+		}
+	}
+
+	std::vector<mat4> mats(count);
+	std::vector<vec4> offsets(count);
+	for (uint i = 0; i < count; ++i) {
+		offsets[i] = vec4((float)i, -1.f, 0.5f * i, 1.f);
+	}
+	quatsToMat4(a.data(), nullptr, mats.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		matNear(toMat4(a[i]), mats[i]);
+	}
+	quatsToMat4(a.data(), offsets.data(), mats.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		matNear(translate(offsets[i][0], offsets[i][1], offsets[i][2]) * toMat4(a[i]), mats[i]);
+	}
+}
+
+// COMPILE-TIME EVALUATION
+
+static_assert(dot(vec3(1.f, 2.f, 3.f), vec3(4.f, 5.f, 6.f)) == 32.f, "constexpr dot");
+static_assert(cross(vec3(1.f, 0.f, 0.f), vec3(0.f, 1.f, 0.f)) == vec3(0.f, 0.f, 1.f), "constexpr cross");
+static_assert(ident<3>()(1, 1) == 1.f && ident<3>()(1, 2) == 0.f, "constexpr ident");
+static_assert(transpose(mat<2, 3>({ 1.f, 2.f, 3.f, 4.f, 5.f, 6.f }))(2, 1) == 6.f, "constexpr transpose");
+static_assert(mat3(2.f) * ident<3>() == mat3(2.f), "constexpr product");
+static_assert(mat3(1.f) * vec3(1.f, 2.f, 3.f) == vec3(6.f), "constexpr mat-vec");
+static_assert(scale(2.f, 3.f, 4.f)(1, 1) == 3.f, "constexpr scale");
+static_assert(translate(1.f, 2.f, 3.f)(2, 3) == 3.f, "constexpr translate");
+static_assert(mat4(ident<3>())(3, 3) == 1.f, "constexpr mat3 to mat4");
+static_assert(toMat3(quat(0.f, 0.f, 1.f, 0.f)) == mat3(-1.f, 0.f, 0.f, 0.f, -1.f, 0.f, 0.f, 0.f, 1.f), "constexpr quat to mat3");
+static_assert(quat(0.f, 0.f, 1.f, 0.f) * quat(0.f, 0.f, 1.f, 0.f) == quat(0.f, 0.f, 0.f, -1.f), "constexpr quat product");
+static_assert(gpuMat4(translate(1.f, 2.f, 3.f)).data()[13] == 2.f, "constexpr gpu layout");
+#ifdef DK_MATH_CONSTEXPR_ALL
+static_assert(translate(1.f, 2.f, 3.f) * scale(2.f, 2.f, 2.f) * vec4(1.f, 1.f, 1.f, 1.f) == vec4(3.f, 4.f, 5.f, 1.f), "constexpr mat4 SIMD overloads");
+static_assert(transpose(translate(1.f, 2.f, 3.f))(3, 0) == 1.f, "constexpr mat4 transpose");
+static_assert(vec4(1.f) + vec4(2.f) - vec4(0.5f) == vec4(2.5f), "constexpr vec4 arithmetic");
+#endif
+
+static_assert(noexcept(mat4() * mat4()) && noexcept(transpose(mat4())) && noexcept(vec4() + vec4()), "math operators are noexcept");
+static_assert(noexcept(vec4()[0]) == !DK_MATH_CHECKED_INDEXING, "indexing is noexcept exactly when unchecked");
+
+TEST(DkMathTests, rowColBounds) {
+	mat<2, 3> mt({ 1.f, 2.f, 3.f, 4.f, 5.f, 6.f });
+	vecNear(vec<3>({ 4.f, 5.f, 6.f }), mt.row(1));
+	vecNear(vec<2>({ 3.f, 6.f }), mt.col(2));
+#if DK_MATH_CHECKED_INDEXING
+	ASSERT_ANY_THROW(mt.row(2));
+	ASSERT_ANY_THROW(mt.col(3));
+#endif
+}
@@ -0,0 +1,224 @@
+#include "pch.h"
+
+#include <map>
+#include <random>
+#include "DkMemoryAllocator.h"
+
+TEST(DkMemoryAllocatorTests, initialState) {
+	DkTlsfAllocator alloc;
+	ASSERT_FALSE(alloc.init(0));
+	ASSERT_TRUE(alloc.init(1 << 20));
+	DkAllocatorStats stats = alloc.getStats();
+	ASSERT_EQ(1u << 20, stats.size);
+	ASSERT_EQ(0u, stats.usedBytes);
+	ASSERT_EQ(1u << 20, stats.largestFreeRange);
+	ASSERT_EQ(0u, stats.allocationCount);
+	ASSERT_EQ(1u, stats.freeRangeCount);
+	ASSERT_TRUE(alloc.isEmpty());
+}
+
+TEST(DkMemoryAllocatorTests, alignment) {
+	DkTlsfAllocator alloc;
+	ASSERT_TRUE(alloc.init(1 << 20));
+	VkDeviceSize offset;
+	uint a = alloc.allocate(100, 1, offset);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, a);
+	ASSERT_EQ(0u, offset);
+	uint b = alloc.allocate(256, 256, offset);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, b);
+	ASSERT_EQ(256u, offset);
+	uint c = alloc.allocate(4096, 65536, offset);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, c);
+	ASSERT_EQ(65536u, offset);
+	ASSERT_EQ(65536u, alloc.getOffset(c));
+	ASSERT_EQ(4096u, alloc.getAllocationSize(c));
+
+	// the padding in front of b and c is handed out again
+	uint d = alloc.allocate(64, 16, offset);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, d);
+	ASSERT_LT(offset, 65536u);
+	ASSERT_EQ(0u, offset % 16);
+
+	ASSERT_EQ(DkTlsfAllocator::INVALID_HANDLE, alloc.allocate(64, 3, offset));
+	ASSERT_EQ(DkTlsfAllocator::INVALID_HANDLE, alloc.allocate(0, 1, offset));
+}
+
+TEST(DkMemoryAllocatorTests, exhaustionAndCoalescing) {
+	DkTlsfAllocator alloc;
+	ASSERT_TRUE(alloc.init(4096));
+	std::vector<uint> handles;
+	VkDeviceSize offset;
+	for (uint iter = 0; iter < 16; ++iter) {
+		handles.push_back(alloc.allocate(256, 256, offset));
+		ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, handles.back());
+		ASSERT_EQ(iter * 256u, offset);
+	}
+	ASSERT_EQ(DkTlsfAllocator::INVALID_HANDLE, alloc.allocate(1, 1, offset));
+	ASSERT_EQ(0u, alloc.getStats().largestFreeRange);
+
+	// free every other range; none can merge, so nothing larger fits
+	for (uint iter = 0; iter < 16; iter += 2) {
+		alloc.free(handles[iter]);
+	}
+	DkAllocatorStats stats = alloc.getStats();
+	ASSERT_EQ(8u, stats.freeRangeCount);
+	ASSERT_EQ(256u, stats.largestFreeRange);
+	ASSERT_EQ(DkTlsfAllocator::INVALID_HANDLE, alloc.allocate(512, 1, offset));
+
+	// freeing the rest merges everything back into one range
+	for (uint iter = 1; iter < 16; iter += 2) {
+		alloc.free(handles[iter]);
+	}
+	stats = alloc.getStats();
+	ASSERT_EQ(1u, stats.freeRangeCount);
+	ASSERT_EQ(4096u, stats.largestFreeRange);
+	ASSERT_EQ(0u, stats.usedBytes);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, alloc.allocate(4096, 4096, offset));
+}
+
+TEST(DkMemoryAllocatorTests, exactFitWithoutGuarantee) {
+	// 1000 bytes of a 1000 byte heap: no bin guarantees the fit, the exact
+	//	size bin is searched instead
+	DkTlsfAllocator alloc;
+	ASSERT_TRUE(alloc.init(1000));
+	VkDeviceSize offset;
+	uint a = alloc.allocate(1000, 8, offset);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, a);
+	alloc.free(a);
+	alloc.free(a);		// double free is reported and ignored
+	ASSERT_TRUE(alloc.isEmpty());
+}
+
+TEST(DkMemoryAllocatorTests, alignedRangeBehindMisalignedHead) {
+	// Two free 64 byte ranges share a bin; the head at 32 cannot hold 40
+	//	bytes aligned to 64, the one at 128 can, and no bin guarantees the
+	//	padded size
+	DkTlsfAllocator alloc;
+	ASSERT_TRUE(alloc.init(1024));
+	VkDeviceSize offset;
+	uint a = alloc.allocate(32, 1, offset);
+	uint f1 = alloc.allocate(64, 1, offset);
+	ASSERT_EQ(32u, offset);
+	uint b = alloc.allocate(32, 1, offset);
+	uint f2 = alloc.allocate(64, 1, offset);
+	ASSERT_EQ(128u, offset);
+	uint c = alloc.allocate(1024 - 192, 1, offset);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, c);
+	alloc.free(f2);
+	alloc.free(f1);
+
+	uint d = alloc.allocate(40, 64, offset);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, d);
+	ASSERT_EQ(128u, offset);
+	alloc.free(d);
+	alloc.free(a);
+	alloc.free(b);
+	alloc.free(c);
+	ASSERT_TRUE(alloc.isEmpty());
+	ASSERT_EQ(1u, alloc.getStats().freeRangeCount);
+}
+
+TEST(DkMemoryAllocatorTests, compactionClaimsLowerRange) {
+	// The pattern DkDeviceMemory::defragment follows: a live allocation
+	//	above a hole claims the hole, then its old range is released
+	DkTlsfAllocator alloc;
+	ASSERT_TRUE(alloc.init(4096));
+	VkDeviceSize offset;
+	uint a = alloc.allocate(1024, 256, offset);
+	uint b = alloc.allocate(1024, 256, offset);
+	ASSERT_EQ(1024u, offset);
+	alloc.free(a);
+
+	VkDeviceSize moved;
+	uint c = alloc.allocateBelow(1024, 256, alloc.getOffset(b), moved);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, c);
+	ASSERT_EQ(0u, moved);
+	alloc.free(b);
+	DkAllocatorStats stats = alloc.getStats();
+	ASSERT_EQ(1024u, stats.usedBytes);
+	ASSERT_EQ(1u, stats.freeRangeCount);
+	ASSERT_EQ(3072u, stats.largestFreeRange);
+}
+
+TEST(DkMemoryAllocatorTests, compactionFailureLeavesHeap) {
+	DkTlsfAllocator alloc;
+	ASSERT_TRUE(alloc.init(4096));
+	VkDeviceSize offset;
+	uint a = alloc.allocate(1024, 256, offset);
+	uint b = alloc.allocate(1024, 256, offset);
+	uint c = alloc.allocate(1024, 256, offset);
+	alloc.free(c);
+	DkAllocatorStats before = alloc.getStats();
+
+	// nothing below b is free, so the range found lies above it and is
+	//	given back
+	VkDeviceSize moved;
+	ASSERT_EQ(DkTlsfAllocator::INVALID_HANDLE, alloc.allocateBelow(1024, 256, alloc.getOffset(b), moved));
+	DkAllocatorStats after = alloc.getStats();
+	ASSERT_EQ(before.usedBytes, after.usedBytes);
+	ASSERT_EQ(before.allocationCount, after.allocationCount);
+	ASSERT_EQ(before.freeRangeCount, after.freeRangeCount);
+	ASSERT_EQ(before.largestFreeRange, after.largestFreeRange);
+
+	// a pass that fails after claiming ranges frees them again, which also
+	//	restores the heap
+	alloc.free(a);
+	before = alloc.getStats();
+	uint d = alloc.allocateBelow(1024, 256, alloc.getOffset(b), moved);
+	ASSERT_NE(DkTlsfAllocator::INVALID_HANDLE, d);
+	alloc.free(d);
+	after = alloc.getStats();
+	ASSERT_EQ(before.usedBytes, after.usedBytes);
+	ASSERT_EQ(before.freeRangeCount, after.freeRangeCount);
+	ASSERT_EQ(before.largestFreeRange, after.largestFreeRange);
+}
+
+TEST(DkMemoryAllocatorTests, randomized) {
+	const VkDeviceSize heapSize = 64 << 20;
+	DkTlsfAllocator alloc;
+	ASSERT_TRUE(alloc.init(heapSize));
+
+	std::mt19937 rng(1234);
+	std::map<VkDeviceSize, std::pair<VkDeviceSize, uint>> live;		// offset -> (size, handle)
+	VkDeviceSize used = 0;
+	for (uint iter = 0; iter < 20000; ++iter) {
+		if (live.empty() || rng() % 100 < 55) {
+			VkDeviceSize size = 1 + rng() % (rng() % 8 == 0 ? (1 << 20) : 4096);
+			VkDeviceSize alignment = (VkDeviceSize)1 << (rng() % 17);
+			VkDeviceSize offset;
+			uint handle = alloc.allocate(size, alignment, offset);
+			if (handle == DkTlsfAllocator::INVALID_HANDLE) continue;
+			ASSERT_EQ(0u, offset % alignment);
+			ASSERT_LE(offset + size, heapSize);
+
+			// no overlap with either neighbour
+			auto next = live.lower_bound(offset);
+			if (next != live.end()) {
+				ASSERT_LE(offset + size, next->first);
+			}
+			if (next != live.begin()) {
+				auto prev = std::prev(next);
+				ASSERT_LE(prev->first + prev->second.first, offset);
+			}
+			live[offset] = std::make_pair(size, handle);
+			used += size;
+		}
+		else {
+			auto victim = live.begin();
+			std::advance(victim, rng() % live.size());
+			ASSERT_EQ(victim->first, alloc.getOffset(victim->second.second));
+			alloc.free(victim->second.second);
+			used -= victim->second.first;
+			live.erase(victim);
+		}
+		ASSERT_EQ(used, alloc.getStats().usedBytes);
+		ASSERT_EQ((uint)live.size(), alloc.getStats().allocationCount);
+	}
+
+	for (auto& item : live) {
+		alloc.free(item.second.second);
+	}
+	DkAllocatorStats stats = alloc.getStats();
+	ASSERT_EQ(1u, stats.freeRangeCount);
+	ASSERT_EQ(heapSize, stats.largestFreeRange);
+}
\ No newline at end of file
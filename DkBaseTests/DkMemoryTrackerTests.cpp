@@ -0,0 +1,98 @@
+#include "pch.h"
+
+#include <sstream>
+#include "DkMemoryTracker.h"
+
+// Two heaps: device local with two types, host visible with one
+static VkPhysicalDeviceMemoryProperties _testMemProps() {
+	VkPhysicalDeviceMemoryProperties props = {};
+	props.memoryTypeCount = 3;
+	props.memoryTypes[0] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+	props.memoryTypes[1] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 0 };
+	props.memoryTypes[2] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1 };
+	props.memoryHeapCount = 2;
+	props.memoryHeaps[0] = { 4ull << 30, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+	props.memoryHeaps[1] = { 8ull << 30, 0 };
+	return props;
+}
+
+TEST(DkMemoryTrackerTests, countsPerTypeAndHeap) {
+	DkMemoryTracker tracker;
+	tracker.init(_testMemProps());
+	tracker.recordBlockAllocation(0, 64 << 20);
+	tracker.recordAllocation(0, 1000);
+	tracker.recordAllocation(1, 3000);
+	tracker.recordAllocation(2, 500);
+
+	ASSERT_EQ(1u, tracker.getTypeUsage(0).allocations.count);
+	ASSERT_EQ(1000u, tracker.getTypeUsage(0).allocations.bytes);
+	ASSERT_EQ(2u, tracker.getHeapUsage(0).allocations.count);
+	ASSERT_EQ(4000u, tracker.getHeapUsage(0).allocations.bytes);
+	ASSERT_EQ(500u, tracker.getHeapUsage(1).allocations.bytes);
+	ASSERT_EQ(1u, tracker.getHeapUsage(0).blocks.count);
+	ASSERT_EQ(0u, tracker.getHeapUsage(1).blocks.count);
+	ASSERT_EQ(3u, tracker.getTotalUsage().allocations.count);
+
+	tracker.recordFree(1, 3000);
+	ASSERT_EQ(1000u, tracker.getHeapUsage(0).allocations.bytes);
+	ASSERT_EQ(4000u, tracker.getHeapUsage(0).allocations.peakBytes);
+	ASSERT_EQ(2u, tracker.getHeapUsage(0).allocations.totalCount);
+
+	// a free that was never allocated is reported and ignored
+	tracker.recordFree(1, 3000);
+	ASSERT_EQ(1000u, tracker.getHeapUsage(0).allocations.bytes);
+	tracker.recordAllocation(7, 100);
+	ASSERT_EQ(2u, tracker.getTotalUsage().allocations.count);
+}
+
+TEST(DkMemoryTrackerTests, histogram) {
+	ASSERT_EQ(0u, DkMemoryTracker::getHistogramBucket(1));
+	ASSERT_EQ(0u, DkMemoryTracker::getHistogramBucket(256));
+	ASSERT_EQ(1u, DkMemoryTracker::getHistogramBucket(257));
+	ASSERT_EQ(2u, DkMemoryTracker::getHistogramBucket(1024));
+	ASSERT_EQ(DK_MEMORY_HISTOGRAM_BUCKETS - 1, DkMemoryTracker::getHistogramBucket(1ull << 40));
+	for (uint iter = 0; iter + 1 < DK_MEMORY_HISTOGRAM_BUCKETS; ++iter) {
+		VkDeviceSize limit = DkMemoryTracker::getHistogramBucketLimit(iter);
+		ASSERT_EQ(iter, DkMemoryTracker::getHistogramBucket(limit));
+		ASSERT_EQ(iter + 1, DkMemoryTracker::getHistogramBucket(limit + 1));
+	}
+
+	DkMemoryTracker tracker;
+	tracker.init(_testMemProps());
+	tracker.recordAllocation(0, 200);
+	tracker.recordAllocation(0, 100);
+	tracker.recordAllocation(0, 4096);
+	tracker.recordFree(0, 100);
+	ASSERT_EQ(1u, tracker.getHistogram().live[0]);
+	ASSERT_EQ(2u, tracker.getHistogram().total[0]);
+	ASSERT_EQ(1u, tracker.getHistogram().live[4]);
+}
+
+TEST(DkMemoryTrackerTests, json) {
+	DkMemoryTracker tracker;
+	tracker.init(_testMemProps());
+	tracker.recordBlockAllocation(2, 1 << 20);
+	tracker.recordAllocation(2, 4096);
+
+	std::ostringstream withoutBudget;
+	tracker.writeJson(withoutBudget, {});
+	std::string text = withoutBudget.str();
+	ASSERT_NE(std::string::npos, text.find("\"heaps\""));
+	ASSERT_NE(std::string::npos, text.find("\"histogram\""));
+	ASSERT_NE(std::string::npos, text.find("\"maxSize\": null"));
+	ASSERT_EQ(std::string::npos, text.find("\"budget\""));
+
+	std::ostringstream withBudget;
+	tracker.writeJson(withBudget, { { 3ull << 30, 1ull << 30 }, { 6ull << 30, 1 << 20 } });
+	text = withBudget.str();
+	ASSERT_NE(std::string::npos, text.find("\"budget\": 3221225472, \"usage\": 1073741824"));
+
+	// braces and brackets balance
+	int depth = 0;
+	for (char c : text) {
+		if (c == '{' || c == '[') ++depth;
+		if (c == '}' || c == ']') --depth;
+		ASSERT_GE(depth, 0);
+	}
+	ASSERT_EQ(0, depth);
+}
\ No newline at end of file
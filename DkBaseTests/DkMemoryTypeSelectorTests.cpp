@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "DkMemoryTypeSelector.h"
+
+static const VkMemoryPropertyFlags DL = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+static const VkMemoryPropertyFlags HV = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+static const VkMemoryPropertyFlags HC = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+static const VkMemoryPropertyFlags CA = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+// Typical discrete GPU: VRAM, a 256 MB mappable VRAM window, and system
+//	memory both write-combined and cached. Cached is listed first on purpose
+static VkPhysicalDeviceMemoryProperties _discreteMemProps() {
+	VkPhysicalDeviceMemoryProperties props = {};
+	props.memoryHeapCount = 3;
+	props.memoryHeaps[0] = { 8ull << 30, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+	props.memoryHeaps[1] = { 16ull << 30, 0 };
+	props.memoryHeaps[2] = { 256ull << 20, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+	props.memoryTypeCount = 5;
+	props.memoryTypes[0] = { 0, 1 };
+	props.memoryTypes[1] = { HV | HC | CA, 1 };
+	props.memoryTypes[2] = { HV | HC, 1 };
+	props.memoryTypes[3] = { DL | HV | HC, 2 };
+	props.memoryTypes[4] = { DL, 0 };
+	return props;
+}
+
+TEST(DkMemoryTypeSelectorTests, usageHints) {
+	DkMemoryTypeSelector selector;
+	selector.init(_discreteMemProps());
+	const uint all = 0x1f;
+
+	ASSERT_EQ(4, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_GPU_ONLY }));
+	ASSERT_EQ(2, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_UPLOAD }));
+	ASSERT_EQ(1, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_READBACK }));
+	ASSERT_EQ(3, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_DYNAMIC }));
+
+	// plain required flags take the type with the fewest extras, not the first
+	ASSERT_EQ(4, selector.select(all, { DL, 0, 0, DK_MEMORY_USAGE_UNKNOWN }));
+	ASSERT_EQ(2, selector.select(all, { HV, 0, 0, DK_MEMORY_USAGE_UNKNOWN }));
+
+	// explicit flags override the hint
+	ASSERT_EQ(3, selector.select(all, { 0, DL, 0, DK_MEMORY_USAGE_UPLOAD }));
+}
+
+TEST(DkMemoryTypeSelectorTests, typeBitsAndRequired) {
+	DkMemoryTypeSelector selector;
+	selector.init(_discreteMemProps());
+	ASSERT_EQ(1, selector.select(0x3, { 0, 0, 0, DK_MEMORY_USAGE_UPLOAD }));
+	ASSERT_EQ(-1, selector.select(0x11, { HV, 0, 0, DK_MEMORY_USAGE_UNKNOWN }));
+	ASSERT_EQ(-1, selector.select(0, { 0, 0, 0, DK_MEMORY_USAGE_UNKNOWN }));
+	// cached rankings don't leak between type bits
+	ASSERT_EQ(2, selector.select(0x1f, { 0, 0, 0, DK_MEMORY_USAGE_UPLOAD }));
+}
+
+TEST(DkMemoryTypeSelectorTests, heapSize) {
+	DkMemoryTypeSelector selector;
+	selector.init(_discreteMemProps());
+	const uint all = 0x1f;
+
+	// the mappable VRAM window is full, so dynamic data falls back to system memory
+	std::vector<VkDeviceSize> usage = { 0, 0, 250ull << 20 };
+	ASSERT_EQ(3, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_DYNAMIC }, 1 << 20, usage));
+	ASSERT_EQ(2, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_DYNAMIC }, 16 << 20, usage));
+
+	// larger than the window at all
+	ASSERT_EQ(2, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_DYNAMIC }, 512ull << 20));
+
+	// every heap full: the best type that could hold it
+	usage = { 8ull << 30, 16ull << 30, 256ull << 20 };
+	ASSERT_EQ(4, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_GPU_ONLY }, 1 << 20, usage));
+	ASSERT_EQ(-1, selector.select(all, { 0, 0, 0, DK_MEMORY_USAGE_GPU_ONLY }, 32ull << 30, usage));
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "pch.h"
+
+#include "DkResourceState.h"
+
+TEST(DkResourceStateTests, bufferReadsAndWrites) {
+	DkResourceState state = DkResourceStateTracker::initialState();
+	std::vector<DkStateTransition> out;
+
+	// first upload claims the buffer; nothing to wait on yet
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 0, false, out));
+	ASSERT_EQ(0u, out.size());
+	ASSERT_EQ(0u, state.queueFamily);
+
+	// read after write waits only on the transfer
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_TRANSFER_BIT, out[0].srcStages);
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, out[0].dstStages);
+	ASSERT_EQ((VkAccessFlags)VK_ACCESS_TRANSFER_WRITE_BIT, out[0].srcAccess);
+	ASSERT_EQ((VkAccessFlags)VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, out[0].dstAccess);
+	ASSERT_EQ(VK_QUEUE_FAMILY_IGNORED, out[0].srcQueueFamily);
+
+	// read after read: the same stage and access are already covered
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+	ASSERT_EQ(0u, out.size());
+
+	// a new access type still needs the write made visible to it
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_INDEX_BUFFER, 0, false, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkAccessFlags)VK_ACCESS_INDEX_READ_BIT, out[0].dstAccess);
+
+	// write after read waits on the readers, with nothing to make available
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 0, false, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkPipelineStageFlags)(VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT), out[0].srcStages);
+	ASSERT_EQ((VkAccessFlags)VK_ACCESS_TRANSFER_WRITE_BIT, out[0].srcAccess);
+	ASSERT_EQ(0u, state.readStages);
+}
+
+TEST(DkResourceStateTests, imageLayouts) {
+	DkResourceState state = DkResourceStateTracker::initialState();
+	std::vector<DkStateTransition> out;
+
+	// the first transition has no previous use to wait on
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 0, true, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, out[0].srcStages);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_UNDEFINED, out[0].oldLayout);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, out[0].newLayout);
+
+	// a read in another layout is a transition, and so a write
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, out[0].oldLayout);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, out[0].newLayout);
+	ASSERT_EQ((VkAccessFlags)VK_ACCESS_TRANSFER_WRITE_BIT, out[0].srcAccess);
+
+	// the transition made it visible to fragment reads already
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_EQ(0u, out.size());
+
+	// vertex shader reads in the same layout only wait on the transition
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_VERTEX_SHADER_READ, 0, true, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, out[0].srcStages);
+	ASSERT_EQ(0u, out[0].srcAccess);
+	ASSERT_EQ(out[0].oldLayout, out[0].newLayout);
+}
+
+TEST(DkResourceStateTests, queueFamilyTransfer) {
+	DkResourceState state = DkResourceStateTracker::initialState();
+	std::vector<DkStateTransition> out;
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 2, true, out));
+
+	// owned by the transfer family until released
+	out.clear();
+	ASSERT_FALSE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_EQ(0u, out.size());
+
+	ASSERT_TRUE(DkResourceStateTracker::release(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ(2u, out[0].srcQueueFamily);
+	ASSERT_EQ(0u, out[0].dstQueueFamily);
+	ASSERT_EQ(0u, out[0].dstAccess);
+	ASSERT_FALSE(DkResourceStateTracker::release(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_FALSE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 1, true, out));
+
+	// the acquire repeats the release's layouts, and leaves nothing more to do
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, out[0].srcStages);
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, out[0].dstStages);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, out[0].oldLayout);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, out[0].newLayout);
+	ASSERT_EQ(2u, out[0].srcQueueFamily);
+	ASSERT_EQ(0u, out[0].dstQueueFamily);
+	ASSERT_EQ(0u, state.queueFamily);
+
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_EQ(0u, out.size());
+
+	// concurrently shared resources skip ownership
+	DkResourceState shared = DkResourceStateTracker::initialState();
+	ASSERT_TRUE(DkResourceStateTracker::require(shared, DK_RESOURCE_USAGE_TRANSFER_DST, VK_QUEUE_FAMILY_IGNORED, false, out));
+	ASSERT_FALSE(DkResourceStateTracker::release(shared, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+}
+
+TEST(DkResourceStateTests, secondUploadIntoOwnedBuffer) {
+	// DkUploadManager streaming a second batch into a buffer, such as a
+	//	DkGeometryArena's, that the graphics family (0) took over after the
+	//	first batch on the transfer family (2)
+	DkResourceState state = DkResourceStateTracker::initialState();
+	std::vector<DkStateTransition> out;
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 2, false, out));
+	ASSERT_TRUE(DkResourceStateTracker::release(state, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+	ASSERT_EQ(0u, state.queueFamily);
+
+	// the transfer family cannot write it until the graphics family hands it
+	//	back
+	out.clear();
+	ASSERT_FALSE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 2, false, out));
+	ASSERT_EQ(0u, out.size());
+
+	// the release back waits on the draws reading it
+	ASSERT_TRUE(DkResourceStateTracker::release(state, DK_RESOURCE_USAGE_TRANSFER_DST, 2, false, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, out[0].srcStages);
+	ASSERT_EQ(0u, out[0].srcQueueFamily);
+	ASSERT_EQ(2u, out[0].dstQueueFamily);
+
+	// the acquire on the transfer family orders the copies after it, and the
+	//	second batch goes back to the graphics family the same way
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 2, false, out));
+	ASSERT_FALSE(out.empty());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_TRANSFER_BIT, out[0].dstStages);
+	ASSERT_EQ((VkAccessFlags)VK_ACCESS_TRANSFER_WRITE_BIT, out[0].dstAccess);
+	ASSERT_EQ(0u, out[0].srcQueueFamily);
+	ASSERT_EQ(2u, out[0].dstQueueFamily);
+	ASSERT_EQ(2u, state.queueFamily);
+
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::release(state, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ((VkPipelineStageFlags)VK_PIPELINE_STAGE_TRANSFER_BIT, out[0].srcStages);
+	ASSERT_EQ((VkAccessFlags)VK_ACCESS_TRANSFER_WRITE_BIT, out[0].srcAccess);
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+	ASSERT_EQ(0u, state.queueFamily);
+}
+
+TEST(DkResourceStateTests, settle) {
+	std::vector<DkStateTransition> out;
+	DkResourceState state = DkResourceStateTracker::initialState();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_TRANSFER_DST, 0, true, out));
+
+	// a settled write needs no barrier before a read, only the layout change
+	DkResourceStateTracker::settle(state);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, state.layout);
+	ASSERT_EQ(0u, state.queueFamily);
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(state, DK_RESOURCE_USAGE_FRAGMENT_SHADER_READ, 0, true, out));
+	ASSERT_EQ(1u, out.size());
+	ASSERT_EQ(0u, out[0].srcAccess);
+	ASSERT_EQ(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, out[0].newLayout);
+
+	// and a buffer nothing at all
+	DkResourceState buffer = DkResourceStateTracker::initialState();
+	ASSERT_TRUE(DkResourceStateTracker::require(buffer, DK_RESOURCE_USAGE_TRANSFER_DST, 0, false, out));
+	DkResourceStateTracker::settle(buffer);
+	out.clear();
+	ASSERT_TRUE(DkResourceStateTracker::require(buffer, DK_RESOURCE_USAGE_VERTEX_BUFFER, 0, false, out));
+	ASSERT_EQ(0u, out.size());
+}
\ No newline at end of file
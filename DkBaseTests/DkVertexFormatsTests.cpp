@@ -0,0 +1,167 @@
+#include "pch.h"
+
+#pragma warning(disable : 4244)
+#include "DkVertexFormats.h"
+
+using namespace math;
+
+static_assert(sizeof(DkVertex) == 48, "DkVertex is three vec4");
+static_assert(sizeof(DkVertexPacked) == 16, "DkVertexPacked must be 16 bytes");
+static_assert(sizeof(DkVertexOct) == 16, "DkVertexOct must be 16 bytes");
+
+TEST(DkVertexFormatsTests, halfConversion) {
+	ASSERT_EQ(0x0000, floatToHalf(0.f));
+	ASSERT_EQ(0x8000, floatToHalf(-0.f));
+	ASSERT_EQ(0x3c00, floatToHalf(1.f));
+	ASSERT_EQ(0xc000, floatToHalf(-2.f));
+	ASSERT_EQ(0x7bff, floatToHalf(65504.f));
+	ASSERT_EQ(0x7c00, floatToHalf(70000.f));
+	ASSERT_EQ(0x0001, floatToHalf(5.9604645e-8f));		// smallest subnormal
+	ASSERT_EQ(0x0000, floatToHalf(2.9802322e-8f));		// half of it rounds to even
+	// 1 + 2^-11 is halfway between 1 and the next half; ties go to even
+	ASSERT_EQ(0x3c00, floatToHalf(1.f + 1.f / 2048.f));
+	ASSERT_EQ(0x3c02, floatToHalf(1.f + 3.f / 2048.f));
+
+	for (uint h = 0; h < 0x7c00; ++h) {
+		ASSERT_EQ(h, floatToHalf(halfToFloat((uint16_t)h)));
+		ASSERT_EQ(h | 0x8000, floatToHalf(halfToFloat((uint16_t)(h | 0x8000))));
+	}
+	ASSERT_TRUE(std::isinf(halfToFloat(0x7c00)));
+	ASSERT_TRUE(std::isnan(halfToFloat(floatToHalf(std::nanf("")))));
+}
+
+TEST(DkVertexFormatsTests, normalizedPacking) {
+	ASSERT_EQ(0xff0080ffu, packUnorm8(vec4(1.f, 0.5f, -3.f, 2.f)));
+	vec4 c = unpackUnorm8(packUnorm8(vec4(0.2f, 0.4f, 0.6f, 0.8f)));
+	for (uint i = 0; i < 4; ++i) {
+		ASSERT_NEAR(0.2f * (i + 1), c[i], 0.5f / 255.f);
+	}
+
+	vec4 n(0.6f, -0.8f, 0.f, 0.f);
+	vec4 un = unpackSnorm10(packSnorm10(n));
+	for (uint i = 0; i < 4; ++i) {
+		ASSERT_NEAR(n[i], un[i], 0.5f / 511.f);
+	}
+	vec4 extremes = unpackSnorm10(packSnorm10(vec4(-1.f, 1.f, -2.f, 1.f)));
+	ASSERT_EQ(vec4(-1.f, 1.f, -1.f, 1.f), extremes);
+}
+
+TEST(DkVertexFormatsTests, octahedralNormals) {
+	const vec3 axes[] = {
+		vec3(1.f, 0.f, 0.f), vec3(-1.f, 0.f, 0.f), vec3(0.f, 1.f, 0.f),
+		vec3(0.f, -1.f, 0.f), vec3(0.f, 0.f, 1.f), vec3(0.f, 0.f, -1.f)
+	};
+	for (const vec3& a : axes) {
+		vec3 d = octDecode(octEncode(a));
+		for (uint i = 0; i < 3; ++i) {
+			ASSERT_NEAR(a[i], d[i], 1.e-6f);
+		}
+	}
+	for (uint i = 0; i < 200; ++i) {
+		float theta = 0.0314f * i;
+		float phi = 0.0711f * i;
+		vec3 n(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+		vec3 d = octDecode(octEncode(n));
+		ASSERT_NEAR(1.f, dot(n, d), 1.e-6f);
+	}
+}
+
+static std::vector<DkVertex> testVertices(uint count) {
+	std::vector<DkVertex> verts(count);
+	for (uint i = 0; i < count; ++i) {
+		float t = (float)i;
+		verts[i].vert = vec4(t * 0.37f - 5.f, 3.f - t * 0.11f, t * t * 0.01f, 1.f);
+		verts[i].color = vec4(t / count, 1.f - t / count, 0.5f, 1.f);
+		vec3 n = normalize(vec3(std::sin(t), std::cos(t * 0.7f), std::sin(t * 1.3f) - 0.2f));
+		verts[i].normal = vec4(n);
+		verts[i].normal[3] = 0.f;
+	}
+	verts[3].color = vec4(-1.f, 2.f, 0.f, 1.f);		// clamped
+	verts[5].normal = vec4(0.f, 0.f, 0.f, 0.f);		// degenerate
+	return verts;
+}
+
+TEST(DkVertexFormatsTests, packedVertices) {
+	const uint count = 23;
+	std::vector<DkVertex> verts = testVertices(count);
+	std::vector<DkVertexPacked> packed(count);
+	packVertices(verts.data(), packed.data(), count);
+	for (uint i = 0; i < count; ++i) {
+		for (uint c = 0; c < 4; ++c) {
+			ASSERT_EQ(floatToHalf(verts[i].vert[c]), packed[i].vert[c]);
+		}
+		ASSERT_EQ(packUnorm8(verts[i].color), packed[i].color);
+		ASSERT_EQ(packSnorm10(verts[i].normal), packed[i].normal);
+
+		DkVertex v = unpackVertex(packed[i]);
+		for (uint c = 0; c < 4; ++c) {
+			ASSERT_NEAR(verts[i].vert[c], v.vert[c], std::abs(verts[i].vert[c]) * 1.e-3f);
+			ASSERT_NEAR(verts[i].normal[c], v.normal[c], 1.e-3f);
+		}
+	}
+}
+
+TEST(DkVertexFormatsTests, octVertices) {
+	const uint count = 23;
+	std::vector<DkVertex> verts = testVertices(count);
+	std::vector<DkVertexOct> packed(count);
+	packVertices(verts.data(), packed.data(), count);
+
+	// the scalar tail is the reference for the batched path
+	for (uint i = 0; i < count; ++i) {
+		DkVertexOct single;
+		packVertices(&verts[i], &single, 1);
+		ASSERT_EQ(0, memcmp(&single, &packed[i], sizeof(DkVertexOct)));
+
+		DkVertex v = unpackVertex(packed[i]);
+		if (i != 5) {
+			ASSERT_NEAR(1.f, dot(vec3(verts[i].normal), vec3(v.normal)), 1.e-6f);
+		}
+	}
+}
+
+TEST(DkVertexFormatsTests, indexType) {
+	ASSERT_EQ(VK_INDEX_TYPE_UINT16, getIndexType(24));
+	ASSERT_EQ(VK_INDEX_TYPE_UINT16, getIndexType(65536));
+	ASSERT_EQ(VK_INDEX_TYPE_UINT32, getIndexType(65537));
+	ASSERT_EQ(2u, getIndexStride(VK_INDEX_TYPE_UINT16));
+	ASSERT_EQ(4u, getIndexStride(VK_INDEX_TYPE_UINT32));
+
+	uint wide[] = { 0, 1, 65535 };
+	uint16_t narrow[3];
+	packIndices(wide, narrow, 3);
+	ASSERT_EQ(65535, narrow[2]);
+}
+
+TEST(DkVertexFormatsTests, welding) {
+	vec4 col(1.f, 0.f, 0.f, 1.f);
+	vec4 a(0.f, 0.f, 0.f, 1.f), b(1.f, 0.f, 0.f, 1.f), c(0.f, 1.f, 0.f, 1.f), d(1.f, 1.f, 0.f, 1.f);
+	// a quad as two triangles
+	std::vector<DkVertex> quad = { { a, col }, { b, col }, { c, col }, { c, col }, { b, col }, { d, col } };
+
+	DkVertexWelder welder;
+	std::vector<DkVertex> verts;
+	std::vector<uint> indices;
+	welder.weld(quad.data(), (uint)quad.size(), verts, indices);
+	ASSERT_EQ(4u, verts.size());
+	ASSERT_EQ(std::vector<uint>({ 0, 1, 2, 2, 1, 3 }), indices);
+	for (uint iter = 0; iter < quad.size(); ++iter) {
+		ASSERT_EQ(0, memcmp(&quad[iter], &verts[indices[iter]], sizeof(DkVertex)));
+	}
+
+	// merges across batches; a different color is a different vertex
+	std::vector<DkVertex> more = { { d, col }, { a, vec4(0.f, 0.f, 1.f, 1.f) } };
+	welder.weld(more.data(), (uint)more.size(), verts, indices);
+	ASSERT_EQ(5u, verts.size());
+	ASSERT_EQ(3u, indices[6]);
+	ASSERT_EQ(4u, indices[7]);
+
+	// bit-identical only
+	std::vector<DkVertex> signedZero = { { vec4(-0.f, 0.f, 0.f, 1.f), col } };
+	welder.weld(signedZero.data(), 1, verts, indices);
+	ASSERT_EQ(6u, verts.size());
+
+	welder.clear();
+	welder.weld(quad.data(), 1, verts, indices);
+	ASSERT_EQ(7u, verts.size());
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "pch.h"
+
+#include "DkWorkerPool.h"
+
+TEST(DkWorkerPoolTests, split) {
+	uint first = 0, count = 0;
+	uint covered = 0;
+	for (uint part = 0; part < 7; ++part) {
+		DkWorkerPool::split(50000, 7, part, first, count);
+		ASSERT_EQ(covered, first);
+		ASSERT_TRUE(count == 7142 || count == 7143);
+		covered += count;
+	}
+	ASSERT_EQ(50000u, covered);
+
+	// fewer items than parts leaves the last parts empty
+	DkWorkerPool::split(2, 4, 3, first, count);
+	ASSERT_EQ(0u, count);
+	DkWorkerPool::split(2, 4, 1, first, count);
+	ASSERT_EQ(1u, first);
+	ASSERT_EQ(1u, count);
+}
+
+TEST(DkWorkerPoolTests, runsEveryTaskOnce) {
+	DkWorkerPool pool;
+	ASSERT_TRUE(pool.init(3));
+	ASSERT_EQ(3u, pool.getThreadCount());
+
+	std::vector<std::atomic<uint>> hits(1000);
+	for (auto& hit : hits) {
+		hit = 0;
+	}
+	// many short runs back to back catch workers that wake late
+	for (uint run = 0; run < 200; ++run) {
+		pool.run((uint)hits.size(), [&hits](uint index) { ++hits[index]; });
+	}
+	for (auto& hit : hits) {
+		ASSERT_EQ(200u, hit.load());
+	}
+
+	pool.finalize();
+	ASSERT_EQ(0u, pool.getThreadCount());
+}
+
+TEST(DkWorkerPoolTests, inlineWithoutThreads) {
+	DkWorkerPool pool;
+	ASSERT_TRUE(pool.init(0));
+	std::thread::id caller = std::this_thread::get_id();
+	bool sameThread = true;
+	uint sum = 0;
+	pool.run(10, [&](uint index) {
+		sameThread = sameThread && std::this_thread::get_id() == caller;
+		sum += index;
+	});
+	ASSERT_TRUE(sameThread);
+	ASSERT_EQ(45u, sum);
+}
@@ -100,6 +100,8 @@ bool DkSample_Cube::init() {
 	if (!m_pipeline.addShader("shaders/frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT)) return false;
 
 	m_cube = new DkMesh(nullptr);
+	// each frame in flight reads its own matrices
+	m_cube->setFrameCount(m_frameCount);
 
 	vec4 trf( 1.f,  1.f, -1.f,  1.f);
 	vec4 trb( 1.f,  1.f,  1.f,  1.f);
@@ -138,7 +140,7 @@ bool DkSample_Cube::init() {
 
 	m_pipeline.addDescriptorBinding({
 		0,
-		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+		VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
 		1,
 		VK_SHADER_STAGE_VERTEX_BIT,
 		nullptr
@@ -147,11 +149,11 @@ bool DkSample_Cube::init() {
 	m_pipeline.setDepthTestEnabled(true);
 	if (!m_pipeline.init()) return false;
 
-	m_descPool.addToPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1);
+	m_descPool.addToPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1);
 	if (!m_descPool.init()) return false;
 	m_descSet = m_descPool.allocate(m_pipeline.getDescriptorSetLayout());
 	if (m_descSet == nullptr) return false;
-	if (!m_descSet->updateBuffer(0, m_cube->getMVPBuffer(), 0, VK_WHOLE_SIZE, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)) return false;
+	if (!m_descSet->updateBuffer(0, m_cube->getMVPBuffer(), 0, m_cube->getMVPRange(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)) return false;
 
 	m_initialized = true;
 	initTime = system_clock::now();
@@ -208,11 +210,12 @@ bool DkSample_Cube::draw() {
 	clearDepth.depthStencil = { 1.f, 0 };
 	if (!cmdBfr->beginRenderPass(&m_renderPass, &frame.getFramebuffer(), { clearCol, clearDepth })) return false;
 	if (!cmdBfr->bindPipeline(&m_pipeline)) return false;
-	if (!cmdBfr->bindDescriptorSet(m_descSet, &m_pipeline)) return false;
+	if (!cmdBfr->bindDescriptorSet(m_descSet, &m_pipeline, { m_cube->getMVPOffset() })) return false;
 	if (!cmdBfr->setViewport(0, { { 0.f, 0.f, (float)getWindow().getExtent().width, (float)getWindow().getExtent().height, 0.f, 1.f } })) return false;
 	if (!cmdBfr->setScissor(0, { { { 0, 0 },{ getWindow().getExtent().width, getWindow().getExtent().height } } })) return false;
 	if (!cmdBfr->bindVertexBuffer(m_cube)) return false;
-	if (!cmdBfr->draw(m_cube)) return false;
+	if (!cmdBfr->bindIndexBuffer(m_cube)) return false;
+	if (!cmdBfr->drawIndexed(m_cube)) return false;
 	if (!cmdBfr->endRenderPass()) return false;
 
 	if (getQueue(DK_GRAPHICS_QUEUE).getFamilyIndex() != getQueue(DK_PRESENT_QUEUE).getFamilyIndex()) {
@@ -4,6 +4,7 @@
 #include "DkApplication.h"
 #include "DkDescriptorPool.h"
 #include "DkDescriptorSet.h"
+#include "DkGeometryArena.h"
 
 class DkSample_Cube_and_Oct : public DkApplication {
 public:
@@ -27,6 +28,7 @@ private:
 	std::vector<DkFrameResources*> m_frames;
 	std::vector<DkSemaphore*> m_pushUniformSemaphores;
 	DkPipeline m_pipeline;
+	DkGeometryArena m_arena;
 	DkMesh* m_cube;
 	DkMesh* m_octahedron;
 	DkDescriptorPool m_descPool;
@@ -2,6 +2,7 @@
 #include "DkSample_Cube_and_Oct.h"
 #include "DkAttachmentDescriptionBuilder.h"
 #include "DkCommandBuffer.h"
+#include "DkUploadManager.h"
 
 using namespace math;
 using namespace std::chrono;
@@ -16,6 +17,7 @@ DkSample_Cube_and_Oct::DkSample_Cube_and_Oct() :
 	m_frames(),
 	m_pushUniformSemaphores(),
 	m_pipeline(getDevice(), m_renderPass),
+	m_arena(getDevice()),
 	m_cube(nullptr),
 	m_descPool(getDevice()),
 	m_descSet(nullptr),
@@ -154,10 +156,21 @@ bool DkSample_Cube_and_Oct::init() {
 		{ bot, blackC }, { fro, blackC }, { rig, blackC }
 	});
 
-	DkCommandBuffer* bfr = getCommandPool(DK_GRAPHICS_QUEUE)->allocate(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-	if (!m_cube->initVertBuffer(getDevice(), bfr, getQueue(DK_GRAPHICS_QUEUE), false)) return false;
-	if (!m_octahedron->initVertBuffer(getDevice(), bfr, getQueue(DK_GRAPHICS_QUEUE), false)) return false;
-	getCommandPool(DK_GRAPHICS_QUEUE)->freeBuffer(bfr);
+	// both meshes go up in a single submission on the transfer queue
+	DkUploadManager uploader(getDevice(), *getCommandPool(DK_TRANSFER_QUEUE), getQueue(DK_TRANSFER_QUEUE));
+	uploader.setOwnerQueue(*getCommandPool(DK_GRAPHICS_QUEUE), getQueue(DK_GRAPHICS_QUEUE));
+	uploader.setStagingSize(1 << 20);
+	if (!uploader.init()) return false;
+	// both meshes share one vertex buffer and one index buffer
+	m_arena.setVertexCapacity(1024);
+	m_arena.setIndexCapacity(1024);
+	m_arena.setIndexType(VK_INDEX_TYPE_UINT16);
+	if (!m_arena.init()) return false;
+	if (!m_cube->initVertBuffer(getDevice(), m_arena, uploader, false)) return false;
+	if (!m_octahedron->initVertBuffer(getDevice(), m_arena, uploader, false)) return false;
+	uint64 uploadTicket;
+	if (!uploader.submit(uploadTicket)) return false;
+	if (!uploader.wait(uploadTicket)) return false;
 
 	m_pipeline.addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mat4));
 	m_pipeline.addVertexInfo<DkMesh>();
@@ -220,6 +233,11 @@ bool DkSample_Cube_and_Oct::draw() {
 			}
 			)) return false;
 	}
+
+	// the arena's buffers were last written by the uploader; no barrier is
+	//	recorded once the acquire has made them readable
+	if (!cmdBfr->requireState(*m_arena.getVertBuffer(), DK_RESOURCE_USAGE_VERTEX_BUFFER)) return false;
+	if (!cmdBfr->requireState(*m_arena.getIndexBuffer(), DK_RESOURCE_USAGE_INDEX_BUFFER)) return false;
 	
 	VkClearValue clearCol, clearDepth;
 	clearCol.color = { .1f, .2f, .3f, 1.f };
@@ -228,12 +246,12 @@ bool DkSample_Cube_and_Oct::draw() {
 	if (!cmdBfr->bindPipeline(&m_pipeline)) return false;
 	if (!cmdBfr->setViewport(0, { { 0.f, 0.f, (float)getWindow().getExtent().width, (float)getWindow().getExtent().height, 0.f, 1.f } })) return false;
 	if (!cmdBfr->setScissor(0, { { { 0, 0 },{ getWindow().getExtent().width, getWindow().getExtent().height } } })) return false;
-	if (!cmdBfr->bindVertexBuffer(m_cube)) return false;
-	if (!cmdBfr->pushConstants(m_pipeline, 0, &transpose(m_cube->getMVP()))) return false;
-	if (!cmdBfr->draw(m_cube)) return false;
-	if (!cmdBfr->bindVertexBuffer(m_octahedron)) return false;
-	if (!cmdBfr->pushConstants(m_pipeline, 0, &transpose(m_octahedron->getMVP()))) return false;
-	if (!cmdBfr->draw(m_octahedron)) return false;
+	if (!cmdBfr->bindVertexBuffer(m_arena)) return false;
+	if (!cmdBfr->bindIndexBuffer(m_arena)) return false;
+	if (!cmdBfr->pushConstants(m_pipeline, 0, m_cube->getGpuMVP())) return false;
+	if (!cmdBfr->drawIndexed(m_cube)) return false;
+	if (!cmdBfr->pushConstants(m_pipeline, 0, m_octahedron->getGpuMVP())) return false;
+	if (!cmdBfr->drawIndexed(m_octahedron)) return false;
 	if (!cmdBfr->endRenderPass()) return false;
 
 	if (getQueue(DK_GRAPHICS_QUEUE).getFamilyIndex() != getQueue(DK_PRESENT_QUEUE).getFamilyIndex()) {
@@ -276,6 +294,7 @@ void DkSample_Cube_and_Oct::finalize() {
 		delete m_cube;
 		m_cube = nullptr;
 	}
+	m_arena.finalize();
 	m_renderPass.finalize();
 	m_swapchain.finalize();
 	for (auto& frame : m_frames) {
@@ -131,7 +131,8 @@ bool DkSample_Triangle::draw() {
 	if (!cmdBfr->setViewport(0, { { 0.f, 0.f, (float)getWindow().getExtent().width, (float)getWindow().getExtent().height, 0.f, 1.f } })) return false;
 	if (!cmdBfr->setScissor(0, { { { 0, 0 },{ getWindow().getExtent().width, getWindow().getExtent().height } } })) return false;
 	if (!cmdBfr->bindVertexBuffer(m_triangle)) return false;
-	if (!cmdBfr->draw(m_triangle)) return false;
+	if (!cmdBfr->bindIndexBuffer(m_triangle)) return false;
+	if (!cmdBfr->drawIndexed(m_triangle)) return false;
 	if (!cmdBfr->endRenderPass()) return false;
 
 	if (getQueue(DK_GRAPHICS_QUEUE).getFamilyIndex() != getQueue(DK_PRESENT_QUEUE).getFamilyIndex()) {